@@ -0,0 +1,108 @@
+/***************************************************************************
+                 TestFocusFit.cpp  -  K Desktop Planetarium
+                             -------------------
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "testfocusfit.h"
+
+#include <cmath>
+
+// HFR of a star in focus, pixels
+#define FOCUSED_HFR 1.5
+
+TestFocusFit::TestFocusFit(): QObject(), best_(0), slope_in_(0),
+                              slope_out_(0) {
+}
+
+TestFocusFit::~TestFocusFit() {
+  cleanup();
+}
+
+void TestFocusFit::cleanup() {
+  qDeleteAll(points_);
+  points_.clear();
+}
+
+double TestFocusFit::curveHFR(double pos) const {
+  double slope = pos < best_ ? slope_in_ : slope_out_;
+  double d = slope * (pos - best_);
+  return sqrt(FOCUSED_HFR * FOCUSED_HFR + d * d);
+}
+
+void TestFocusFit::sampleCurve(int start, int step, int count, double best,
+                               double slope_in, double slope_out) {
+  best_ = best;
+  slope_in_ = slope_in;
+  slope_out_ = slope_out;
+
+  for (int i = 0; i < count; i++) {
+    Ekos::HFRPoint *p = new Ekos::HFRPoint;
+    p->pos = start + i * step;
+    // A fixed +-2% pattern stands in for the measurement noise
+    p->HFR = curveHFR(p->pos) * (1.0 + 0.02 * ((i % 3) - 1));
+    points_.append(p);
+  }
+}
+
+void TestFocusFit::Symmetric() {
+  sampleCurve(0, 100, 11, 430, 0.01, 0.01);
+
+  double minimum = 0;
+  QVERIFY(Ekos::fitVCurve(points_, &minimum));
+  QVERIFY(fabs(minimum - 430) < 15);
+}
+
+void TestFocusFit::SymmetricWithOutlier() {
+  sampleCurve(0, 100, 11, 430, 0.01, 0.01);
+  // A blended star doubles the HFR of one frame
+  points_[2]->HFR *= 2;
+
+  double minimum = 0;
+  QVERIFY(Ekos::fitVCurve(points_, &minimum));
+  QVERIFY(fabs(minimum - 430) < 15);
+}
+
+void TestFocusFit::Asymmetric() {
+  // Twice as steep outwards. The parabola puts the vertex towards the
+  // shallow side, but the HFR there must stay close to the best one.
+  sampleCurve(0, 100, 11, 430, 0.006, 0.012);
+
+  double minimum = 0;
+  Ekos::VCurveFit fit;
+  QVERIFY(Ekos::fitVCurve(points_, &minimum, &fit));
+  QVERIFY(fit.a > 0);
+  QVERIFY(minimum >= fit.minSample && minimum <= fit.maxSample);
+  QVERIFY(curveHFR(minimum) < FOCUSED_HFR * 1.1);
+}
+
+void TestFocusFit::TooFewPoints() {
+  sampleCurve(250, 100, 4, 430, 0.01, 0.01);
+
+  double minimum = -1;
+  QVERIFY(!Ekos::fitVCurve(points_, &minimum));
+  QCOMPARE(minimum, -1.0);
+}
+
+void TestFocusFit::OneSided() {
+  // Every sample is outside of focus, so the minimum is not bracketed
+  sampleCurve(500, 100, 6, 430, 0.01, 0.01);
+
+  double minimum = -1;
+  QVERIFY(!Ekos::fitVCurve(points_, &minimum));
+  QCOMPARE(minimum, -1.0);
+}
+
+QTEST_MAIN(TestFocusFit)
+
+#include "testfocusfit.moc"
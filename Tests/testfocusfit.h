@@ -0,0 +1,53 @@
+/***************************************************************************
+                 TestFocusFit.h  -  K Desktop Planetarium
+                             -------------------
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef TESTFOCUSFIT_H
+#define TESTFOCUSFIT_H
+
+#include <QtTest/QtTest>
+#include <QList>
+
+#include "kstars/ekos/focusfit.h"
+
+/**
+ * Fits synthetic V-curves with Ekos::fitVCurve() and checks the minimum.
+ */
+class TestFocusFit: public QObject {
+  Q_OBJECT
+ public:
+  TestFocusFit();
+  ~TestFocusFit();
+ private slots:
+  void cleanup();
+  void Symmetric();
+  void SymmetricWithOutlier();
+  void Asymmetric();
+  void TooFewPoints();
+  void OneSided();
+
+ private:
+  /* Samples count positions from start on a V-curve with its minimum at
+     best, with slope_in and slope_out (HFR per step) on either side */
+  void sampleCurve(int start, int step, int count, double best,
+                   double slope_in, double slope_out);
+  /* HFR of the sampled curve at pos, without noise */
+  double curveHFR(double pos) const;
+
+  QList<Ekos::HFRPoint *> points_;
+  double best_, slope_in_, slope_out_;
+};
+
+#endif  // TESTFOCUSFIT_H
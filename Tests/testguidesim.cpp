@@ -0,0 +1,435 @@
+/***************************************************************************
+                 TestGuideSim.cpp  -  K Desktop Planetarium
+                             -------------------
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "testguidesim.h"
+
+#include <cmath>
+
+#include <QDir>
+#include <QElapsedTimer>
+
+#include <fitsio.h>
+
+#include "kstars/ekos/focusfit.h"
+#include "kstars/fitsviewer/fitsimage.h"
+
+// Fixed seed so every run replays the same frames
+#define SIM_SEED 1234
+
+GuideSimParams::GuideSimParams()
+  : width(320), height(240), seeing(0.15), star_sigma(1.5), star_flux(2000),
+    background(200), noise(20), drift_ra(0), drift_dec(0), pe_amplitude(0),
+    pe_period(100), dec_backlash(0), guide_rate(0.5), pixel_size(5.2),
+    focal_length(500) {
+}
+
+GuideSimulator::GuideSimulator(const GuideSimParams &params)
+  : params_(params), frame_(params.width * params.height),
+    error_ra_(0), error_dec_(0), pe_phase_(0), last_pe_(0),
+    last_dec_dir_(NO_DIR), backlash_left_(0) {
+  // arcsecs = 3600*180/pi * (pix*ccd_pix_sz) / focal_len
+  scale_ = 206264.8062470963552 * (params_.pixel_size / 1000.0) /
+           params_.focal_length;
+  qsrand(SIM_SEED);
+}
+
+double GuideSimulator::gaussianNoise() {
+  // Box-Muller transform
+  double u1 = (qrand() + 1.0) / (RAND_MAX + 2.0);
+  double u2 = (qrand() + 1.0) / (RAND_MAX + 2.0);
+  return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+float *GuideSimulator::nextFrame() {
+  // Advance the mount: constant drift plus periodic error
+  error_ra_ += params_.drift_ra;
+  error_dec_ += params_.drift_dec;
+  if (params_.pe_amplitude > 0 && params_.pe_period > 0) {
+    pe_phase_ += 2.0 * M_PI / params_.pe_period;
+    double pe = params_.pe_amplitude * sin(pe_phase_);
+    error_ra_ += pe - last_pe_;
+    last_pe_ = pe;
+  }
+
+  // Star position on the sensor. DEC runs opposite to the image y axis.
+  double star_x = params_.width / 2.0 + error_ra_ / scale_ +
+                  params_.seeing * gaussianNoise();
+  double star_y = params_.height / 2.0 - error_dec_ / scale_ +
+                  params_.seeing * gaussianNoise();
+
+  float *data = frame_.data();
+  for (int i = 0; i < frame_.size(); i++)
+    data[i] = params_.background +
+              params_.noise * (2.0 * qrand() / RAND_MAX - 1.0);
+
+  int radius = (int) ceil(params_.star_sigma * 4);
+  int x1 = qMax(0, (int) star_x - radius);
+  int x2 = qMin(params_.width - 1, (int) star_x + radius);
+  int y1 = qMax(0, (int) star_y - radius);
+  int y2 = qMin(params_.height - 1, (int) star_y + radius);
+  double two_sigma_sq = 2.0 * params_.star_sigma * params_.star_sigma;
+
+  for (int y = y1; y <= y2; y++)
+    for (int x = x1; x <= x2; x++) {
+      double dx = x - star_x;
+      double dy = y - star_y;
+      data[y * params_.width + x] +=
+        params_.star_flux * exp(-(dx * dx + dy * dy) / two_sigma_sq);
+    }
+
+  return data;
+}
+
+void GuideSimulator::pulse(GuideDirection dir, int msecs) {
+  if (dir == NO_DIR || msecs <= 0)
+    return;
+
+  // DEC reversals first have to take up the gear backlash
+  if (dir == DEC_INC_DIR || dir == DEC_DEC_DIR) {
+    if (last_dec_dir_ != NO_DIR && dir != last_dec_dir_)
+      backlash_left_ = params_.dec_backlash;
+    last_dec_dir_ = dir;
+
+    int absorbed = qMin(backlash_left_, msecs);
+    backlash_left_ -= absorbed;
+    msecs -= absorbed;
+  }
+
+  // Guide rate is a multiple of the sidereal rate, 15 arcsecs per second
+  double correction = msecs * params_.guide_rate * 15.0 / 1000.0;
+
+  switch (dir) {
+    case RA_INC_DIR:
+      error_ra_ += correction;
+      break;
+    case RA_DEC_DIR:
+      error_ra_ -= correction;
+      break;
+    case DEC_INC_DIR:
+      error_dec_ -= correction;
+      break;
+    case DEC_DEC_DIR:
+      error_dec_ += correction;
+      break;
+    default:
+      break;
+  }
+}
+
+TestGuideSim::TestGuideSim(): QObject(), math_(NULL), image_(NULL) {
+}
+
+TestGuideSim::~TestGuideSim() {
+  delete math_;
+  delete image_;
+}
+
+bool TestGuideSim::loadFrame(const float *frame, int width, int height) {
+  QString file_name = QDir::tempPath() + "/testguidesim.fits";
+  long naxes[2] = { width, height };
+  fitsfile *fptr = NULL;
+  int status = 0;
+
+  // The leading ! replaces the file of the previous frame
+  if (fits_create_file(&fptr, QString("!%1").arg(file_name).toAscii(), &status))
+    return false;
+  fits_create_img(fptr, FLOAT_IMG, 2, naxes, &status);
+  fits_write_img(fptr, TFLOAT, 1, naxes[0] * naxes[1], (void *) frame, &status);
+  int close_status = 0;
+  fits_close_file(fptr, &close_status);
+  if (status || close_status)
+    return false;
+
+  return image_->loadFITS(file_name);
+}
+
+void TestGuideSim::findGuideStars() {
+  double square_x = 0, square_y = 0;
+  int square_size = math_->get_square_size();
+  math_->get_square_pos(&square_x, &square_y);
+
+  // The square plus a margin of one square size, the full frame if empty
+  QRect region((int) square_x - square_size, (int) square_y - square_size,
+               square_size * 3, square_size * 3);
+  if (image_->findStars(region) <= 0)
+    image_->findStars();
+  math_->set_image_data(image_);
+}
+
+void TestGuideSim::setupMath(cgmath *math, const GuideSimParams &params,
+                             int algorithm) {
+  math->set_video_params(params.width, params.height);
+  math->set_guider_params(params.pixel_size, params.pixel_size, 50,
+                          params.focal_length);
+  math->set_square_algorithm(algorithm);
+
+  int square_size = math->get_square_size();
+  math->set_reticle_params(params.width / 2, params.height / 2, 0);
+  math->move_square(params.width / 2 - square_size / 2,
+                    params.height / 2 - square_size / 2);
+
+  cproc_in_params *in_params = math->get_in_params();
+  in_params->guiding_rate = params.guide_rate;
+  for (int k = GUIDE_RA; k <= GUIDE_DEC; k++)
+    in_params->proportional_gain[k] =
+      cgmath::precalc_proportional_gain(params.guide_rate);
+
+  math->start();
+}
+
+double TestGuideSim::runGuiding(GuideSimulator *sim, int frames,
+                                int *converged_at, int *usec_per_frame) {
+  QElapsedTimer timer;
+  qint64 total_nsecs = 0;
+  double sqr_sum = 0;
+  int samples = 0;
+  int settled = 0;
+
+  if (converged_at)
+    *converged_at = -1;
+
+  for (int i = 0; i < frames; i++) {
+    float *frame = sim->nextFrame();
+    if (image_ && !loadFrame(frame, sim->params().width, sim->params().height))
+      return -1;
+    if (!image_)
+      math_->set_buffer(frame);
+
+    timer.start();
+    // The centroid algorithm picks from the stars the guide module found
+    if (image_)
+      findGuideStars();
+    math_->do_processing();
+    total_nsecs += timer.nsecsElapsed();
+
+    if (math_->is_lost_star())
+      return -1;
+
+    const cproc_out_params *out = math_->get_out_params();
+    sim->pulse(out->pulse_dir[GUIDE_RA], out->pulse_length[GUIDE_RA]);
+    sim->pulse(out->pulse_dir[GUIDE_DEC], out->pulse_length[GUIDE_DEC]);
+
+    double error = sqrt(sim->errorRA() * sim->errorRA() +
+                        sim->errorDEC() * sim->errorDEC());
+
+    // Converged once the error stays under one pixel for three frames
+    if (converged_at && *converged_at == -1) {
+      settled = (error < sim->scale()) ? settled + 1 : 0;
+      if (settled == 3)
+        *converged_at = i - 2;
+    }
+
+    // Steady state RMS over the second half of the run
+    if (i >= frames / 2) {
+      sqr_sum += error * error;
+      samples++;
+    }
+  }
+
+  if (usec_per_frame)
+    *usec_per_frame = total_nsecs / frames / 1000;
+
+  return samples > 0 ? sqrt(sqr_sum / samples) : 0;
+}
+
+void TestGuideSim::Convergence() {
+  GuideSimParams params;
+  GuideSimulator sim(params);
+  sim.setError(6.0, -4.0);
+
+  delete math_;
+  math_ = new cgmath();
+  setupMath(math_, params, SMART_THRESHOLD);
+
+  int converged_at = -1, usec_per_frame = 0;
+  double rms = runGuiding(&sim, 60, &converged_at, &usec_per_frame);
+
+  qDebug() << "Convergence: RMS" << rms << "arcsecs, converged after"
+           << converged_at << "frames," << usec_per_frame << "us per frame";
+
+  QVERIFY(rms >= 0);
+  QVERIFY(converged_at >= 0);
+  QVERIFY(converged_at <= 2);
+  QVERIFY(rms < 0.9);
+}
+
+void TestGuideSim::CentroidConvergence() {
+  GuideSimParams params;
+  GuideSimulator sim(params);
+  sim.setError(6.0, -4.0);
+
+  delete math_;
+  math_ = new cgmath();
+  setupMath(math_, params, CENTROID_THRESHOLD);
+  delete image_;
+  image_ = new FITSImage(FITS_GUIDE);
+
+  int converged_at = -1, usec_per_frame = 0;
+  double rms = runGuiding(&sim, 60, &converged_at, &usec_per_frame);
+
+  delete image_;
+  image_ = NULL;
+
+  qDebug() << "Centroid convergence: RMS" << rms << "arcsecs, converged after"
+           << converged_at << "frames," << usec_per_frame << "us per frame";
+
+  QVERIFY(rms >= 0);
+  QVERIFY(converged_at >= 0);
+  QVERIFY(converged_at <= 2);
+  QVERIFY(rms < 0.9);
+}
+
+void TestGuideSim::Drift() {
+  GuideSimParams params;
+  params.drift_ra = 0.3;
+  params.drift_dec = 0.1;
+  GuideSimulator sim(params);
+
+  delete math_;
+  math_ = new cgmath();
+  setupMath(math_, params, SMART_THRESHOLD);
+
+  int usec_per_frame = 0;
+  double rms = runGuiding(&sim, 200, 0, &usec_per_frame);
+
+  qDebug() << "Drift: RMS" << rms << "arcsecs," << usec_per_frame
+           << "us per frame";
+
+  QVERIFY(rms >= 0);
+  QVERIFY(rms < 0.9);
+}
+
+void TestGuideSim::PeriodicErrorAndBacklash() {
+  GuideSimParams params;
+  params.pe_amplitude = 5.0;
+  params.pe_period = 100;
+  params.drift_dec = 0.05;
+  params.dec_backlash = 300;
+  GuideSimulator sim(params);
+
+  delete math_;
+  math_ = new cgmath();
+  setupMath(math_, params, SMART_THRESHOLD);
+
+  int usec_per_frame = 0;
+  double rms = runGuiding(&sim, 300, 0, &usec_per_frame);
+
+  qDebug() << "Periodic error and backlash: RMS" << rms << "arcsecs,"
+           << usec_per_frame << "us per frame";
+
+  QVERIFY(rms >= 0);
+  QVERIFY(rms < 0.9);
+}
+
+void TestGuideSim::FocusReplay() {
+  // The focuser steps through focus as the absolute autofocus does, and the
+  // V-curve fitted to the measured HFRs has to find the best position
+  const int best_focus = 430, step = 100, steps = 11;
+  // Blur added per focuser step away from focus, pixels
+  const double blur_per_step = 0.005;
+
+  GuideSimParams params;
+  params.noise = 5;
+  GuideSimulator sim(params);
+  const double focused_sigma = params.star_sigma;
+  const double total_flux = params.star_flux * focused_sigma * focused_sigma;
+
+  delete image_;
+  image_ = new FITSImage(FITS_FOCUS);
+
+  QVector<Ekos::HFRPoint> samples(steps);
+  QElapsedTimer timer;
+  qint64 total_nsecs = 0;
+  bool measured = true;
+
+  for (int i = 0; i < steps && measured; i++) {
+    int pos = i * step;
+    double blur = blur_per_step * (pos - best_focus);
+    double sigma = sqrt(focused_sigma * focused_sigma + blur * blur);
+    // Defocus spreads the same flux over a wider profile
+    sim.setStar(sigma, total_flux / (sigma * sigma));
+
+    measured = loadFrame(sim.nextFrame(), params.width, params.height);
+    if (!measured)
+      break;
+
+    timer.start();
+    image_->findStars();
+    samples[i].pos = pos;
+    samples[i].HFR = image_->getHFR(HFR_MEDIAN);
+    total_nsecs += timer.nsecsElapsed();
+
+    measured = samples[i].HFR > 0;
+  }
+
+  delete image_;
+  image_ = NULL;
+  QVERIFY(measured);
+
+  QList<Ekos::HFRPoint *> points;
+  for (int i = 0; i < steps; i++)
+    points.append(&samples[i]);
+
+  double minimum = -1;
+  bool fitted = Ekos::fitVCurve(points, &minimum);
+
+  qDebug() << "Focus replay: best focus" << minimum << "for" << best_focus
+           << "," << total_nsecs / steps / 1000 << "us per frame";
+
+  QVERIFY(fitted);
+  QVERIFY(fabs(minimum - best_focus) < step / 2);
+}
+
+void TestGuideSim::ProcessingBenchmark_data() {
+  QTest::addColumn<int>("algorithm");
+
+  QTest::newRow("Smart") << (int) SMART_THRESHOLD;
+  QTest::newRow("Fast") << (int) CENTROID_THRESHOLD;
+  QTest::newRow("Auto") << (int) AUTO_THRESHOLD;
+  QTest::newRow("No threshold") << (int) NO_THRESHOLD;
+}
+
+void TestGuideSim::ProcessingBenchmark() {
+  QFETCH(int, algorithm);
+
+  GuideSimParams params;
+  GuideSimulator sim(params);
+
+  delete math_;
+  math_ = new cgmath();
+  setupMath(math_, params, algorithm);
+  math_->set_buffer(sim.nextFrame());
+
+  // The centroid algorithm includes the star detection it relies on
+  if (algorithm == CENTROID_THRESHOLD) {
+    delete image_;
+    image_ = new FITSImage(FITS_GUIDE);
+    QVERIFY(loadFrame(sim.nextFrame(), params.width, params.height));
+  }
+
+  QBENCHMARK {
+    if (image_)
+      findGuideStars();
+    math_->do_processing();
+  }
+
+  delete image_;
+  image_ = NULL;
+}
+
+QTEST_MAIN(TestGuideSim)
+
+#include "testguidesim.moc"
@@ -0,0 +1,121 @@
+/***************************************************************************
+                 TestGuideSim.h  -  K Desktop Planetarium
+                             -------------------
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef TESTGUIDESIM_H
+#define TESTGUIDESIM_H
+
+#include <QtTest/QtTest>
+#include <QVector>
+
+#include "kstars/ekos/guide/gmath.h"
+
+class FITSImage;
+
+/**
+ * Parameters of the simulated sky, mount and camera used to generate
+ * synthetic guide frames.
+ */
+struct GuideSimParams {
+  GuideSimParams();
+
+  int width, height;            // frame size in pixels
+  double seeing;                // random star motion, pixels (1 sigma)
+  double star_sigma;            // star profile width, pixels
+  double star_flux;             // peak value of the star
+  double background, noise;     // sky background and noise level
+  double drift_ra, drift_dec;   // constant drift, arcsecs per frame
+  double pe_amplitude;          // periodic error amplitude, arcsecs
+  double pe_period;             // periodic error period, frames
+  int dec_backlash;             // DEC backlash, pulse milliseconds
+  double guide_rate;            // guide rate, multiple of sidereal
+  double pixel_size;            // pixel size, microns
+  double focal_length;          // guider focal length, mm
+};
+
+/**
+ * Stand-in for the guide camera and mount. It renders a star at the current
+ * mount error and applies correction pulses the way a mount would.
+ */
+class GuideSimulator {
+ public:
+  explicit GuideSimulator(const GuideSimParams &params);
+
+  /* Render the next frame and advance drift and periodic error */
+  float *nextFrame();
+  /* Apply a correction pulse to the simulated mount */
+  void pulse(GuideDirection dir, int msecs);
+
+  /* Current mount error in arcsecs */
+  double errorRA() const { return error_ra_; }
+  double errorDEC() const { return error_dec_; }
+  /* Arcsecs per pixel */
+  double scale() const { return scale_; }
+
+  void setError(double ra, double dec) { error_ra_ = ra; error_dec_ = dec; }
+  /* Change the star profile, as a focuser moving through focus does */
+  void setStar(double sigma, double flux) {
+    params_.star_sigma = sigma;
+    params_.star_flux = flux;
+  }
+
+  const GuideSimParams &params() const { return params_; }
+
+ private:
+  double gaussianNoise();
+
+  GuideSimParams params_;
+  QVector<float> frame_;
+  double scale_;
+  double error_ra_, error_dec_;
+  double pe_phase_, last_pe_;
+  GuideDirection last_dec_dir_;
+  int backlash_left_;
+};
+
+/**
+ * Replays synthetic guide frames through cgmath::do_processing() and reports
+ * RMS error, convergence time and per frame processing time. Synthetic focus
+ * frames are measured and fitted the way the absolute autofocus does.
+ */
+class TestGuideSim: public QObject {
+  Q_OBJECT
+ public:
+  TestGuideSim();
+  ~TestGuideSim();
+ private slots:
+   void Convergence();
+   void CentroidConvergence();
+   void Drift();
+   void PeriodicErrorAndBacklash();
+   void FocusReplay();
+   void ProcessingBenchmark_data();
+   void ProcessingBenchmark();
+
+ private:
+  /* Run frames through the guide math, returns RMS error in arcsecs */
+  double runGuiding(GuideSimulator *sim, int frames, int *converged_at = 0,
+                    int *usec_per_frame = 0);
+  void setupMath(cgmath *math, const GuideSimParams &params, int algorithm);
+  /* Load frame into image_ through a FITS file, as frames from the camera are */
+  bool loadFrame(const float *frame, int width, int height);
+  /* Detect the stars of image_ around the guide square, as Guide does */
+  void findGuideStars();
+
+  cgmath *math_;
+  FITSImage *image_;  // set for the centroid algorithm, which reads its stars
+};
+
+#endif  // TESTGUIDESIM_H
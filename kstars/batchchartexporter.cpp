@@ -0,0 +1,268 @@
+/***************************************************************************
+                batchchartexporter.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2014-06-09
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+/* Project Includes */
+#include "batchchartexporter.h"
+#include "kstars.h"
+#include "kstarsdata.h"
+#include "skymap.h"
+#include "skyqpainter.h"
+#include "simclock.h"
+#include "Options.h"
+#include "fov.h"
+#include "skycomponents/skymapcomposite.h"
+#include "skycomponents/skylabeler.h"
+#include "projections/projector.h"
+
+/* KDE Includes */
+#include <kdebug.h>
+#include <klocale.h>
+
+/* Qt Includes */
+#include <QFile>
+#include <QTextStream>
+#include <QPicture>
+#include <QImage>
+#include <QPainter>
+#include <QThread>
+#include <QFuture>
+#include <QtConcurrentRun>
+#include <QSvgGenerator>
+
+BatchChartExporter::Job::Job() :
+    ra( 0.0 ), dec( 0.0 ), fov( 0.0 ), width( 0 ), height( 0 )
+{
+}
+
+BatchChartExporter::BatchChartExporter( KStars *kstars ) : m_KStars( kstars )
+{
+    Q_ASSERT( m_KStars );
+}
+
+bool BatchChartExporter::parseJob( const QString &line, Job *job )
+{
+    QStringList fields = line.split( QRegExp( "\\s+" ), QString::SkipEmptyParts );
+    if ( fields.size() < 6 || fields.size() > 7 )
+        return false;
+
+    bool ok[5];
+    job->fileName = fields[0];
+    job->ra       = fields[1].toDouble( &ok[0] );
+    job->dec      = fields[2].toDouble( &ok[1] );
+    job->fov      = fields[3].toDouble( &ok[2] );
+    job->width    = fields[4].toInt( &ok[3] );
+    job->height   = fields[5].toInt( &ok[4] );
+    for ( int i = 0; i < 5; i++ ) {
+        if ( !ok[i] )
+            return false;
+    }
+    if ( job->fov <= 0.0 || job->width <= 0 || job->height <= 0 )
+        return false;
+
+    job->ut = KStarsDateTime( KDateTime() );
+    if ( fields.size() == 7 ) {
+        job->ut = KStarsDateTime::fromString( fields[6] );
+        if ( !job->ut.isValid() )
+            return false;
+    }
+    return true;
+}
+
+bool BatchChartExporter::addJobs( const QStringList &lines )
+{
+    bool allValid = true;
+    foreach ( const QString &line, lines ) {
+        QString trimmed = line.trimmed();
+        if ( trimmed.isEmpty() || trimmed.startsWith( '#' ) )
+            continue;
+
+        Job job;
+        if ( parseJob( trimmed, &job ) ) {
+            m_jobs.append( job );
+        } else {
+            m_lastErrorMessage = i18n( "Invalid chart job: %1", trimmed );
+            kWarning() << m_lastErrorMessage;
+            allValid = false;
+        }
+    }
+    return allValid;
+}
+
+bool BatchChartExporter::loadJobs( const QString &fileName )
+{
+    QFile file( fileName );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        m_lastErrorMessage = i18n( "Could not open chart job file: %1", fileName );
+        kWarning() << m_lastErrorMessage;
+        return false;
+    }
+
+    QStringList lines;
+    QTextStream stream( &file );
+    while ( !stream.atEnd() )
+        lines.append( stream.readLine() );
+
+    return addJobs( lines );
+}
+
+void BatchChartExporter::recordChart( const Job &job, QPicture *picture )
+{
+    SkyMap *map = m_KStars->map();
+    KStarsData *data = KStarsData::Instance();
+
+    SkyPoint center( job.ra, job.dec );
+    center.apparentCoord( (long double) J2000, data->ut().djd() );
+    map->setFocus( &center );
+
+    // Everything but the projector reads the zoom from the options
+    double zoom = job.width / ( job.fov * dms::DegToRad );
+    Options::setZoomFactor( zoom );
+
+    ViewParams p;
+    p.focus         = map->focus();
+    p.width         = job.width;
+    p.height        = job.height;
+    p.useAltAz      = Options::useAltAz();
+    p.useRefraction = Options::useRefraction();
+    p.zoomFactor    = zoom;
+    p.fillGround    = Options::showGround();
+
+    Projector *proj = SkyMap::createProjector( Options::projection(), p );
+    Projector *mapProj = map->swapProjector( proj );
+
+    SkyQPainter psky( picture, QSize( job.width, job.height ) );
+    psky.setVectorStars( job.fileName.endsWith( ".svg", Qt::CaseInsensitive ) );
+    psky.begin();
+    psky.drawSkyBackground();
+    // Drawing the sky resets the labeler for the chart's projector
+    data->skyComposite()->draw( &psky );
+    SkyLabeler::Instance()->draw( psky );
+    foreach ( FOV *fov, data->getVisibleFOVs() )
+        fov->draw( psky, zoom );
+    psky.end();
+
+    map->swapProjector( mapProj );
+    delete proj;
+}
+
+bool BatchChartExporter::renderChart( const Job &job, QPicture picture )
+{
+    // The picture is shared with the GUI thread until it is detached
+    picture.detach();
+
+    if ( job.fileName.endsWith( ".svg", Qt::CaseInsensitive ) ) {
+        QSvgGenerator svgGenerator;
+        svgGenerator.setFileName( job.fileName );
+        svgGenerator.setSize( QSize( job.width, job.height ) );
+        svgGenerator.setViewBox( QRect( 0, 0, job.width, job.height ) );
+
+        QPainter p;
+        if ( !p.begin( &svgGenerator ) )
+            return false;
+        p.drawPicture( 0, 0, picture );
+        return p.end();
+    }
+
+    QImage image( job.width, job.height, QImage::Format_ARGB32_Premultiplied );
+    image.fill( 0 );
+    QPainter p;
+    p.begin( &image );
+    p.drawPicture( 0, 0, picture );
+    p.end();
+
+    // The format follows the file name extension
+    return image.save( job.fileName );
+}
+
+bool BatchChartExporter::finishChart( QFuture<bool> future, const QString &fileName )
+{
+    if ( future.result() )
+        return true;
+
+    m_lastErrorMessage = i18n( "Error: Unable to save image: %1 ", fileName );
+    kWarning() << m_lastErrorMessage;
+    return false;
+}
+
+int BatchChartExporter::exportAll()
+{
+    QList<Job> jobs;
+    qSwap( jobs, m_jobs );
+    if ( jobs.isEmpty() )
+        return 0;
+
+    SkyMap *map = m_KStars->map();
+    KStarsData *data = KStarsData::Instance();
+
+    // Remember the live view to restore it afterwards
+    SkyPoint focus = *map->focus();
+    double zoom = Options::zoomFactor();
+    KStarsDateTime ut = data->ut();
+    KStarsDateTime currentUT = ut;
+    bool clockRunning = data->clock()->isActive();
+    if ( clockRunning )
+        data->clock()->stop();
+
+    // Keep a few charts per core in flight so workers never wait
+    int maxPending = 2 * qMax( 1, QThread::idealThreadCount() );
+    QList< QFuture<bool> > pending;
+    QStringList pendingNames;
+    int written = 0;
+
+    m_lastErrorMessage = QString();
+    foreach ( const Job &job, jobs ) {
+        KStarsDateTime jobUT = job.ut.isValid() ? job.ut : ut;
+        if ( jobUT != currentUT ) {
+            data->changeDateTime( jobUT );
+            data->updateTime( data->geo(), map );
+            currentUT = jobUT;
+        }
+
+        QPicture picture;
+        recordChart( job, &picture );
+
+        pending.append( QtConcurrent::run( renderChart, job, picture ) );
+        pendingNames.append( job.fileName );
+
+        while ( pending.size() >= maxPending || pending.first().isFinished() ) {
+            if ( finishChart( pending.takeFirst(), pendingNames.takeFirst() ) )
+                written++;
+            if ( pending.isEmpty() )
+                break;
+        }
+    }
+
+    while ( !pending.isEmpty() ) {
+        if ( finishChart( pending.takeFirst(), pendingNames.takeFirst() ) )
+            written++;
+    }
+
+    // Put the live view back
+    if ( currentUT != ut ) {
+        data->changeDateTime( ut );
+        data->updateTime( data->geo(), map );
+    }
+    Options::setZoomFactor( zoom );
+    map->setFocus( &focus );
+    if ( clockRunning )
+        data->clock()->start();
+    map->forceUpdate();
+
+    kDebug() << "Wrote" << written << "of" << jobs.size() << "charts";
+    return written;
+}
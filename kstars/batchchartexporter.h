@@ -0,0 +1,128 @@
+/***************************************************************************
+                 batchchartexporter.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2014-06-09
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef BATCHCHARTEXPORTER_H
+#define BATCHCHARTEXPORTER_H
+
+#include <QList>
+#include <QFuture>
+#include <QString>
+#include <QStringList>
+
+#include "kstarsdatetime.h"
+
+class KStars;
+class QPicture;
+
+/**
+ * @class BatchChartExporter
+ * @short Renders many sky charts to PNG or SVG files without touching the sky map view
+ *
+ * Every chart has its own center, field of view, size and optionally time.
+ * The sky is drawn for each chart through a projector of the chart's size,
+ * swapped into the SkyMap only while the chart is drawn, so the visible map,
+ * its focus and zoom are left as they were.
+ *
+ * The catalogs are drawn on the GUI thread, since the sky components keep
+ * their per-frame state in the shared objects. The result is recorded into
+ * a QPicture which is rasterized (or written as SVG) and saved in worker
+ * threads while the next chart is being drawn. For finder charts the
+ * rasterizing and encoding dominate, so throughput grows with the number of
+ * cores.
+ *
+ * Jobs are lines of text, e.g. from a job file:
+ *
+ *   file  RA  Dec  FOV  width  height  [UT]
+ *
+ * with RA in hours and Dec in degrees (J2000), FOV the width of the chart in
+ * degrees, the size in pixels and the UT date and time in ISO format. Without
+ * a time the current simulation time is used. The extension of the file
+ * selects the format; "svg" writes vector graphics. Empty lines and lines
+ * starting with '#' are ignored.
+ *
+ * @note Charts are always written to local files and have no legend.
+ */
+class BatchChartExporter
+{
+public:
+    /** @short One chart to render */
+    struct Job {
+        Job();
+
+        QString fileName;
+        double ra, dec;        ///< J2000 center, hours and degrees
+        double fov;            ///< horizontal field of view, degrees
+        int width, height;     ///< pixels
+        KStarsDateTime ut;     ///< invalid to use the current time
+    };
+
+    /**
+     * @short Constructor
+     */
+    explicit BatchChartExporter( KStars *kstars );
+
+    /**
+     * @short Parses one job line
+     * @return false if the line is not a valid job
+     */
+    static bool parseJob( const QString &line, Job *job );
+
+    /**
+     * @short Adds the jobs in a job file
+     * @return false if the file could not be read or had invalid lines;
+     * the valid lines are added anyway
+     */
+    bool loadJobs( const QString &fileName );
+
+    /**
+     * @short Adds the jobs in a list of job lines
+     * @return false if some lines were invalid
+     */
+    bool addJobs( const QStringList &lines );
+
+    inline void addJob( const Job &job ) { m_jobs.append( job ); }
+
+    inline int jobCount() const { return m_jobs.size(); }
+
+    /**
+     * @short Renders all jobs added so far and clears the job list
+     * @return the number of charts written
+     */
+    int exportAll();
+
+    /**
+     * @return last error message
+     */
+    inline QString getLastErrorMessage() const { return m_lastErrorMessage; }
+
+private:
+    /** @short Draws the sky for one job into picture, on the GUI thread */
+    void recordChart( const Job &job, QPicture *picture );
+
+    /** @short Rasterizes or writes picture as SVG and saves it; runs in a worker thread */
+    static bool renderChart( const Job &job, QPicture picture );
+
+    /** @short Waits for a rendered chart and records an error if it failed */
+    bool finishChart( QFuture<bool> future, const QString &fileName );
+
+    KStars *m_KStars;
+    QList<Job> m_jobs;
+    QString m_lastErrorMessage;
+};
+
+#endif
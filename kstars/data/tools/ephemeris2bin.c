@@ -0,0 +1,206 @@
+/***************************************************************************
+     ephemeris2bin.c - Compile ephemeris text files into one binary file
+                             -------------------
+    begin                : 2014-06-13
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/*
+ * Usage: ephemeris2bin <output file> <input file> [<input file> ...]
+ *
+ * Every input file (VSOP87 terms, ELP terms of the Moon, orbit curves)
+ * becomes one table of doubles named after the file, e.g. "mars.L0.vsop".
+ * The number of columns follows from the kind of file (see
+ * expectedColumns() below); lines with a different number of fields, like
+ * the single number heading some VSOP87 files, are skipped just as the text
+ * loaders in KStars do.  See README.ephemerisfileformat for the layout.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define EPHEMERIS_MAGIC "KSEPHEM"
+#define EPHEMERIS_VERSION 1
+#define EPHEMERIS_BYTE_ORDER 0x01020304
+#define NAME_LENGTH 32
+#define MAX_COLUMNS 16
+
+typedef struct fileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t tableCount;
+    uint32_t reserved;
+} fileHeader;
+
+typedef struct tableEntry {
+    char name[NAME_LENGTH];
+    uint32_t rows;
+    uint32_t columns;
+    uint64_t offset;
+} tableEntry;
+
+typedef struct table {
+    tableEntry entry;
+    double *data;
+} table;
+
+/*
+ * Parses the numbers on one line into values. Returns the number of fields,
+ * or -1 if a field is not a number.
+ */
+int parseLine( char *line, double *values ) {
+    int n = 0;
+    char *token = strtok( line, " \t\r\n" );
+    while( token ) {
+        char *end;
+        double v = strtod( token, &end );
+        if( *end != '\0' )
+            return -1;
+        if( n < MAX_COLUMNS )
+            values[ n ] = v;
+        n++;
+        token = strtok( NULL, " \t\r\n" );
+    }
+    return n;
+}
+
+/*
+ * Returns the number of fields on a data line of the given file, or 0 if
+ * the kind of file is unknown.
+ */
+uint32_t expectedColumns( const char *baseName ) {
+    const char *suffix = strrchr( baseName, '.' );
+    if( strcmp( baseName, "moonLR.dat" ) == 0 )
+        return 6;
+    if( strcmp( baseName, "moonB.dat" ) == 0 )
+        return 5;
+    if( suffix && ( strcmp( suffix, ".vsop" ) == 0 || strcmp( suffix, ".orbit" ) == 0 ) )
+        return 3;
+    return 0;
+}
+
+int readTable( const char *fileName, table *t ) {
+    FILE *f;
+    char line[ 1024 ];
+    double values[ MAX_COLUMNS ];
+    const char *baseName;
+    size_t capacity = 0;
+
+    f = fopen( fileName, "r" );
+    if( !f ) {
+        fprintf( stderr, "ERROR: Could not open %s for reading.\n", fileName );
+        return 0;
+    }
+
+    baseName = strrchr( fileName, '/' );
+    baseName = baseName ? baseName + 1 : fileName;
+    if( strlen( baseName ) >= NAME_LENGTH ) {
+        fprintf( stderr, "ERROR: File name %s is too long.\n", baseName );
+        fclose( f );
+        return 0;
+    }
+
+    memset( &t->entry, 0, sizeof( tableEntry ) );
+    strcpy( t->entry.name, baseName );
+    t->entry.columns = expectedColumns( baseName );
+    t->data = NULL;
+    if( t->entry.columns == 0 ) {
+        fprintf( stderr, "ERROR: Unknown kind of ephemeris file %s.\n", baseName );
+        fclose( f );
+        return 0;
+    }
+
+    while( fgets( line, sizeof( line ), f ) ) {
+        int n = parseLine( line, values );
+        if( n <= 0 || (uint32_t)n != t->entry.columns )
+            continue;
+
+        if( ( t->entry.rows + 1 ) * t->entry.columns > capacity ) {
+            capacity = capacity ? 2 * capacity : 1024;
+            t->data = realloc( t->data, capacity * sizeof( double ) );
+            if( !t->data ) {
+                fprintf( stderr, "ERROR: Out of memory reading %s.\n", fileName );
+                fclose( f );
+                return 0;
+            }
+        }
+        memcpy( t->data + t->entry.rows * t->entry.columns, values, n * sizeof( double ) );
+        t->entry.rows++;
+    }
+
+    fclose( f );
+    return 1;
+}
+
+int main( int argc, char *argv[] ) {
+    fileHeader header;
+    table *tables;
+    FILE *out;
+    uint64_t offset;
+    int count, i;
+
+    if( argc < 3 ) {
+        fprintf( stderr, "USAGE: %s <output file> <input file> [<input file> ...]\n", argv[0] );
+        return 1;
+    }
+
+    count = argc - 2;
+    tables = calloc( count, sizeof( table ) );
+    for( i = 0; i < count; i++ ) {
+        if( !readTable( argv[ i + 2 ], &tables[ i ] ) )
+            return 1;
+    }
+
+    memset( &header, 0, sizeof( fileHeader ) );
+    strcpy( header.magic, EPHEMERIS_MAGIC );
+    header.version = EPHEMERIS_VERSION;
+    header.byteOrder = EPHEMERIS_BYTE_ORDER;
+    header.tableCount = count;
+
+    /* The header and table directory are multiples of 8 bytes, so every
+     * table starts aligned for doubles */
+    offset = sizeof( fileHeader ) + count * sizeof( tableEntry );
+    for( i = 0; i < count; i++ ) {
+        tables[ i ].entry.offset = offset;
+        offset += (uint64_t)tables[ i ].entry.rows * tables[ i ].entry.columns * sizeof( double );
+    }
+
+    out = fopen( argv[1], "wb" );
+    if( !out ) {
+        fprintf( stderr, "ERROR: Could not open %s for writing.\n", argv[1] );
+        return 1;
+    }
+
+    fwrite( &header, sizeof( fileHeader ), 1, out );
+    for( i = 0; i < count; i++ )
+        fwrite( &tables[ i ].entry, sizeof( tableEntry ), 1, out );
+    for( i = 0; i < count; i++ ) {
+        size_t n = (size_t)tables[ i ].entry.rows * tables[ i ].entry.columns;
+        if( n && fwrite( tables[ i ].data, sizeof( double ), n, out ) != n ) {
+            fprintf( stderr, "ERROR: Could not write %s.\n", argv[1] );
+            fclose( out );
+            return 1;
+        }
+        free( tables[ i ].data );
+    }
+
+    free( tables );
+    if( fclose( out ) != 0 ) {
+        fprintf( stderr, "ERROR: Could not write %s.\n", argv[1] );
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,165 @@
+/*  Ekos Dark Library
+    Copyright (C) 2014 by the KStars team <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "darklibrary.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+
+#include <KStandardDirs>
+
+#include "kstars.h"
+#include "Options.h"
+#include "fitsviewer/fitsimage.h"
+
+#include <basedevice.h>
+
+namespace Ekos
+{
+
+DarkLibrary * DarkLibrary::_DarkLibrary = NULL;
+
+DarkLibrary * DarkLibrary::Instance()
+{
+    if (_DarkLibrary == NULL)
+        _DarkLibrary = new DarkLibrary(KStars::Instance());
+
+    return _DarkLibrary;
+}
+
+DarkLibrary::DarkLibrary(QObject *parent) : QObject(parent)
+{
+}
+
+DarkLibrary::~DarkLibrary()
+{
+    darkFrames.clear();
+}
+
+QString DarkLibrary::getDarkKey(ISD::CCD *ccd, ISD::CCDChip *targetChip, double duration)
+{
+    int x=0,y=0,w=0,h=0, binx=1, biny=1;
+    targetChip->getFrame(&x, &y, &w, &h);
+    targetChip->getBinning(&binx, &biny);
+
+    QString key = QString("%1_%2_%3_%4_%5x%6_%7x%8_%9s").arg(ccd->getDeviceName())
+                  .arg(targetChip->getType() == ISD::CCDChip::GUIDE_CCD ? "guide" : "primary")
+                  .arg(x).arg(y).arg(w).arg(h).arg(binx).arg(biny).arg(duration);
+
+    // Dark current depends strongly on the sensor temperature, so keep darks per degree
+    INumberVectorProperty *nvp = ccd->getBaseDevice()->getNumber("CCD_TEMPERATURE");
+    if (nvp)
+    {
+        INumber *np = IUFindNumber(nvp, "CCD_TEMPERATURE_VALUE");
+        if (np)
+            key += QString("_%1C").arg(qRound(np->value));
+    }
+
+    // Bias and dark signal change with gain and offset, for cameras that have them
+    nvp = ccd->getBaseDevice()->getNumber("CCD_GAIN");
+    if (nvp && nvp->nnp > 0)
+        key += QString("_g%1").arg(nvp->np[0].value);
+
+    nvp = ccd->getBaseDevice()->getNumber("CCD_OFFSET");
+    if (nvp && nvp->nnp > 0)
+        key += QString("_o%1").arg(nvp->np[0].value);
+
+    return key;
+}
+
+QString DarkLibrary::getDarkFileName(const QString &key)
+{
+    QString fileName = key;
+    fileName.replace(QRegExp("[^A-Za-z0-9_.\\-]"), "_");
+
+    return KStandardDirs::locateLocal("appdata", QString("darks/%1.fits").arg(fileName));
+}
+
+QSharedPointer<FITSImage> DarkLibrary::getDarkFrame(ISD::CCD *ccd, ISD::CCDChip *targetChip, double duration)
+{
+    QString key = getDarkKey(ccd, targetChip, duration);
+    QString fileName = getDarkFileName(key);
+
+    // Darks older than the configured number of days are taken again
+    QFileInfo darkFile(fileName);
+    if (darkFile.exists() == false || darkFile.lastModified().daysTo(QDateTime::currentDateTime()) > Options::darkLibraryDuration())
+    {
+        darkFrames.remove(key);
+        return QSharedPointer<FITSImage>();
+    }
+
+    QSharedPointer<FITSImage> darkImage = darkFrames.value(key);
+    if (darkImage)
+        return darkImage;
+
+    // Load from disk on first use
+    darkImage = QSharedPointer<FITSImage>(new FITSImage(FITS_CALIBRATE));
+    if (darkImage->loadFITS(fileName) == false)
+        return QSharedPointer<FITSImage>();
+
+    darkFrames.insert(key, darkImage);
+
+    return darkImage;
+}
+
+QSharedPointer<FITSImage> DarkLibrary::addDarkFrame(ISD::CCD *ccd, ISD::CCDChip *targetChip, double duration, FITSImage *darkImage)
+{
+    if (darkImage == NULL)
+        return QSharedPointer<FITSImage>();
+
+    QString key = getDarkKey(ccd, targetChip, duration);
+    QString fileName = getDarkFileName(key);
+
+    // The dark image belongs to the FITS viewer, so it is written to the library without touching it
+    if (saveDarkFrame(darkImage, fileName) == false)
+        return QSharedPointer<FITSImage>();
+
+    // Keep our own copy so the dark outlives the FITS viewer tab it came from.
+    // Whoever still holds the old one keeps it until done.
+    darkFrames.remove(key);
+
+    return getDarkFrame(ccd, targetChip, duration);
+}
+
+bool DarkLibrary::saveDarkFrame(FITSImage *darkImage, const QString &fileName)
+{
+    int status=0, closeStatus=0;
+    fitsfile *fptr=NULL;
+    long naxes[2] = { darkImage->getWidth(), darkImage->getHeight() };
+
+    // The leading ! makes cfitsio replace an old or damaged dark
+    if (fits_create_file(&fptr, QString("!%1").arg(fileName).toAscii(), &status))
+    {
+        fits_report_error(stderr, status);
+        return false;
+    }
+
+    if (fits_create_img(fptr, FLOAT_IMG, 2, naxes, &status) ||
+        fits_write_img(fptr, TFLOAT, 1, naxes[0] * naxes[1], darkImage->getImageBuffer(), &status) ||
+        fits_write_date(fptr, &status))
+    {
+        fits_report_error(stderr, status);
+        fits_close_file(fptr, &closeStatus);
+        QFile::remove(fileName);
+        return false;
+    }
+
+    if (fits_close_file(fptr, &status))
+    {
+        fits_report_error(stderr, status);
+        QFile::remove(fileName);
+        return false;
+    }
+
+    return true;
+}
+
+#include "darklibrary.moc"
@@ -0,0 +1,70 @@
+/*  Ekos Dark Library
+    Copyright (C) 2014 by the KStars team <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef DARKLIBRARY_H
+#define DARKLIBRARY_H
+
+#include <QObject>
+#include <QHash>
+#include <QSharedPointer>
+
+#include "indi/indiccd.h"
+
+class FITSImage;
+
+namespace Ekos
+{
+
+/**
+ *@class DarkLibrary
+ *@short Cache of dark frames shared across Ekos sessions.
+ *
+ * Dark frames are stored on disk under the user's KStars data directory, keyed by
+ * camera, chip, frame geometry, binning, exposure, sensor temperature, gain and offset.
+ * They are only loaded into memory when first requested, so darks taken in a previous
+ * session can be reused without capturing them again. Darks older than the
+ * DarkLibraryDuration option are not reused.
+ *
+ * Frames are handed out as shared pointers, so a dark the library drops or replaces
+ * stays valid for as long as a guide frame is still being calibrated with it.
+ * Only the guide module uses the library so far; focus and capture preview frames
+ * and flat frames are not calibrated from it.
+ */
+class DarkLibrary : public QObject
+{
+    Q_OBJECT
+
+public:
+    static DarkLibrary *Instance();
+
+    /** @return dark frame matching the current settings of the chip, or NULL if none is available. */
+    QSharedPointer<FITSImage> getDarkFrame(ISD::CCD *ccd, ISD::CCDChip *targetChip, double duration);
+
+    /**
+     * @short Add a newly captured dark frame to the library.
+     * @return the library copy of the dark frame, or NULL if it could not be stored.
+     */
+    QSharedPointer<FITSImage> addDarkFrame(ISD::CCD *ccd, ISD::CCDChip *targetChip, double duration, FITSImage *darkImage);
+
+private:
+    DarkLibrary(QObject *parent);
+    ~DarkLibrary();
+
+    QString getDarkKey(ISD::CCD *ccd, ISD::CCDChip *targetChip, double duration);
+    QString getDarkFileName(const QString &key);
+    bool saveDarkFrame(FITSImage *darkImage, const QString &fileName);
+
+    static DarkLibrary * _DarkLibrary;
+
+    QHash<QString, QSharedPointer<FITSImage> > darkFrames;
+};
+
+}
+
+#endif  // DARKLIBRARY_H
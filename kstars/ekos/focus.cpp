@@ -45,6 +45,7 @@ Focus::Focus()
 
     HFRInc =0;
     reverseDir = false;
+    curveFitStage = CURVE_FIT_SAMPLING;
 
     pulseDuration = 1000;
 
@@ -69,6 +70,11 @@ Focus::Focus()
     HFRPlot->axis( KPlotWidget::LeftAxis )->setLabel( i18nc("Half Flux Radius", "HFR") );
     HFRPlot->axis( KPlotWidget::BottomAxis )->setLabel( i18n("Absolute Position") );
 
+    HFRCurve = new KPlotObject( Qt::red, KPlotObject::Points, 2 );
+    fitCurve = new KPlotObject( Qt::green, KPlotObject::Lines, 1 );
+    HFRPlot->addPlotObject(HFRCurve);
+    HFRPlot->addPlotObject(fitCurve);
+
     resetButtons();
 
     appendLogText(i18n("Idle."));
@@ -85,6 +91,7 @@ Focus::Focus()
     kcfg_focusYBin->setValue(Options::focusYBin());
     maxTravel->setValue(Options::focusMaxTravel());
     kcfg_subFrame->setChecked(Options::focusSubFrame());
+    kcfg_focusCurveFit->setChecked(Options::focusCurveFit());
 
 }
 
@@ -190,9 +197,12 @@ void Focus::startFocus()
 
     reverseDir = false;
     starSelected= false;
+    curveFitStage = CURVE_FIT_SAMPLING;
 
     qDeleteAll(HFRPoints);
     HFRPoints.clear();
+    HFRCurve->clearPoints();
+    fitCurve->clearPoints();
 
     Options::setFocusTicks(stepIN->value());
     Options::setFocusTolerance(toleranceIN->value());
@@ -203,6 +213,7 @@ void Focus::startFocus()
 
     Options::setFocusSubFrame(kcfg_subFrame->isChecked());
     Options::setAutoSelectStar(kcfg_autoSelectStar->isChecked());
+    Options::setFocusCurveFit(kcfg_focusCurveFit->isChecked());
 
     #ifdef FOCUS_DEBUG
     qDebug() << "Starting focus with pulseDuration " << pulseDuration << endl;
@@ -243,6 +254,7 @@ void Focus::stopFocus()
     absIterations = 0;
     HFRInc=0;
     reverseDir = false;
+    curveFitStage = CURVE_FIT_SAMPLING;
 
 }
 
@@ -373,7 +385,8 @@ void Focus::newFITS(IBLOB *bp)
 
     image_data->findStars();
 
-    double currentHFR= image_data->getHFR(HFR_MAX);
+    // Curve fitting measures every frame with the median of all stars, which is more robust
+    double currentHFR= image_data->getHFR((canAbsMove && kcfg_focusCurveFit->isChecked()) ? HFR_MEDIAN : HFR_MAX);
 
     if (currentHFR == -1)
     {
@@ -535,19 +548,91 @@ void Focus::autoFocusAbs(double currentHFR)
 
     HFRPoints.append(p);
 
-    HFRPlot->removeAllPlotObjects();
-
     HFRPlot->setLimits(minPos-pulseDuration, maxPos+pulseDuration, currentHFR/1.5, maxHFR );
 
-    KPlotObject *hfrObj = new KPlotObject( Qt::red, KPlotObject::Points, 2 );
-
+    HFRCurve->clearPoints();
     foreach(HFRPoint *p, HFRPoints)
-        hfrObj->addPoint(p->pos, p->HFR);
-
-    HFRPlot->addPlotObject(hfrObj);
+        HFRCurve->addPoint(p->pos, p->HFR);
 
     HFRPlot->update();
 
+    if (kcfg_focusCurveFit->isChecked() && lastFocusDirection != FOCUS_NONE)
+    {
+        if (curveFitStage == CURVE_FIT_SAMPLING)
+        {
+            double fitPosition=0;
+
+            fitCurve->clearPoints();
+            if (fitVCurve(&fitPosition, fitCurve))
+            {
+                HFRPlot->update();
+
+                targetPulse = qRound(fitPosition);
+
+                if (targetPulse >= absMotionMin && targetPulse <= absMotionMax && fabs(targetPulse - initHFRPos) <= maxTravel->value())
+                {
+                    #ifdef FOCUS_DEBUG
+                    qDebug() << "Fitted V-Curve minimum at " << fitPosition << endl;
+                    #endif
+
+                    curveFitStage = CURVE_FIT_VERIFY;
+
+                    delta = (targetPulse - pulseStep);
+
+                    // Otherwise this frame was taken at the fitted minimum and is checked below
+                    if (delta != 0)
+                    {
+                        appendLogText(i18n("Moving to fitted focus position %1.", targetPulse));
+
+                        if (delta > 0)
+                            FocusIn(delta);
+                        else
+                            FocusOut(fabs(delta));
+
+                        return;
+                    }
+                }
+            }
+        }
+
+        // This frame was taken at the fitted minimum, it must be about as good as the best sample
+        if (curveFitStage == CURVE_FIT_VERIFY)
+        {
+            HFRPoint *bestPoint = NULL;
+            foreach(HFRPoint *sample, HFRPoints)
+                if (sample != p && (bestPoint == NULL || sample->HFR < bestPoint->HFR))
+                    bestPoint = sample;
+
+            if (bestPoint == NULL || currentHFR - bestPoint->HFR < (toleranceIN->value()/100.0) || bestPoint->pos == pulseStep)
+            {
+                appendLogText(i18n("Autofocus complete."));
+                stopFocus();
+                return;
+            }
+
+            appendLogText(i18n("HFR at the fitted focus position is worse than at position %1, moving back.", bestPoint->pos));
+
+            curveFitStage = CURVE_FIT_FALLBACK;
+
+            delta = (bestPoint->pos - pulseStep);
+
+            if (delta > 0)
+                FocusIn(delta);
+            else
+                FocusOut(fabs(delta));
+
+            return;
+        }
+
+        // Back at the best sample
+        if (curveFitStage == CURVE_FIT_FALLBACK)
+        {
+            appendLogText(i18n("Autofocus complete."));
+            stopFocus();
+            return;
+        }
+    }
+
     switch (lastFocusDirection)
     {
         case FOCUS_NONE:
@@ -790,6 +875,34 @@ void Focus::autoFocusAbs(double currentHFR)
 }
 
 
+bool Focus::fitVCurve(double *minPosition, KPlotObject *curve)
+{
+    VCurveFit fit;
+
+    if (Ekos::fitVCurve(HFRPoints, minPosition, &fit) == false)
+        return false;
+
+    #ifdef FOCUS_DEBUG
+    qDebug() << "V-Curve fit HFR^2 = " << fit.a << "x^2 + " << fit.b << "x + " << fit.c << endl;
+    #endif
+
+    if (curve)
+    {
+        const int curveSteps = 50;
+        double step = (fit.maxSample - fit.minSample) / curveSteps;
+
+        for (int i=0; i <= curveSteps; i++)
+        {
+            double x  = fit.minSample + i * step - fit.center;
+            double y2 = fit.a*x*x + fit.b*x + fit.c;
+            if (y2 > 0)
+                curve->addPoint(fit.minSample + i * step, sqrt(y2));
+        }
+    }
+
+    return true;
+}
+
 void Focus::autoFocusRel(double currentHFR)
 {
     QString deltaTxt = QString("%1").arg(fabs(currentHFR-HFR)*100.0, 0,'g', 2);
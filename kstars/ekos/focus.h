@@ -11,6 +11,7 @@
 #define FOCUS_H
 
 #include "focus.h"
+#include "focusfit.h"
 #include "capture.h"
 
 #include "ui_focus.h"
@@ -24,12 +25,6 @@ class KPlotObject;
 namespace Ekos
 {
 
-struct HFRPoint
-{
-    int pos;
-    double HFR;
-};
-
 class Focus : public QWidget, public Ui::Focus
 {
 
@@ -45,6 +40,7 @@ public:
 
     typedef enum { FOCUS_NONE, FOCUS_IN, FOCUS_OUT } FocusDirection;
     typedef enum { FOCUS_MANUAL, FOCUS_AUTO, FOCUS_LOOP } FocusType;
+    typedef enum { CURVE_FIT_SAMPLING, CURVE_FIT_VERIFY, CURVE_FIT_FALLBACK } CurveFitStage;
 
     void appendLogText(const QString &);
     void clearLog();
@@ -77,6 +73,7 @@ private:
     void getAbsFocusPosition();
     void autoFocusAbs(double currentHFR);
     void autoFocusRel(double currentHFR);
+    bool fitVCurve(double *minPosition, KPlotObject *curve=NULL);
 
     void resetButtons();
 
@@ -106,11 +103,13 @@ private:
     int HFRDec;
     bool reverseDir;
     bool starSelected;
+    CurveFitStage curveFitStage;
     int fx,fy,fw,fh;
 
     QStringList logText;
 
     QList<HFRPoint *> HFRPoints;
+    KPlotObject *HFRCurve, *fitCurve;
 };
 
 }
@@ -0,0 +1,141 @@
+/*  Ekos Focus V-Curve fitting
+    Copyright (C) 2014 by the KStars team <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "focusfit.h"
+
+#include <cmath>
+
+#define MINIMUM_FIT_POINTS      5
+
+namespace Ekos
+{
+
+bool fitVCurve(const QList<HFRPoint *> &points, double *minPosition, VCurveFit *fit)
+{
+    // Around focus, HFR follows a hyperbola of the focuser position. Its square is a parabola,
+    // so we fit HFR^2 = a*x^2 + b*x + c with linear least squares and take the vertex as the minimum.
+    QList<HFRPoint *> samples = points;
+
+    if (samples.count() < MINIMUM_FIT_POINTS)
+        return false;
+
+    // We need samples on both sides of the best one to locate the minimum
+    HFRPoint *bestPoint = samples.first();
+    foreach(HFRPoint *p, samples)
+        if (p->HFR < bestPoint->HFR)
+            bestPoint = p;
+
+    int inSide=0, outSide=0;
+    double minSample=bestPoint->pos, maxSample=bestPoint->pos;
+    foreach(HFRPoint *p, samples)
+    {
+        if (p->pos < bestPoint->pos)
+            outSide++;
+        else if (p->pos > bestPoint->pos)
+            inSide++;
+
+        minSample = qMin(minSample, (double) p->pos);
+        maxSample = qMax(maxSample, (double) p->pos);
+    }
+
+    if (inSide < 2 || outSide < 2)
+        return false;
+
+    double a=0, b=0, c=0, center=0;
+
+    // Fit, reject outliers, and fit again
+    for (int pass=0; pass < 2; pass++)
+    {
+        if (samples.count() < MINIMUM_FIT_POINTS)
+            return false;
+
+        // Center positions to keep the normal equations well conditioned
+        center=0;
+        foreach(HFRPoint *p, samples)
+            center += p->pos;
+        center /= samples.count();
+
+        double s0=0, s1=0, s2=0, s3=0, s4=0, t0=0, t1=0, t2=0;
+        foreach(HFRPoint *p, samples)
+        {
+            double x  = p->pos - center;
+            double x2 = x * x;
+            double y  = p->HFR * p->HFR;
+
+            s0 += 1;
+            s1 += x;
+            s2 += x2;
+            s3 += x2 * x;
+            s4 += x2 * x2;
+            t0 += y;
+            t1 += x * y;
+            t2 += x2 * y;
+        }
+
+        double det = s4*(s2*s0 - s1*s1) - s3*(s3*s0 - s1*s2) + s2*(s3*s1 - s2*s2);
+        if (det == 0)
+            return false;
+
+        a = (t2*(s2*s0 - s1*s1) - s3*(t1*s0 - s1*t0) + s2*(t1*s1 - s2*t0)) / det;
+        b = (s4*(t1*s0 - s1*t0) - t2*(s3*s0 - s1*s2) + s2*(s3*t0 - t1*s2)) / det;
+        c = (s4*(s2*t0 - t1*s1) - s3*(s3*t0 - t1*s2) + t2*(s3*s1 - s2*s2)) / det;
+
+        if (pass == 1)
+            break;
+
+        // Reject samples whose residual exceeds twice the RMS residual
+        double sqrSum=0;
+        foreach(HFRPoint *p, samples)
+        {
+            double x = p->pos - center;
+            double r = p->HFR * p->HFR - (a*x*x + b*x + c);
+            sqrSum += r * r;
+        }
+
+        double limit = 2 * sqrt(sqrSum / samples.count());
+
+        QList<HFRPoint *> inliers;
+        foreach(HFRPoint *p, samples)
+        {
+            double x = p->pos - center;
+            if (fabs(p->HFR * p->HFR - (a*x*x + b*x + c)) <= limit)
+                inliers.append(p);
+        }
+
+        if (inliers.count() == samples.count())
+            break;
+
+        samples = inliers;
+    }
+
+    // Curve must open upwards with its vertex inside the sampled range
+    if (a <= 0)
+        return false;
+
+    double vertex = center - b / (2 * a);
+
+    if (vertex < minSample || vertex > maxSample)
+        return false;
+
+    *minPosition = vertex;
+
+    if (fit)
+    {
+        fit->a = a;
+        fit->b = b;
+        fit->c = c;
+        fit->center    = center;
+        fit->minSample = minSample;
+        fit->maxSample = maxSample;
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,46 @@
+/*  Ekos Focus V-Curve fitting
+    Copyright (C) 2014 by the KStars team <kstars-devel@kde.org>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef FOCUSFIT_H
+#define FOCUSFIT_H
+
+#include <QList>
+
+namespace Ekos
+{
+
+struct HFRPoint
+{
+    int pos;
+    double HFR;
+};
+
+/* The fitted curve is HFR^2 = a*x^2 + b*x + c, with x the focuser position minus center */
+struct VCurveFit
+{
+    double a, b, c;
+    double center;
+    double minSample, maxSample;    /* range of the sampled positions */
+};
+
+/**
+ * @short Fits a V-curve to HFR samples and locates its minimum.
+ *
+ * Around focus, HFR follows a hyperbola of the focuser position, so its square is fitted as a
+ * parabola, samples with large residuals are rejected and the fit is repeated once.
+ * @param points the samples, which need at least two positions on either side of the best one
+ * @param minPosition set to the focuser position of the minimum
+ * @param fit if not NULL, set to the fitted curve
+ * @return false if there are too few samples or the minimum is not within the sampled range
+ */
+bool fitVCurve(const QList<HFRPoint *> &points, double *minPosition, VCurveFit *fit=NULL);
+
+}
+
+#endif
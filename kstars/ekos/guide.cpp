@@ -10,6 +10,7 @@
 #include "guide.h"
 
 #include <QDateTime>
+#include <QtConcurrentRun>
 
 #include "guide/gmath.h"
 #include "guide/guider.h"
@@ -24,9 +25,15 @@
 #include "fitsviewer/fitsview.h"
 
 #include "guide/rcalibration.h"
+#include "darklibrary.h"
 
 #include <basedevice.h>
 
+// Deleter for images that belong to a FITS viewer
+static void keepImage(FITSImage *)
+{
+}
+
 namespace Ekos
 {
 
@@ -41,7 +48,11 @@ Guide::Guide() : QWidget()
     useDarkFrame = false;
     rapidGuideReticleSet = false;
     darkExposure = 0;
-    darkImage = NULL;
+    lastExposure = 0;
+    lastPulse = 0;
+    downloadLatency = 0;
+    processingImage = NULL;
+    darkMismatchLogged = false;
     AODriver= NULL;
     GuideDriver=NULL;
 
@@ -56,6 +67,8 @@ Guide::Guide() : QWidget()
     connect(pmath, SIGNAL(newAxisDelta(double,double)), this, SIGNAL(newAxisDelta(double,double)));
     connect(pmath, SIGNAL(newAxisDelta(double,double)), this, SLOT(updateGuideDriver(double,double)));
 
+    connect(&frameWatcher, SIGNAL(finished()), this, SLOT(processFrame()));
+
     calibration = new rcalibration(this);
     calibration->set_math(pmath);
 
@@ -249,10 +262,19 @@ bool Guide::capture()
         return false;
     }
 
-    // Exposure changed, take a new dark
+    // Exposure changed, take a new dark unless the dark library already has one
     if (useDarkFrame && darkExposure != seqExpose)
     {
         darkExposure = seqExpose;
+
+        darkImage = DarkLibrary::Instance()->getDarkFrame(currentCCD, targetChip, seqExpose);
+        darkMismatchLogged = false;
+        if (darkImage)
+        {
+            appendLogText(i18n("Using dark frame from the dark library."));
+            return capture();
+        }
+
         targetChip->setFrameType(FRAME_DARK);
 
         KMessageBox::information(NULL, i18n("If the guider camera if not equipped with a shutter, cover the telescope or camera in order to take a dark exposure."), i18n("Dark Exposure"), "dark_exposure_dialog_notification");
@@ -269,6 +291,9 @@ bool Guide::capture()
     targetChip->setCaptureFilter( (FITSScale) filterCombo->currentIndex());
     targetChip->setFrameType(ccdFrame);
 
+    lastExposure = seqExpose;
+    exposureTimer.start();
+
     if (guider->is_guiding())
     {
          if (guider->isRapidGuide() == false)
@@ -288,8 +313,6 @@ void Guide::newFITS(IBLOB *bp)
 {
     INDI_UNUSED(bp);
 
-    FITSViewer *fv = currentCCD->getViewer();
-
     disconnect(currentCCD, SIGNAL(BLOBUpdated(IBLOB*)), this, SLOT(newFITS(IBLOB*)));
 
     ISD::CCDChip *targetChip = currentCCD->getChip(useGuideHead ? ISD::CCDChip::GUIDE_CCD : ISD::CCDChip::PRIMARY_CCD);
@@ -300,7 +323,11 @@ void Guide::newFITS(IBLOB *bp)
         FITSView *targetImage = targetChip->getImage(FITS_CALIBRATE);
         if (targetImage)
         {
-            darkImage = targetImage->getImageData();
+            darkImage = DarkLibrary::Instance()->addDarkFrame(currentCCD, targetChip, darkExposure, targetImage->getImageData());
+            // The dark could not be stored, so use the one in the viewer, which owns it
+            if (darkImage.isNull())
+                darkImage = QSharedPointer<FITSImage>(targetImage->getImageData(), keepImage);
+            darkMismatchLogged = false;
             capture();
         }
         else
@@ -324,10 +351,56 @@ void Guide::newFITS(IBLOB *bp)
     if (image_data == NULL)
         return;
 
+    // Time spent transferring and loading the frame beyond the exposure itself
+    downloadLatency = qMax(0, exposureTimer.elapsed() - (int) (lastExposure * 1000));
+    processTimer.start();
+
+    // The worker holds its own reference, so a dark replaced meanwhile stays valid
+    QSharedPointer<FITSImage> frameDark;
+    if (darkImage && darkImage->getWidth() == image_data->getWidth() && darkImage->getHeight() == image_data->getHeight())
+        frameDark = darkImage;
+    else if (darkImage && darkMismatchLogged == false)
+    {
+        appendLogText(i18n("Warning: Dark frame size %1x%2 does not match the guide frame size %3x%4. Dark subtraction is skipped.",
+                           darkImage->getWidth(), darkImage->getHeight(), image_data->getWidth(), image_data->getHeight()));
+        darkMismatchLogged = true;
+    }
+
+    QRect searchRegion;
+    bool searchStars = guideStarRegion(&searchRegion);
+
+    // Dark subtraction and star detection run on a worker thread, the rest in processFrame().
+    // The view must not touch the detected stars until then.
+    processingImage = targetImage;
+    targetImage->setImageBusy(true);
+    frameWatcher.setFuture(QtConcurrent::run(prepareFrame, image_data, frameDark, searchStars, searchRegion));
+}
+
+void Guide::prepareFrame(FITSImage *image_data, QSharedPointer<FITSImage> darkImage, bool searchStars, QRect searchRegion)
+{
     if (darkImage)
         image_data->subtract(darkImage->getImageBuffer());
 
-    image_data->findStars();
+    if (searchStars == false)
+        return;
+
+    // Fall back to a full frame search if the star is not found in the region
+    if (image_data->findStars(searchRegion) <= 0 && searchRegion.isValid())
+        image_data->findStars();
+}
+
+void Guide::processFrame()
+{
+    FITSView *targetImage = processingImage;
+    processingImage = NULL;
+
+    // The viewer was closed while the frame was processed
+    if (targetImage == NULL)
+        return;
+
+    targetImage->setImageBusy(false);
+
+    FITSViewer *fv = currentCCD->getViewer();
 
     pmath->set_image(targetImage);
     guider->set_image(targetImage);
@@ -347,10 +420,22 @@ void Guide::newFITS(IBLOB *bp)
     }
     else if (guider->is_guiding())
     {
+        lastPulse = 0;
+
         guider->guide();
 
-         if (guider->is_guiding())
-            capture();
+        guider->set_frame_latency(downloadLatency, processTimer.elapsed());
+
+        if (guider->is_guiding())
+        {
+            // In pipelined mode the next exposure starts as soon as the correction pulse is issued.
+            // Otherwise it waits for a pulse that is still running, so the mount is settled.
+            int pulseLeft = lastPulse > 0 ? lastPulse - pulseTimer.elapsed() : 0;
+            if (guider->is_pipelined() || pulseLeft <= 0)
+                capture();
+            else
+                QTimer::singleShot(pulseLeft, this, SLOT(capture()));
+        }
     }
     else if (calibration->is_calibrating())
     {
@@ -368,6 +453,27 @@ void Guide::newFITS(IBLOB *bp)
 
 }
 
+bool Guide::guideStarRegion(QRect *searchRegion)
+{
+    // Calibration needs the full frame to select a guide star
+    if (calibration->is_calibrating() || (guider->is_guiding() == false && guider->is_dithering() == false))
+    {
+        *searchRegion = QRect();
+        return true;
+    }
+
+    // Only the centroid algorithm uses the detected stars while guiding
+    if (pmath->get_square_algorithm_index() != CENTROID_THRESHOLD)
+        return false;
+
+    // Search the guide square plus a margin of one square size on each side
+    double square_x=0, square_y=0;
+    int square_size = pmath->get_square_size();
+    pmath->get_square_pos(&square_x, &square_y);
+
+    *searchRegion = QRect((int) square_x - square_size, (int) square_y - square_size, square_size*3, square_size*3);
+    return true;
+}
 
 void Guide::appendLogText(const QString &text)
 {
@@ -399,6 +505,9 @@ bool Guide::do_pulse( GuideDirection ra_dir, int ra_msecs, GuideDirection dec_di
     if (calibration->is_calibrating())
         QTimer::singleShot( (ra_msecs > dec_msecs ? ra_msecs : dec_msecs) + 100, this, SLOT(capture()));
 
+    lastPulse = qMax(ra_dir == NO_DIR ? 0 : ra_msecs, dec_dir == NO_DIR ? 0 : dec_msecs);
+    pulseTimer.start();
+
     return GuideDriver->doPulse(ra_dir, ra_msecs, dec_dir, dec_msecs);
 }
 
@@ -410,6 +519,9 @@ bool Guide::do_pulse( GuideDirection dir, int msecs )
     if (calibration->is_calibrating())
         QTimer::singleShot(msecs+100, this, SLOT(capture()));
 
+    lastPulse = msecs;
+    pulseTimer.start();
+
     return GuideDriver->doPulse(dir, msecs);
 
 }
@@ -431,6 +543,11 @@ double Guide::getReticleAngle()
 
 void Guide::viewerClosed()
 {
+    // Do not leave the worker with the image of the closed viewer
+    if (frameWatcher.isRunning())
+        frameWatcher.waitForFinished();
+    processingImage = NULL;
+
     pmath->set_image(NULL);
     guider->set_image(NULL);
     calibration->set_image(NULL);
@@ -11,6 +11,9 @@
 #define guide_H
 
 #include <QTimer>
+#include <QTime>
+#include <QFutureWatcher>
+#include <QSharedPointer>
 
 #include <KFileItemList>
 #include <KDirLister>
@@ -77,6 +80,7 @@ public slots:
         void updateGuideDriver(double delta_ra, double delta_dec);
         bool capture();
         void viewerClosed();
+        void processFrame();
         void dither();
 
 signals:
@@ -91,6 +95,8 @@ signals:
 
 private:
     void updateGuideParams();
+    bool guideStarRegion(QRect *searchRegion);
+    static void prepareFrame(FITSImage *image_data, QSharedPointer<FITSImage> darkImage, bool searchStars, QRect searchRegion);
     ISD::CCD *currentCCD;
     ISD::Telescope *currentTelescope;
     ISD::ST4* ST4Driver;
@@ -112,13 +118,21 @@ private:
 
     bool useDarkFrame;
     double darkExposure;
-    FITSImage *darkImage;
+    QSharedPointer<FITSImage> darkImage;
+    bool darkMismatchLogged;
 
     QStringList logText;
 
     double ccd_hor_pixel, ccd_ver_pixel, focal_length, aperture;
     bool rapidGuideReticleSet;
 
+    // Guide frame processing and latency
+    QFutureWatcher<void> frameWatcher;
+    FITSView *processingImage;
+    QTime exposureTimer, processTimer, pulseTimer;
+    double lastExposure;
+    int downloadLatency, lastPulse;
+
 };
 
 }
@@ -60,6 +60,7 @@ cgmath::cgmath() : QObject()
     useRapidGuide = false;
     dec_swap = false;
     pimage = NULL;
+    pimage_data = NULL;
 
 	// square variables
 	square_idx		= DEFAULT_SQR;
@@ -130,11 +131,17 @@ void cgmath::set_image(FITSView *image)
 {
     pimage = image;
 
-    if (pimage)
+    set_image_data(pimage ? pimage->getImageData() : NULL);
+}
+
+void cgmath::set_image_data(FITSImage *image_data)
+{
+    pimage_data = image_data;
+
+    if (pimage_data)
     {
-        FITSImage *image_data = pimage->getImageData();
-        set_buffer(image_data->getImageBuffer());
-        set_video_params(image_data->getWidth(), image_data->getHeight());
+        set_buffer(pimage_data->getImageBuffer());
+        set_video_params(pimage_data->getWidth(), pimage_data->getHeight());
     }
 }
 
@@ -250,6 +257,13 @@ int  cgmath::get_square_algorithm_index( void ) const
 }
 
 
+void cgmath::get_square_pos( double *x, double *y ) const
+{
+	*x = square_pos.x;
+	*y = square_pos.y;
+}
+
+
 
 cproc_in_params * cgmath::get_in_params( void )
 {
@@ -661,11 +675,12 @@ Vector cgmath::find_star_local_pos( void ) const
         int x2=square_pos.x + square_size;
         int y1=square_pos.y;
         int y2=square_pos.y + square_size;
-        FITSImage *image_data = pimage->getImageData();
+        if (pimage_data == NULL)
+            return (ret = Vector(center_x , center_y, 0));
 
         //qDebug() << "Search Region: X1: " << x1 << ", X2: " << x2 << " , Y1: " << y1 << " , Y2: " << y2 << endl;
 
-        foreach(Edge *center, image_data->getStarCenters())
+        foreach(Edge *center, pimage_data->getStarCenters())
         {
 
             //qDebug() << "Star X: " << center->x << ", Y: " << center->y << endl;
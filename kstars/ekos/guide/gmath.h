@@ -21,6 +21,7 @@
 #include "common.h"
 
 class FITSView;
+class FITSImage;
 
 typedef struct
 {
@@ -133,6 +134,7 @@ public:
 	int  get_square_index( void ) const;
 	int  get_square_algorithm_index( void ) const;
     int  get_square_size() { return square_size; }
+    void get_square_pos( double *x, double *y ) const;
 	void set_square_algorithm( int alg_idx );
     Matrix get_ROTZ() { return ROT_Z; }
 	cproc_in_params *get_in_params( void );
@@ -145,6 +147,8 @@ public:
 	bool reset( void );
     void set_buffer(float *buffer);
     void set_image(FITSView *image);
+    // Image whose detected stars the centroid algorithm uses; set_image() sets it from the view
+    void set_image_data(FITSImage *image_data);
     bool get_dec_swap() { return dec_swap;}
     FITSView *get_image() { return pimage; }
     void set_preview_mode(bool enable) { preview_mode = enable;}
@@ -178,6 +182,7 @@ private:
 	uint32_t ticks;		// global channel ticker
     float *pdata;		// pointer to data buffer
     FITSView *pimage;   // pointer to image
+    FITSImage *pimage_data; // pointer to the image data, with the detected stars
 	int video_width, video_height;	// video frame dimensions
 	double ccd_pixel_width, ccd_pixel_height, aperture, focal;
 	Matrix	ROT_Z;
@@ -46,6 +46,8 @@ rguider::rguider(Ekos::Guide *parent)
     is_subframed = false;
 
     lost_star_try=0;       
+    latency_frames=0;
+    download_latency_sum = process_latency_sum = 0;
 
 	ui.comboBox_SquareSize->clear();
 	for( i = 0;guide_squares[i].size != -1;++i )
@@ -112,6 +114,7 @@ rguider::rguider(Ekos::Guide *parent)
     ui.kcfg_useDither->setChecked(Options::useDither());
     ui.kcfg_ditherPixels->setValue(Options::ditherPixels());
     ui.spinBox_AOLimit->setValue(Options::aOLimit());
+    ui.kcfg_pipelineGuide->setChecked(Options::pipelineGuide());
 
 }
 
@@ -389,6 +392,7 @@ void rguider::onStartStopButtonClick()
         Options::setUseDither(ui.kcfg_useDither->isChecked());
         Options::setDitherPixels(ui.kcfg_ditherPixels->value());
         Options::setAOLimit(ui.spinBox_AOLimit->value());
+        Options::setPipelineGuide(ui.kcfg_pipelineGuide->isChecked());
 
         if (pimage)
             disconnect(pimage, SIGNAL(guideStarSelected(int,int)), 0, 0);
@@ -398,6 +402,8 @@ void rguider::onStartStopButtonClick()
         pmain_wnd->appendLogText(i18n("Autoguiding started."));
 		pmath->start();
         lost_star_try=0;
+        latency_frames=0;
+        download_latency_sum = process_latency_sum = 0;
 		is_started = true;
         useRapidGuide = ui.kfcg_useRapidGuide->isChecked();
         if (useRapidGuide)
@@ -424,6 +430,11 @@ void rguider::onStartStopButtonClick()
         if (useRapidGuide)
             pmain_wnd->stopRapidGuide();
 
+        if (latency_frames > 0)
+            pmain_wnd->appendLogText(i18n("Average guide frame latency: download %1 ms, processing %2 ms.",
+                                          QString::number(download_latency_sum/latency_frames, 'f', 0),
+                                          QString::number(process_latency_sum/latency_frames, 'f', 0)));
+
         emit autoGuidingToggled(false, ui.kcfg_useDither->isChecked());
 
 		is_started = false;
@@ -542,6 +553,16 @@ void rguider::guide( void )
 
 }
 
+void rguider::set_frame_latency(int download_ms, int process_ms)
+{
+    latency_frames++;
+    download_latency_sum += download_ms;
+    process_latency_sum  += process_ms;
+
+    ui.l_DownloadLatency->setText(QString::number(download_ms));
+    ui.l_ProcessLatency->setText(QString::number(process_ms));
+}
+
 void rguider::set_image(FITSView *image)
 {
     pimage = image;
@@ -43,7 +43,9 @@ public:
     void set_target_chip(ISD::CCDChip *chip);
     bool isRapidGuide() { return useRapidGuide;}
     bool is_dithering() { return isDithering; }
+    bool is_pipelined() { return ui.kcfg_pipelineGuide->isChecked(); }
     double get_ao_limit();
+    void set_frame_latency(int download_ms, int process_ms);
 
 protected slots:
 	void onXscaleChanged( int i );
@@ -84,6 +86,10 @@ private:
     double ret_x, ret_y, ret_angle;
     bool isDithering;
 
+    // latency statistics
+    int latency_frames;
+    double download_latency_sum, process_latency_sum;
+
 private:
     Ui::guiderClass ui;
 };
@@ -0,0 +1,127 @@
+/***************************************************************************
+                  ephemerisfile.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2014-06-13
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "ephemerisfile.h"
+#include "ksutils.h"
+
+#include <kdebug.h>
+
+#include <cstring>
+
+namespace {
+    // Keep in sync with data/tools/ephemeris2bin.c
+    const char  Magic[8]  = "KSEPHEM";
+    const quint32 Version   = 1;
+    const quint32 ByteOrder = 0x01020304;
+    const int   NameLength  = 32;
+
+    struct FileHeader {
+        char magic[8];
+        quint32 version;
+        quint32 byteOrder;
+        quint32 tableCount;
+        quint32 reserved;
+    };
+
+    struct TableEntry {
+        char name[NameLength];
+        quint32 rows;
+        quint32 columns;
+        quint64 offset;
+    };
+}
+
+EphemerisFile *EphemerisFile::pinstance = 0;
+
+EphemerisFile* EphemerisFile::Instance()
+{
+    if ( ! pinstance )
+        pinstance = new EphemerisFile();
+    return pinstance;
+}
+
+EphemerisFile::EphemerisFile() : m_data( 0 )
+{
+    if ( ! open() ) {
+        m_data = 0;
+        m_tables.clear();
+        m_buffer.clear();
+        m_file.close();
+    }
+}
+
+bool EphemerisFile::open()
+{
+    if ( ! KSUtils::openDataFile( m_file, "ephemeris.dat" ) ) {
+        kDebug() << "No ephemeris.dat, reading the ephemeris text files";
+        return false;
+    }
+
+    qint64 size = m_file.size();
+    if ( size < qint64( sizeof( FileHeader ) ) )
+        return false;
+
+    const uchar *data = m_file.map( 0, size );
+    if ( ! data ) {
+        m_buffer = m_file.readAll();
+        if ( m_buffer.size() != size )
+            return false;
+        data = reinterpret_cast<const uchar*>( m_buffer.constData() );
+    }
+
+    FileHeader header;
+    memcpy( &header, data, sizeof( FileHeader ) );
+    if ( memcmp( header.magic, Magic, sizeof( Magic ) ) != 0 || header.version != Version ||
+         header.byteOrder != ByteOrder ) {
+        kWarning() << "ephemeris.dat has an unknown version or byte order";
+        return false;
+    }
+
+    quint64 dataStart = sizeof( FileHeader ) + quint64( header.tableCount ) * sizeof( TableEntry );
+    if ( dataStart > quint64( size ) )
+        return false;
+
+    const TableEntry *entries = reinterpret_cast<const TableEntry*>( data + sizeof( FileHeader ) );
+    for ( quint32 i = 0; i < header.tableCount; ++i ) {
+        const TableEntry &e = entries[i];
+        quint64 length = quint64( e.rows ) * e.columns * sizeof( double );
+        if ( e.offset < dataStart || e.offset % sizeof( double ) || e.offset + length > quint64( size ) ||
+             e.name[NameLength - 1] != '\0' ) {
+            kWarning() << "ephemeris.dat is damaged";
+            return false;
+        }
+
+        Table t;
+        t.data = reinterpret_cast<const double*>( data + e.offset );
+        t.rows = e.rows;
+        t.columns = e.columns;
+        m_tables.insert( QString::fromLatin1( e.name ), t );
+    }
+
+    m_data = data;
+    return true;
+}
+
+const double* EphemerisFile::table( const QString &name, int columns, int *rows ) const
+{
+    QHash<QString, Table>::const_iterator it = m_tables.constFind( name );
+    if ( it == m_tables.constEnd() || it->columns != columns )
+        return 0;
+    *rows = it->rows;
+    return it->data;
+}
@@ -0,0 +1,81 @@
+/***************************************************************************
+                   ephemerisfile.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2014-06-13
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef EPHEMERISFILE_H
+#define EPHEMERISFILE_H
+
+#include <QFile>
+#include <QHash>
+#include <QString>
+
+/**
+ * @class EphemerisFile
+ * @short Gives access to the compiled ephemeris data file
+ *
+ * The VSOP87 terms of the planets, the ELP terms of the Moon and the orbit
+ * curves are compiled at build time into ephemeris.dat by
+ * data/tools/ephemeris2bin. Every text data file is one table of doubles in
+ * it, named like the text file. See data/README.ephemerisfileformat.
+ *
+ * The file is memory mapped once and stays mapped, so a table is a pointer
+ * into the map. If the file is missing, of another version or byte order,
+ * or damaged, isValid() is false and every lookup fails, so the callers
+ * fall back to parsing the text files.
+ */
+class EphemerisFile
+{
+public:
+    /** @return the ephemeris file, opened on first use */
+    static EphemerisFile* Instance();
+
+    /** @return true if the file was found and its header is sane */
+    inline bool isValid() const { return m_data != 0; }
+
+    /**
+     * @short Looks up a table
+     * @param name name of the text file the table was made from, e.g. "mars.L0.vsop"
+     * @param columns the number of columns expected
+     * @param rows set to the number of rows of the table
+     * @return the table as rows * columns doubles, or 0 if there is no such
+     * table with that many columns
+     */
+    const double* table( const QString &name, int columns, int *rows ) const;
+
+private:
+    EphemerisFile();
+    EphemerisFile( const EphemerisFile& );
+    EphemerisFile& operator=( const EphemerisFile& );
+
+    /** @short Maps the file and reads the table directory */
+    bool open();
+
+    struct Table {
+        const double *data;
+        int rows;
+        int columns;
+    };
+
+    static EphemerisFile *pinstance;
+
+    QFile m_file;
+    QByteArray m_buffer;        ///< file contents if it cannot be mapped
+    const uchar *m_data;
+    QHash<QString, Table> m_tables;
+};
+
+#endif
@@ -21,6 +21,6 @@ typedef enum { FITS_NORMAL, FITS_FOCUS, FITS_GUIDE, FITS_CALIBRATE, FITS_WCSM }
 typedef enum { FITS_POSITION, FITS_VALUE, FITS_RESOLUTION, FITS_ZOOM, FITS_WCS, FITS_MESSAGE } FITSBar;
 typedef enum { FITS_NONE, FITS_AUTO_STRETCH, FITS_HIGH_CONTRAST, FITS_EQUALIZE, FITS_HIGH_PASS, FITS_AUTO , FITS_LINEAR, FITS_LOG, FITS_SQRT, FITS_CUSTOM } FITSScale;
 typedef enum { ZOOM_FIT_WINDOW, ZOOM_KEEP_LEVEL, ZOOM_FULL } FITSZoom;
-typedef enum { HFR_AVERAGE, HFR_MAX } HFRType;
+typedef enum { HFR_AVERAGE, HFR_MAX, HFR_MEDIAN } HFRType;
 
 #endif // FITSCOMMON_H
@@ -27,6 +27,7 @@
 #include <QApplication>
 #include <QFile>
 #include <QProgressDialog>
+#include <QVector>
 #include <KMessageBox>
 
 #ifdef HAVE_WCSLIB
@@ -65,6 +66,7 @@ FITSImage::FITSImage(FITSMode fitsMode)
     image_buffer = NULL;
     wcs_coord    = NULL;
     fptr = NULL;
+    histogram = NULL;
     maxHFRStar = NULL;
     tempFile  = false;
     starsSearched = false;
@@ -101,6 +103,7 @@ bool FITSImage::loadFITS ( const QString &inFilename, QProgressDialog *progress
 
     qDeleteAll(starCenters);
     starCenters.clear();
+    maxHFRStar = NULL;
 
     if (mode == FITS_NORMAL && progress)
     {
@@ -498,7 +501,7 @@ bool FITSImage::checkCollision(Edge* s1, Edge*s2)
 
 
 /*** Find center of stars and calculate Half Flux Radius */
-void FITSImage::findCentroid(int initStdDev, int minEdgeWidth)
+void FITSImage::findCentroid(const QRect &boundary, int initStdDev, int minEdgeWidth)
 {
     double threshold=0;
     double avg = 0;
@@ -508,11 +511,25 @@ void FITSImage::findCentroid(int initStdDev, int minEdgeWidth)
     int pixVal=0;
     int badPix=0;
 
-    double JMIndex = histogram->getJMIndex();
+    double JMIndex = histogram ? histogram->getJMIndex() : 0;
     int badPixLimit=0;
 
     QList<Edge*> edges;
 
+    // Limit the search to the requested region, if any.
+    int x1=0, y1=0, x2=stats.dim[0], y2=stats.dim[1];
+    if (boundary.isValid())
+    {
+        QRect region = boundary.intersected(QRect(0, 0, stats.dim[0], stats.dim[1]));
+        if (region.isEmpty())
+            return;
+
+        x1 = region.left();
+        y1 = region.top();
+        x2 = region.right() + 1;
+        y2 = region.bottom() + 1;
+    }
+
     while (initStdDev >= 1)
     {
        if (JMIndex > DIFFUSE_THRESHOLD)
@@ -539,11 +556,11 @@ void FITSImage::findCentroid(int initStdDev, int minEdgeWidth)
        #endif
 
     // Detect "edges" that are above threshold
-    for (int i=0; i < stats.dim[1]; i++)
+    for (int i=y1; i < y2; i++)
     {
         pixelRadius = 0;
 
-        for(int j=0; j < stats.dim[0]; j++)
+        for(int j=x1; j < x2; j++)
         {
             pixVal = image_buffer[j+(i*stats.dim[0])] - min;
 
@@ -805,26 +822,44 @@ double FITSImage::getHFR(HFRType type)
     // It is more consistent.
     // TODO: Try to test this under using a real CCD.
 
+    maxHFRStar = NULL;
+
     if (starCenters.size() == 0)
         return -1;
 
-    if (type == HFR_MAX)
+    // The brightest star is kept for every type, since focus selects it after measuring the median
+    int maxVal=0;
+    int maxIndex=0;
+    for (int i=0; i < starCenters.count() ; i++)
     {
-         maxHFRStar = NULL;
-         int maxVal=0;
-         int maxIndex=0;
-     for (int i=0; i < starCenters.count() ; i++)
+        if (starCenters[i]->val > maxVal)
         {
-            if (starCenters[i]->val > maxVal)
-            {
-                maxIndex=i;
-                maxVal = starCenters[i]->val;
-
-            }
+            maxIndex=i;
+            maxVal = starCenters[i]->val;
         }
+    }
+
+    maxHFRStar = starCenters[maxIndex];
 
-        maxHFRStar = starCenters[maxIndex];
+    if (type == HFR_MAX)
         return starCenters[maxIndex]->HFR;
+
+    // Median HFR of all detected stars, robust against outliers such as hot pixels or blended stars
+    if (type == HFR_MEDIAN)
+    {
+        QVector<double> HFRs;
+        HFRs.reserve(starCenters.count());
+
+        foreach(Edge *center, starCenters)
+            HFRs.append(center->HFR);
+
+        qSort(HFRs);
+
+        int mid = HFRs.count() / 2;
+        if (HFRs.count() % 2)
+            return HFRs[mid];
+        else
+            return (HFRs[mid-1] + HFRs[mid]) / 2.0;
     }
 
     double FSum=0;
@@ -1003,17 +1038,36 @@ void FITSImage::subtract(float *dark_buffer)
     calculateStats(true);
 }
 
-int FITSImage::findStars()
+int FITSImage::findStars(const QRect &boundary)
 {
-    if (histogram == NULL)
-        return -1;
+    // Without a histogram, e.g. when no view shows the image, the image is taken for a star field
+    double JMIndex = histogram ? histogram->getJMIndex() : 0;
+
+    // Region searches are always performed, and leave the full image marked as not searched
+    if (boundary.isValid())
+    {
+        qDeleteAll(starCenters);
+        starCenters.clear();
+        maxHFRStar = NULL;
+
+        if (JMIndex < JM_UPPER_LIMIT)
+        {
+             findCentroid(boundary);
+             getHFR();
+        }
+
+        starsSearched = false;
+
+        return starCenters.count();
+    }
 
     if (starsSearched == false)
     {
         qDeleteAll(starCenters);
         starCenters.clear();
+        maxHFRStar = NULL;
 
-        if (histogram->getJMIndex() < JM_UPPER_LIMIT)
+        if (JMIndex < JM_UPPER_LIMIT)
         {
              findCentroid();
              getHFR();
@@ -28,6 +28,7 @@
 #include <QPaintEvent>
 #include <QScrollArea>
 #include <QLabel>
+#include <QRect>
 
 #include <kxmlguiwindow.h>
 #include <kurl.h>
@@ -116,9 +117,11 @@ public:
 
 
     // Star Detection & HFR
-    int findStars();
+    /* Find stars in the whole image, or only within boundary if it is valid.
+       Without a histogram the image is searched as a star field. */
+    int findStars(const QRect &boundary = QRect());
     double getHFR(HFRType type=HFR_AVERAGE);
-    void findCentroid(int initStdDev=MINIMUM_STDVAR, int minEdgeWidth=MINIMUM_PIXEL_RANGE);
+    void findCentroid(const QRect &boundary = QRect(), int initStdDev=MINIMUM_STDVAR, int minEdgeWidth=MINIMUM_PIXEL_RANGE);
     void getCenterSelection(int *x, int *y);
 
     // WCS
@@ -145,6 +145,7 @@ FITSView::FITSView(QWidget * parent, FITSMode fitsMode) : QScrollArea(parent) ,
 
     currentZoom = 0.0;
     markStars = false;
+    imageBusy = framePending = false;
 
     connect(image_frame, SIGNAL(newStatus(QString,FITSBar)), this, SIGNAL(newStatus(QString,FITSBar)));
 
@@ -367,6 +368,12 @@ void FITSView::updateFrame()
     if (display_image == NULL)
         return;
 
+    if (imageBusy)
+    {
+        framePending = true;
+        return;
+    }
+
     if (currentZoom != ZOOM_DEFAULT)
             ok = displayPixmap.convertFromImage(display_image->scaled( (int) currentWidth, (int) currentHeight, Qt::KeepAspectRatio, Qt::SmoothTransformation));
         else
@@ -478,10 +485,25 @@ void FITSView::setGuideBoxSize(int size)
     }
 }
 
+void FITSView::setImageBusy(bool busy)
+{
+    imageBusy = busy;
+
+    if (imageBusy == false && framePending)
+    {
+        framePending = false;
+        updateFrame();
+    }
+}
+
 void FITSView::toggleStars(bool enable)
 {
      markStars = enable;
 
+     // The stars are being detected on another thread
+     if (imageBusy)
+         return;
+
      if (markStars == true)
      {
        int count = image_data->findStars();
@@ -492,6 +514,9 @@ void FITSView::toggleStars(bool enable)
 
 void FITSView::processPointSelection(int x, int y)
 {
+    if (imageBusy)
+        return;
+
     image_data->getCenterSelection(&x, &y);
 
     setGuideSquare(x,y);
@@ -112,6 +112,11 @@ public:
     // Star Detection
     void toggleStars(bool enable);
 
+    /* While the image data is processed on another thread, the view neither redraws its overlay nor
+       reads the detected stars. The frame is brought up to date when the processing ends. */
+    void setImageBusy(bool busy);
+    bool isImageBusy() { return imageBusy; }
+
     void updateMode(FITSMode mode);
 
 
@@ -128,6 +133,7 @@ private:
     double stddev();
 
     bool markStars;
+    bool imageBusy, framePending;
     FITSLabel *image_frame;
     FITSImage *image_data;
     int image_width, image_height;
@@ -0,0 +1,363 @@
+/***************************************************************************
+                  frameprofiler.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2014-06-11
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "frameprofiler.h"
+#include "Options.h"
+
+#include <kdebug.h>
+
+#include <QFile>
+#include <QTextStream>
+#include <QHash>
+#include <QPainter>
+#include <QFontMetrics>
+
+#include <algorithm>
+
+namespace {
+    // Enough for a few hundred frames of the usual forty-odd sections
+    const int SectionHistory = 16384;
+    const int FrameHistory   = 256;
+
+    // Frames shown in the overlay
+    const int OverlayFrames  = 120;
+    const int OverlaySections = 8;
+
+    const char *counterNames[] = { "Star JIT updates", "Line JIT updates",
+                                   "Labels drawn", "Labels rejected",
+                                   "Labels kept", "Label widths measured" };
+
+    inline double toMs( qint64 nsecs ) { return nsecs / 1.0e6; }
+    inline double toUs( qint64 nsecs ) { return nsecs / 1.0e3; }
+
+    struct SlowerThan {
+        template<typename T> bool operator()( const T &a, const T &b ) const { return a.sum > b.sum; }
+    };
+}
+
+FrameProfiler *FrameProfiler::pinstance = 0;
+bool FrameProfiler::s_enabled = false;
+QElapsedTimer FrameProfiler::s_clock;
+int FrameProfiler::s_counts[FrameProfiler::NumCounters];
+
+FrameProfiler* FrameProfiler::Instance()
+{
+    if ( ! pinstance )
+        pinstance = new FrameProfiler();
+    return pinstance;
+}
+
+FrameProfiler::FrameProfiler() :
+    m_sections( SectionHistory ),
+    m_frames( FrameHistory )
+{
+    s_clock.start();
+    clear();
+}
+
+void FrameProfiler::clear()
+{
+    m_nextSection = 0;
+    m_sectionCount = 0;
+    m_frame = 0;
+    m_frameStart = 0;
+    m_inFrame = false;
+    for ( int i = 0; i < NumCounters; i++ )
+        s_counts[i] = 0;
+}
+
+void FrameProfiler::beginFrame()
+{
+    bool profile = Options::profileDrawing();
+    if ( profile && ! s_enabled )
+        clear();
+    s_enabled = profile;
+    if ( ! s_enabled )
+        return;
+
+    m_frameStart = s_clock.nsecsElapsed();
+    m_inFrame = true;
+}
+
+void FrameProfiler::endFrame()
+{
+    if ( ! s_enabled || ! m_inFrame )
+        return;
+
+    qint64 now = s_clock.nsecsElapsed();
+    Frame &frame = m_frames[ m_frame % FrameHistory ];
+    frame.start = m_frameStart;
+    frame.length = now - m_frameStart;
+
+    for ( int i = 0; i < NumCounters; i++ ) {
+        frame.counts[i] = s_counts[i];
+        if ( s_counts[i] ) {
+            Section &s = m_sections[ m_nextSection ];
+            s.name = 0;
+            s.start = now;
+            s.length = s_counts[i];
+            s.counter = i;
+            s.frame = m_frame;
+            m_nextSection = ( m_nextSection + 1 ) % SectionHistory;
+            m_sectionCount = qMin( m_sectionCount + 1, SectionHistory );
+        }
+        s_counts[i] = 0;
+    }
+
+    m_inFrame = false;
+    m_frame++;
+}
+
+void FrameProfiler::addTime( const char *name, qint64 nsecs )
+{
+    if ( ! s_enabled )
+        return;
+    qint64 now = s_clock.nsecsElapsed();
+    addSection( name, now - nsecs, nsecs );
+}
+
+void FrameProfiler::addSection( const char *name, qint64 start, qint64 length )
+{
+    // Sections outside of a frame (e.g. updates driven by the clock) are
+    // counted with the next frame
+    Section &s = m_sections[ m_nextSection ];
+    s.name = name;
+    s.start = start;
+    s.length = length;
+    s.counter = -1;
+    s.frame = m_frame;
+    m_nextSection = ( m_nextSection + 1 ) % SectionHistory;
+    m_sectionCount = qMin( m_sectionCount + 1, SectionHistory );
+}
+
+int FrameProfiler::firstFrame() const
+{
+    int first = qMax( 0, m_frame - FrameHistory );
+    if ( m_sectionCount == SectionHistory ) {
+        // The oldest frame in the ring may have lost some of its sections
+        const Section &oldest = m_sections[ m_nextSection ];
+        first = qMax( first, oldest.frame + 1 );
+    }
+    return qMin( first, m_frame );
+}
+
+QVector<FrameProfiler::Total> FrameProfiler::totals( int frames, int *frameCount ) const
+{
+    int first = qMax( firstFrame(), m_frame - frames );
+    *frameCount = m_frame - first;
+
+    QVector<Total> result;
+    QHash<const char*, int> index;
+    QVector<int> lastFrame;
+
+    int start = ( m_nextSection - m_sectionCount + SectionHistory ) % SectionHistory;
+    for ( int i = 0; i < m_sectionCount; i++ ) {
+        const Section &s = m_sections[ ( start + i ) % SectionHistory ];
+        if ( ! s.name || s.frame < first || s.frame >= m_frame )
+            continue;
+
+        QHash<const char*, int>::const_iterator it = index.constFind( s.name );
+        int k;
+        if ( it == index.constEnd() ) {
+            Total t;
+            t.name = s.name;
+            t.frames = t.runs = 0;
+            t.sum = t.max = 0;
+            k = result.size();
+            index.insert( s.name, k );
+            result.append( t );
+            lastFrame.append( -1 );
+        } else {
+            k = it.value();
+        }
+
+        Total &t = result[k];
+        t.runs++;
+        t.sum += s.length;
+        t.max = qMax( t.max, s.length );
+        if ( lastFrame[k] != s.frame ) {
+            lastFrame[k] = s.frame;
+            t.frames++;
+        }
+    }
+
+    std::sort( result.begin(), result.end(), SlowerThan() );
+    return result;
+}
+
+QString FrameProfiler::statistics() const
+{
+    int frameCount;
+    QVector<Total> sections = totals( FrameHistory, &frameCount );
+    if ( frameCount == 0 )
+        return QString();
+
+    QString result;
+    QTextStream out( &result );
+    out.setRealNumberNotation( QTextStream::FixedNotation );
+    out.setRealNumberPrecision( 3 );
+
+    out << "section\tframes\tmean ms\tmax ms\n";
+    foreach ( const Total &t, sections )
+        out << t.name << '\t' << t.frames << '\t' << toMs( t.sum ) / frameCount << '\t' << toMs( t.max ) << '\n';
+
+    qint64 sum = 0, max = 0;
+    double counts[NumCounters] = {};
+    for ( int f = m_frame - frameCount; f < m_frame; f++ ) {
+        const Frame &frame = m_frames[ f % FrameHistory ];
+        sum += frame.length;
+        max = qMax( max, frame.length );
+        for ( int i = 0; i < NumCounters; i++ )
+            counts[i] += frame.counts[i];
+    }
+    out << "Frame\t" << frameCount << '\t' << toMs( sum ) / frameCount << '\t' << toMs( max ) << '\n';
+    for ( int i = 0; i < NumCounters; i++ )
+        out << counterNames[i] << '\t' << frameCount << '\t' << counts[i] / frameCount << '\n';
+
+    out.flush();
+    return result;
+}
+
+bool FrameProfiler::dump( const QString &fileName ) const
+{
+    QFile file( fileName );
+    if ( ! file.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text ) ) {
+        kWarning() << "Could not write frame profile to" << fileName;
+        return false;
+    }
+
+    QTextStream out( &file );
+    out.setRealNumberNotation( QTextStream::FixedNotation );
+    out.setRealNumberPrecision( 3 );
+
+    bool trace = fileName.endsWith( ".json", Qt::CaseInsensitive );
+    int first = firstFrame();
+    bool separator = false;
+
+    if ( trace )
+        out << "{\"traceEvents\":[\n";
+    else
+        out << "frame,section,start us,duration us,count\n";
+
+    for ( int f = first; f < m_frame; f++ ) {
+        const Frame &frame = m_frames[ f % FrameHistory ];
+        if ( trace ) {
+            out << ( separator ? ",\n" : "" )
+                << "{\"name\":\"Frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << toUs( frame.start )
+                << ",\"dur\":" << toUs( frame.length ) << ",\"args\":{\"frame\":" << f << "}}";
+            separator = true;
+        } else {
+            out << f << ",Frame," << toUs( frame.start ) << ',' << toUs( frame.length ) << ",\n";
+        }
+    }
+
+    int start = ( m_nextSection - m_sectionCount + SectionHistory ) % SectionHistory;
+    for ( int i = 0; i < m_sectionCount; i++ ) {
+        const Section &s = m_sections[ ( start + i ) % SectionHistory ];
+        if ( s.frame < first )
+            continue;
+        const char *name = s.name ? s.name : counterNames[ s.counter ];
+        if ( trace ) {
+            out << ( separator ? ",\n" : "" ) << "{\"name\":\"" << name << "\",\"pid\":1,\"tid\":1,\"ts\":" << toUs( s.start );
+            if ( s.name )
+                out << ",\"ph\":\"X\",\"dur\":" << toUs( s.length ) << '}';
+            else
+                out << ",\"ph\":\"C\",\"args\":{\"count\":" << s.length << "}}";
+            separator = true;
+        } else {
+            out << s.frame << ',' << name << ',' << toUs( s.start ) << ',';
+            if ( s.name )
+                out << toUs( s.length ) << ",\n";
+            else
+                out << ',' << s.length << '\n';
+        }
+    }
+
+    if ( trace )
+        out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    out.flush();
+    return file.error() == QFile::NoError;
+}
+
+void FrameProfiler::drawOverlay( QPainter &p, const QRect &area ) const
+{
+    if ( ! s_enabled )
+        return;
+
+    int frameCount;
+    QVector<Total> sections = totals( OverlayFrames, &frameCount );
+    if ( frameCount == 0 )
+        return;
+
+    QFontMetrics fm( p.font() );
+    int lineHeight = fm.height();
+    int lines = qMin( sections.size(), OverlaySections ) + 1 + NumCounters;
+    int histHeight = 60;
+    int width = 2 * OverlayFrames + 10;
+    int height = histHeight + lines * lineHeight + 15;
+    QRect box( area.left() + 10, area.bottom() - height - 10, width, height );
+
+    p.save();
+    p.setPen( Qt::NoPen );
+    p.setBrush( QColor( 0, 0, 0, 180 ) );
+    p.drawRect( box );
+
+    // Frame time histogram, the full height is 50 ms
+    const double fullScale = 50.0;
+    int base = box.top() + 5 + histHeight;
+    double sum = 0.0;
+    double counts[NumCounters] = {};
+    for ( int f = m_frame - frameCount, x = box.left() + 5; f < m_frame; f++, x += 2 ) {
+        const Frame &frame = m_frames[ f % FrameHistory ];
+        double ms = toMs( frame.length );
+        sum += ms;
+        for ( int i = 0; i < NumCounters; i++ )
+            counts[i] += frame.counts[i];
+
+        QColor color = ms < 1000.0 / 60.0 ? Qt::green : ms < 1000.0 / 30.0 ? Qt::yellow : Qt::red;
+        int h = qMin( histHeight, int( ms / fullScale * histHeight + 0.5 ) );
+        p.fillRect( x, base - h, 2, h, color );
+    }
+
+    // Lines at 60 and 30 frames per second
+    p.setPen( QColor( 255, 255, 255, 120 ) );
+    for ( int fps = 60; fps >= 30; fps -= 30 ) {
+        int y = base - int( 1000.0 / fps / fullScale * histHeight + 0.5 );
+        p.drawLine( box.left() + 5, y, box.right() - 5, y );
+    }
+
+    p.setPen( Qt::white );
+    int y = base + 5 + fm.ascent();
+    int x = box.left() + 5;
+    int valueX = box.right() - 5 - fm.width( "000.00 ms" );
+    p.drawText( x, y, QString( "Frame (%1)" ).arg( frameCount ) );
+    p.drawText( valueX, y, QString( "%1 ms" ).arg( sum / frameCount, 0, 'f', 2 ) );
+    for ( int i = 0; i < sections.size() && i < OverlaySections; i++ ) {
+        y += lineHeight;
+        p.drawText( x, y, QString( sections[i].name ) );
+        p.drawText( valueX, y, QString( "%1 ms" ).arg( toMs( sections[i].sum ) / frameCount, 0, 'f', 2 ) );
+    }
+    for ( int i = 0; i < NumCounters; i++ ) {
+        y += lineHeight;
+        p.drawText( x, y, QString( counterNames[i] ) );
+        p.drawText( valueX, y, QString::number( qRound( counts[i] / frameCount ) ) );
+    }
+
+    p.restore();
+}
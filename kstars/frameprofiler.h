@@ -0,0 +1,182 @@
+/***************************************************************************
+                   frameprofiler.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2014-06-11
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+
+class QPainter;
+class QRect;
+
+/**
+ * @class FrameProfiler
+ * @short Collects the time spent in the parts of a sky map frame
+ *
+ * Sections of code are timed with a FrameProfiler::Scope on the stack:
+ *
+ *   FrameProfiler::Scope scope( "Deep sky" );
+ *
+ * The section name must be a string literal (or otherwise outlive the
+ * profiler), since only the pointer is kept. When profiling is off a Scope
+ * costs a test of a static flag. Calls made too often to be timed one by
+ * one, like the JIT updates of single objects, are counted instead.
+ *
+ * The sections are kept in a fixed ring buffer together with the start and
+ * length of the last frames, so profiling never allocates once it runs and
+ * a long session only keeps the recent history. From that history the
+ * profiler computes a summary per section, draws an overlay on the sky map
+ * and writes CSV or Chrome trace files (load the latter in chrome://tracing).
+ *
+ * Profiling is switched on and off by the ProfileDrawing option, which is
+ * read at the start of every frame.
+ */
+class FrameProfiler
+{
+public:
+    /** @short Counted (not timed) events */
+    enum Counter {
+        StarJITUpdates = 0,
+        LineJITUpdates,
+        LabelsDrawn,
+        LabelsRejected,
+        LabelsKept,             ///< labels kept in place from the last frame
+        LabelWidthsMeasured,    ///< label widths not found in the cache
+        NumCounters
+    };
+
+    /** @short Times the enclosing block as one section */
+    class Scope
+    {
+    public:
+        explicit Scope( const char *name ) : m_name( name ), m_start( -1 ) {
+            if ( s_enabled )
+                m_start = s_clock.nsecsElapsed();
+        }
+        ~Scope() {
+            if ( m_start >= 0 )
+                Instance()->addSection( m_name, m_start, s_clock.nsecsElapsed() - m_start );
+        }
+    private:
+        Scope( const Scope& );
+        Scope& operator=( const Scope& );
+
+        const char *m_name;
+        qint64 m_start;
+    };
+
+    /** @return the profiler */
+    static FrameProfiler* Instance();
+
+    /** @return true if sections are being recorded */
+    static inline bool enabled() { return s_enabled; }
+
+    /** @short Counts n events of kind c in the current frame */
+    static inline void count( Counter c, int n = 1 ) {
+        if ( s_enabled )
+            s_counts[c] += n;
+    }
+
+    /**
+     * @short Starts a frame. Turns profiling on or off following the
+     * ProfileDrawing option; turning it on clears the history.
+     */
+    void beginFrame();
+
+    /** @short Ends the frame started by beginFrame() */
+    void endFrame();
+
+    /**
+     * @short Records a section measured elsewhere, e.g. time summed over
+     * many small pieces of work. It ends now.
+     */
+    void addTime( const char *name, qint64 nsecs );
+
+    /** @short Forgets all recorded frames and sections */
+    void clear();
+
+    /**
+     * @return one line per section with the number of frames it was seen
+     * in, the mean time per frame and the longest single run in ms, followed
+     * by the frame times and counters, as tab separated text
+     */
+    QString statistics() const;
+
+    /**
+     * @short Writes the recorded sections to fileName. A file ending in
+     * ".json" is written in the Chrome trace event format, anything else as
+     * CSV with one line per section or counter.
+     * @return false if the file could not be written
+     */
+    bool dump( const QString &fileName ) const;
+
+    /** @short Draws a frame time histogram and the slowest sections into area */
+    void drawOverlay( QPainter &p, const QRect &area ) const;
+
+private:
+    FrameProfiler();
+
+    struct Section {
+        const char *name;   ///< 0 for a counter
+        qint64 start;       ///< nsecs since the profiler started
+        qint64 length;      ///< nsecs, or the count for a counter
+        int counter;
+        int frame;
+    };
+
+    struct Frame {
+        qint64 start;
+        qint64 length;
+        int counts[NumCounters];
+    };
+
+    /** @short Per section totals over the recorded frames */
+    struct Total {
+        const char *name;
+        int frames;
+        int runs;
+        qint64 sum;
+        qint64 max;
+    };
+
+    void addSection( const char *name, qint64 start, qint64 length );
+
+    /** @short Sums the sections of the last (at most) frames frames, slowest first */
+    QVector<Total> totals( int frames, int *frameCount ) const;
+
+    /** @return the oldest frame still covered by the section ring */
+    int firstFrame() const;
+
+    static FrameProfiler *pinstance;
+    static bool s_enabled;
+    static QElapsedTimer s_clock;
+    static int s_counts[NumCounters];
+
+    QVector<Section> m_sections;    ///< ring buffer
+    int m_nextSection;
+    int m_sectionCount;
+
+    QVector<Frame> m_frames;        ///< ring buffer, indexed by frame number
+    int m_frame;                    ///< number of the current frame
+    qint64 m_frameStart;
+    bool m_inFrame;
+};
+
+#endif
@@ -70,17 +70,13 @@ Trixel HTMesh::index(double ra, double dec) const
     return (Trixel) htm->idByPoint( SpatialVector(ra, dec) ) - magicNum;
 }
 
-bool HTMesh::performIntersection(RangeConvex* convex, BufNum bufNum) {
-
-    if ( ! validBufNum(bufNum) )
-        return false;
-
+bool HTMesh::performIntersection(RangeConvex* convex, MeshBuffer* buffer) const
+{
     convex->setOlevel(m_level);
     HtmRange range;
     convex->intersect(htm, &range);
     HtmRangeIterator iterator(&range);
 
-    MeshBuffer* buffer = m_meshBuffer[bufNum];
     buffer->reset();
     while (iterator.hasNext() ) {
         buffer->append( (Trixel) iterator.next() - magicNum);
@@ -95,59 +91,94 @@ bool HTMesh::performIntersection(RangeConvex* convex, BufNum bufNum) {
 }
 
 
-// CIRCLE
+// The numbered buffer versions just hand their buffer to the reentrant ones
+
 void HTMesh::intersect(double ra, double dec, double radius, BufNum bufNum)
+{
+    if ( validBufNum(bufNum) )
+        intersect(m_meshBuffer[bufNum], ra, dec, radius);
+}
+
+void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
+                       BufNum bufNum)
+{
+    if ( validBufNum(bufNum) )
+        intersect(m_meshBuffer[bufNum], ra1, dec1, ra2, dec2);
+}
+
+void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
+                       double ra3, double dec3, BufNum bufNum)
+{
+    if ( validBufNum(bufNum) )
+        intersect(m_meshBuffer[bufNum], ra1, dec1, ra2, dec2, ra3, dec3);
+}
+
+void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
+                       double ra3, double dec3, double ra4, double dec4,
+                       BufNum bufNum)
+{
+    if ( validBufNum(bufNum) )
+        intersect(m_meshBuffer[bufNum], ra1, dec1, ra2, dec2, ra3, dec3, ra4, dec4);
+}
+
+
+// CIRCLE
+bool HTMesh::intersect(MeshBuffer* result, double ra, double dec, double radius) const
 {
     double d = cos(radius * degree2Rad);
     SpatialConstraint c(SpatialVector(ra, dec), d);
     RangeConvex convex;
     convex.add(c);                      // [ed:RangeConvex::add]
 
-    if ( ! performIntersection(&convex, bufNum) )
-        printf("In intersect(%f, %f, %f)\n", ra, dec, radius);
+    if ( performIntersection(&convex, result) )
+        return true;
+    printf("In intersect(%f, %f, %f)\n", ra, dec, radius);
+    return false;
 }
 
 
 // TRIANGLE
-void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
-                       double ra3, double dec3, BufNum bufNum)
+bool HTMesh::intersect(MeshBuffer* result, double ra1, double dec1,
+                       double ra2, double dec2, double ra3, double dec3) const
 {
     if ( fabs(ra1 - ra3) + fabs( dec1 - dec3) < eps )
-        return intersect( ra1, dec1, ra2, dec2 );
+        return intersect( result, ra1, dec1, ra2, dec2 );
 
     else if ( fabs(ra1 - ra2) + fabs(dec1 - dec2) < eps )
-        return intersect( ra1, dec1, ra3, dec3 );
+        return intersect( result, ra1, dec1, ra3, dec3 );
 
     else if ( fabs(ra2 - ra3) + fabs(dec2 - dec3) < eps )
-        return intersect( ra1, dec1, ra2, dec2 );
+        return intersect( result, ra1, dec1, ra2, dec2 );
 
     SpatialVector p1(ra1, dec1);
     SpatialVector p2(ra2, dec2);
     SpatialVector p3(ra3, dec3);
     RangeConvex convex(&p1, &p2, &p3);
 
-    if ( ! performIntersection(&convex, bufNum) )
-        printf("In intersect(%f, %f, %f, %f, %f, %f)\n",
-                ra1, dec1, ra2, dec2, ra3, dec3);
+    if ( performIntersection(&convex, result) )
+        return true;
+    printf("In intersect(%f, %f, %f, %f, %f, %f)\n",
+           ra1, dec1, ra2, dec2, ra3, dec3);
+    return false;
 }
 
 
 // QUADRILATERAL
-void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
-                       double ra3, double dec3, double ra4, double dec4,
-                       BufNum bufNum)
+bool HTMesh::intersect(MeshBuffer* result, double ra1, double dec1,
+                       double ra2, double dec2, double ra3, double dec3,
+                       double ra4, double dec4) const
 {
     if ( fabs(ra1 - ra4) + fabs(dec1 - dec4) < eps )
-        return intersect( ra2, dec2, ra3, dec3, ra4, dec4 );
+        return intersect( result, ra2, dec2, ra3, dec3, ra4, dec4 );
 
     else if ( fabs(ra1 - ra2) + fabs(dec1 - dec2) < eps )
-        return intersect( ra2, dec2, ra3, dec3, ra4, dec4 );
+        return intersect( result, ra2, dec2, ra3, dec3, ra4, dec4 );
 
     else if ( fabs(ra2 - ra3) + fabs(dec2 - dec3) < eps )
-        return intersect( ra1, dec1, ra2, dec2, ra4, dec4 );
+        return intersect( result, ra1, dec1, ra2, dec2, ra4, dec4 );
 
     else if ( fabs(ra3 - ra4) + fabs(dec3 - dec4) < eps )
-        return intersect( ra1, dec1, ra2, dec2, ra4, dec4 );
+        return intersect( result, ra1, dec1, ra2, dec2, ra4, dec4 );
 
 
     SpatialVector p1(ra1, dec1);
@@ -156,13 +187,15 @@ void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
     SpatialVector p4(ra4, dec4);
     RangeConvex convex( &p1, &p2, &p3, &p4);
 
-    if ( ! performIntersection(&convex, bufNum) )
-        printf("In intersect(%f, %f, %f, %f, %f, %f, %f, %f)\n",
-               ra1, dec1, ra2, dec2, ra3, dec3, ra4, dec4);
+    if ( performIntersection(&convex, result) )
+        return true;
+    printf("In intersect(%f, %f, %f, %f, %f, %f, %f, %f)\n",
+           ra1, dec1, ra2, dec2, ra3, dec3, ra4, dec4);
+    return false;
 }
 
 
-void HTMesh::toXYZ(double ra, double dec, double *x, double *y, double *z)
+void HTMesh::toXYZ(double ra, double dec, double *x, double *y, double *z) const
 {
     ra  *= degree2Rad;
     dec *= degree2Rad;
@@ -182,8 +215,8 @@ void HTMesh::toXYZ(double ra, double dec, double *x, double *y, double *z)
 // intersection.  Use cross product to ensure we have a perpendicular vector.
 
 // LINE
-void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
-                       BufNum bufNum)
+bool HTMesh::intersect(MeshBuffer* result, double ra1, double dec1,
+                       double ra2, double dec2) const
 {
     double x1, y1, z1, x2, y2, z2;
     
@@ -210,8 +243,9 @@ void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
         printf("len : %f (radians) %f (degrees)\n", len,  len  / degree2Rad);
     }
 
+    // A circle around the first point that reaches the second one
     if ( len < edge10 )
-        return intersect( ra1, len, bufNum);
+        return intersect( result, ra1, dec1, len / degree2Rad );
 
     // Cartesian cross product => perpendicular!.  Ugh.
     double cx = y1 * z2 - z1 * y2;
@@ -248,8 +282,10 @@ void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
     SpatialVector p2(ra2, dec2);
     RangeConvex convex(&p1, &p0, &p2);
 
-    if ( ! performIntersection(&convex, bufNum) )
-        printf("In intersect(%f, %f, %f, %f)\n", ra1, dec1, ra2, dec2);
+    if ( performIntersection(&convex, result) )
+        return true;
+    printf("In intersect(%f, %f, %f, %f)\n", ra1, dec1, ra2, dec2);
+    return false;
 }
 
 
@@ -270,7 +306,7 @@ int HTMesh::intersectSize(BufNum bufNum)
 
 void HTMesh::vertices(Trixel id, double *ra1, double *dec1,
                                  double *ra2, double *dec2,
-                                 double *ra3, double *dec3)
+                                 double *ra3, double *dec3) const
 {
     SpatialVector v1, v2, v3;
     htm->nodeVertex(id + magicNum, v1, v2, v3);
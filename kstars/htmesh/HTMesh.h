@@ -52,6 +52,13 @@ class MeshBuffer;
  * is just one buffer and all routines that use the buffers default to using the
  * just the first buffer.
  *
+ * The numbered buffers belong to the mesh, so only one result per buffer can
+ * exist at a time and only one thread can use them.  The intersect() routines
+ * that take a MeshBuffer* instead write into a buffer owned by the caller.
+ * They are const and only read the SpatialIndex, which never changes after
+ * construction, so any number of threads can use them on one HTMesh at the
+ * same time as long as each uses its own MeshBuffer.
+ *
  * NOTE: all Right Ascensions (ra) and Declinations (dec) are in degrees.
  */
 
@@ -115,6 +122,33 @@ public:
                        double ra3, double dec3, double ra4, double dec4,
                        BufNum bufNum=0);
 
+        /* NOTE: The reentrant versions of the four routines above.  The
+         * results go into the caller's buffer which must have been created
+         * for this mesh (or one of the same level).  They return false if the
+         * buffer overflowed.
+         */
+
+        /* @short finds the trixels that cover the specified circle
+         */
+        bool intersect(MeshBuffer* result, double ra, double dec,
+                       double radius) const;
+
+        /* @short finds the trixels that cover the specified line segment
+         */
+        bool intersect(MeshBuffer* result, double ra1, double dec1,
+                       double ra2, double dec2) const;
+
+        /* @short find the trixels that cover the specified triangle
+         */
+        bool intersect(MeshBuffer* result, double ra1, double dec1,
+                       double ra2, double dec2, double ra3, double dec3) const;
+
+        /* @short finds the trixels that cover the specified quadrilateral
+         */
+        bool intersect(MeshBuffer* result, double ra1, double dec1,
+                       double ra2, double dec2, double ra3, double dec3,
+                       double ra4, double dec4) const;
+
         /* @short returns the number of trixels in the result buffer bufNum.
          */
         int intersectSize(BufNum bufNum=0);
@@ -138,12 +172,17 @@ public:
          */
         MeshBuffer* meshBuffer(BufNum bufNum=0);
 
+        /* @short returns the underlying index.  It is not modified after
+         * the mesh is constructed so it can be shared between threads.
+         */
+        const SpatialIndex* spatialIndex() const { return htm; }
+
         void vertices(Trixel id, double *ra1, double *dec1,
                                  double *ra2, double *dec2,
-                                 double *ra3, double *dec3);
+                                 double *ra3, double *dec3) const;
     private:
         const char *name;
-        SpatialIndex *htm;
+        const SpatialIndex *htm;
         int m_level, m_buildLevel;
         int numTrixels, magicNum;
 
@@ -159,7 +198,7 @@ public:
         /* @short fills the specified buffer with the intersection results in the
          * RangeConvex.
          */
-        bool performIntersection(RangeConvex* convex, BufNum bufNum=0);
+        bool performIntersection(RangeConvex* convex, MeshBuffer* buffer) const;
 
         /* @short users can only use the allocated buffers
          */
@@ -174,7 +213,7 @@ public:
         /* @short used by the line intersection routine.  Maybe there is a
          * simpler and faster approach that does not require this conversion.
          */
-        void toXYZ( double ra, double dec, double *x, double *y, double *z);
+        void toXYZ( double ra, double dec, double *x, double *y, double *z) const;
 
 };
 
@@ -0,0 +1,175 @@
+/***************************************************************************
+               MeshAperture.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2014-06-02
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <cmath>
+#include <algorithm>
+
+#include "HTMesh.h"
+#include "MeshBuffer.h"
+#include "MeshAperture.h"
+
+static const double DEG2RAD = M_PI / 180.0;
+
+static void toXYZ(double ra, double dec, double *v)
+{
+    double rar = ra * DEG2RAD;
+    double decr = dec * DEG2RAD;
+    v[0] = cos(decr) * cos(rar);
+    v[1] = cos(decr) * sin(rar);
+    v[2] = sin(decr);
+}
+
+MeshAperture::MeshAperture(const HTMesh *mesh, double drift) :
+    m_mesh(mesh), m_drift(drift), m_maxCapRadius(0.0),
+    m_stamp(mesh->size(), 0), m_frame(1),
+    m_valid(false), m_radius(0.0),
+    m_fullUpdates(0), m_incrementalUpdates(0)
+{
+    m_candidates = new MeshBuffer(mesh);
+    m_visible = new MeshBuffer(mesh);
+    m_previous = new MeshBuffer(mesh);
+    m_entered = new MeshBuffer(mesh);
+    m_left = new MeshBuffer(mesh);
+    m_center[0] = 1.0;
+    m_center[1] = m_center[2] = 0.0;
+    setupCaps();
+}
+
+MeshAperture::~MeshAperture()
+{
+    delete m_candidates;
+    delete m_visible;
+    delete m_previous;
+    delete m_entered;
+    delete m_left;
+}
+
+void MeshAperture::setupCaps()
+{
+    int size = m_mesh->size();
+    m_caps.resize(size * 5);
+
+    for (int id = 0; id < size; id++) {
+        double ra[3], dec[3], v[3][3];
+        m_mesh->vertices(id, &ra[0], &dec[0], &ra[1], &dec[1], &ra[2], &dec[2]);
+        for (int i = 0; i < 3; i++)
+            toXYZ(ra[i], dec[i], v[i]);
+
+        // The normalized sum of the corners lies inside the trixel
+        double c[3];
+        for (int k = 0; k < 3; k++)
+            c[k] = v[0][k] + v[1][k] + v[2][k];
+        double norm = sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+        for (int k = 0; k < 3; k++)
+            c[k] /= norm;
+
+        double cosCap = 1.0;
+        for (int i = 0; i < 3; i++) {
+            double dot = c[0] * v[i][0] + c[1] * v[i][1] + c[2] * v[i][2];
+            cosCap = std::min(cosCap, dot);
+        }
+        cosCap = std::max(-1.0, cosCap);
+
+        double *cap = &m_caps[id * 5];
+        cap[0] = c[0];
+        cap[1] = c[1];
+        cap[2] = c[2];
+        cap[3] = cosCap;
+        cap[4] = sqrt(1.0 - cosCap * cosCap);
+        m_maxCapRadius = std::max(m_maxCapRadius, acos(cosCap) / DEG2RAD);
+    }
+}
+
+bool MeshAperture::update(double ra, double dec, double radius)
+{
+    double center[3];
+    toXYZ(ra, dec, center);
+
+    bool incremental = false;
+    if (m_valid) {
+        double dot = center[0] * m_center[0] + center[1] * m_center[1] +
+                     center[2] * m_center[2];
+        double moved = acos(std::max(-1.0, std::min(1.0, dot))) / DEG2RAD;
+        // A smaller radius would still be covered, but the candidates
+        // would stay as wide as the largest radius seen, so any change of
+        // radius beyond the drift recomputes them.
+        incremental = moved + std::fabs(radius - m_radius) <= m_drift;
+    }
+
+    // Any trixel whose bounding cap touches the new circle lies within
+    // moved + radius + maxCapRadius of the old center, which the widened
+    // candidate circle covers while the test above holds.
+    if (!incremental) {
+        double wide = radius + m_drift + m_maxCapRadius;
+        m_candidates->reset();
+        if (wide >= 180.0)
+            m_candidates->fill();
+        else
+            m_mesh->intersect(m_candidates, ra, dec, wide);
+        m_center[0] = center[0];
+        m_center[1] = center[1];
+        m_center[2] = center[2];
+        m_radius = radius;
+        m_valid = true;
+        m_fullUpdates++;
+    } else {
+        m_incrementalUpdates++;
+    }
+
+    // A stamp of 0 means never visible, so frames start at 2
+    if (++m_frame == 0) {
+        std::fill(m_stamp.begin(), m_stamp.end(), 0);
+        m_frame = 2;
+    }
+
+    std::swap(m_visible, m_previous);
+    m_visible->reset();
+    m_entered->reset();
+    m_left->reset();
+
+    bool all = radius + m_maxCapRadius >= 180.0;
+    double cosRadius = cos(radius * DEG2RAD);
+    double sinRadius = sin(radius * DEG2RAD);
+
+    const Trixel *candidates = m_candidates->buffer();
+    int size = m_candidates->size();
+    for (int i = 0; i < size; i++) {
+        Trixel id = candidates[i];
+        if (!all) {
+            // visible if the angle to the cap center is at most
+            // radius + cap radius
+            const double *cap = &m_caps[id * 5];
+            double dot = center[0] * cap[0] + center[1] * cap[1] +
+                         center[2] * cap[2];
+            if (dot < cosRadius * cap[3] - sinRadius * cap[4])
+                continue;
+        }
+        m_visible->append(id);
+        if (m_stamp[id] != m_frame - 1)
+            m_entered->append(id);
+        m_stamp[id] = m_frame;
+    }
+
+    const Trixel *previous = m_previous->buffer();
+    size = m_previous->size();
+    for (int i = 0; i < size; i++) {
+        if (m_stamp[previous[i]] != m_frame)
+            m_left->append(previous[i]);
+    }
+
+    return incremental;
+}
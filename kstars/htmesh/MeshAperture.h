@@ -0,0 +1,112 @@
+/***************************************************************************
+               MeshAperture.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2014-06-02
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+***************************************************************************/
+
+#ifndef MESH_APERTURE_H
+#define MESH_APERTURE_H
+
+#include <vector>
+
+#include "typedef.h"
+
+class HTMesh;
+class MeshBuffer;
+
+/* @class MeshAperture keeps the trixels covering a circular aperture up to
+ * date as the aperture moves.  A full HTM intersection is done with the
+ * radius widened by a margin and the result kept as a candidate set.  As long
+ * as the aperture stays inside that widened circle the visible trixels are
+ * picked out of the candidates by comparing the aperture with the bounding
+ * cap of each trixel, which is a dot product per trixel instead of a
+ * RangeConvex intersection.
+ *
+ * The visible set is a superset of what HTMesh::intersect() returns for the
+ * same circle since a trixel is kept when its bounding cap touches the
+ * circle.  After every update() the trixels that entered and left the
+ * visible set since the previous update() are available as well.
+ *
+ * A MeshAperture only uses the const HTMesh::intersect() routines so every
+ * user (or thread) can have its own.
+ */
+
+class MeshAperture {
+
+    public:
+        /* @short creates an aperture tracker for mesh.
+         * @param drift how far (in degrees) the center may move, plus how
+         * much the radius may change, before a full intersection is redone.
+         */
+        explicit MeshAperture(const HTMesh *mesh, double drift = 2.0);
+
+        ~MeshAperture();
+
+        /* @short moves the aperture to the circle at (ra, dec) with the given
+         * radius, all in degrees.  Returns true if the visible trixels were
+         * derived from the cached candidates and false if a full intersection
+         * was needed.
+         */
+        bool update(double ra, double dec, double radius);
+
+        /* @short forgets the candidates so the next update() does a full
+         * intersection.  The entered and left sets of that update() are still
+         * relative to the current visible set.
+         */
+        void invalidate() { m_valid = false; }
+
+        /* @short the trixels covering the current aperture.
+         */
+        const MeshBuffer* visible() const { return m_visible; }
+
+        /* @short the trixels that became visible in the last update().
+         */
+        const MeshBuffer* entered() const { return m_entered; }
+
+        /* @short the trixels that were visible before the last update() but
+         * are not any more.
+         */
+        const MeshBuffer* left() const { return m_left; }
+
+        /* @short the number of full and incremental updates so far.
+         */
+        int fullUpdates() const { return m_fullUpdates; }
+        int incrementalUpdates() const { return m_incrementalUpdates; }
+
+    private:
+        // owns raw buffers, no copies
+        MeshAperture(const MeshAperture&);
+        MeshAperture& operator=(const MeshAperture&);
+
+        /* @short computes the bounding cap of every trixel of the mesh.
+         */
+        void setupCaps();
+
+        const HTMesh *m_mesh;
+        double m_drift;
+
+        // center, cos and sin of the bounding cap radius for each trixel
+        std::vector<double> m_caps;
+        double m_maxCapRadius;
+
+        // stamp of the last update() each trixel was visible in
+        std::vector<unsigned int> m_stamp;
+        unsigned int m_frame;
+
+        MeshBuffer *m_candidates;
+        MeshBuffer *m_visible;
+        MeshBuffer *m_previous;
+        MeshBuffer *m_entered;
+        MeshBuffer *m_left;
+
+        bool m_valid;
+        double m_center[3];
+        double m_radius;
+
+        int m_fullUpdates;
+        int m_incrementalUpdates;
+};
+
+#endif
@@ -4,7 +4,7 @@
 #include "HTMesh.h"
 #include "MeshBuffer.h"
 
-MeshBuffer::MeshBuffer(HTMesh *mesh) {
+MeshBuffer::MeshBuffer(const HTMesh *mesh) {
 
     m_size= 0;
     m_error = 0;
@@ -20,12 +20,18 @@ class HTMesh;
  * the life of an HTMesh.  Each mesh buffer is re-usable.  Simply reset() it and
  * then fill it by append()'ing trixels.  A MeshIterator grabs the size() and
  * the buffer() so it can iterate over the results.
+ *
+ * Code that queries the mesh from more than one place at a time (or from
+ * another thread) creates its own MeshBuffer and hands it to the const
+ * HTMesh::intersect() routines instead of using the mesh's numbered buffers.
  */
 
 class MeshBuffer {
 
     public:
-        MeshBuffer(HTMesh *mesh);
+        /* @short allocates room for every trixel of mesh.
+         */
+        explicit MeshBuffer(const HTMesh *mesh);
 
         ~MeshBuffer();
 
@@ -55,6 +61,10 @@ class MeshBuffer {
         void fill();
 
     private:
+        // owns a raw buffer, no copies
+        MeshBuffer(const MeshBuffer&);
+        MeshBuffer& operator=(const MeshBuffer&);
+
         Trixel *m_buffer;
         int    m_size;
         int    maxSize;
@@ -35,19 +35,24 @@ double drand48()
 
 
 ////////////////////////////////////////////////////////////////////////////////
-// get new element level using given probability
+// get new element level using given probability.  Each list has its own
+// random state so that lists in different threads don't share drand48()'s.
 ////////////////////////////////////////////////////////////////////////////////
-long getNewLevel(long maxLevel, float probability)
+long getNewLevel(long maxLevel, float probability, unsigned int *seed)
 {
     long newLevel = 0;
-    while ( (newLevel < maxLevel - 1) && (drand48() < probability) ) // fast hack. fix later
+    while ( newLevel < maxLevel - 1 ) {
+        *seed = *seed * 1103515245u + 12345u;
+        if ( ((*seed >> 16) & 0x7fff) / 32768.0 >= probability )
+            break;
         newLevel++;
+    }
     return(newLevel);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 SkipList::SkipList(float probability)
-    : myProbability(probability)
+    : myProbability(probability), mySeed(1)
 {
     myHeader = new SkipListElement(); // get memory for header element
     myHeader->setKey( KEY_MAX);
@@ -94,7 +99,7 @@ void SkipList::insert(const Key searchKey, const Value value)
         // get new level and fix list level
 
         // get new level
-        newLevel = getNewLevel(SKIPLIST_MAXLEVEL, myProbability);
+        newLevel = getNewLevel(SKIPLIST_MAXLEVEL, myProbability, &mySeed);
         if (newLevel > myHeader->getLevel() ) {
             // adjust header level
             for (i=myHeader->getLevel() + 1; i<=newLevel; i++) {
@@ -54,6 +54,7 @@ public:
 
 private:
     float myProbability;
+    unsigned int mySeed;
     /// the header (first) list element
     SkipListElement* myHeader;
     SkipListElement* iter;
@@ -1,7 +1,66 @@
+// Build from this directory with something like:
+//   g++ -O2 -I. -I<build>/kstars/htmesh test-htmesh.cpp HTMesh.cpp
+//       MeshBuffer.cpp MeshIterator.cpp MeshAperture.cpp HtmRange*.cpp
+//       RangeConvex.cpp SkipList*.cpp Spatial*.cpp -o test-htmesh
+
 #include <iostream>
+#include <ctime>
+#include <vector>
+#include <algorithm>
 
 #include "HTMesh.h"
+#include "MeshBuffer.h"
 #include "MeshIterator.h"
+#include "MeshAperture.h"
+
+/* Follows a slowly tracking aperture for a number of frames, once with a
+ * full intersection per frame and once with a MeshAperture, and checks that
+ * the MeshAperture always covers the full intersection.
+ */
+static void benchAperture(int level, double radius, double step, int frames)
+{
+    HTMesh mesh( level, level );
+    MeshBuffer full( &mesh );
+    MeshAperture aperture( &mesh );
+
+    double ra0 = 83.8, dec0 = -5.4;
+    std::vector<char> seen( mesh.size() );
+
+    clock_t start = clock();
+    long fullTrixels = 0;
+    for ( int i = 0; i < frames; i++ ) {
+        mesh.intersect( &full, ra0 + i * step, dec0 + i * step / 3.0, radius );
+        fullTrixels += full.size();
+    }
+    double fullTime = double( clock() - start ) / CLOCKS_PER_SEC;
+
+    start = clock();
+    long visibleTrixels = 0, changed = 0;
+    for ( int i = 0; i < frames; i++ ) {
+        aperture.update( ra0 + i * step, dec0 + i * step / 3.0, radius );
+        visibleTrixels += aperture.visible()->size();
+        changed += aperture.entered()->size() + aperture.left()->size();
+    }
+    double apertureTime = double( clock() - start ) / CLOCKS_PER_SEC;
+
+    // Check the last frame against the full intersection
+    int missing = 0;
+    std::fill( seen.begin(), seen.end(), 0 );
+    MeshIterator visible( aperture.visible() );
+    while ( visible.hasNext() )
+        seen[ visible.next() ] = 1;
+    MeshIterator exact( &full );
+    while ( exact.hasNext() )
+        if ( !seen[ exact.next() ] ) missing++;
+
+    printf("level %d radius %5.1f step %5.3f: full %7.2f us/frame (%5.1f trixels), "
+           "incremental %7.2f us/frame (%5.1f trixels, %4.2f changed, %d full updates), "
+           "missing %d\n",
+           level, radius, step,
+           1e6 * fullTime / frames, double( fullTrixels ) / frames,
+           1e6 * apertureTime / frames, double( visibleTrixels ) / frames,
+           double( changed ) / frames, aperture.fullUpdates(), missing );
+}
 
 
 int main() {
@@ -15,13 +74,12 @@ int main() {
   
     //Lookup the triangle containing (ra,dec)
     long id = mesh->index( ra, dec );
-    const char *name = mesh->indexToName( id );
-    printf("(%8.4f %8.4f): %s\n", ra, dec, name);
+    printf("(%8.4f %8.4f): %ld\n", ra, dec, id);
   
     double vr1, vd1, vr2, vd2, vr3, vd3;
     mesh->vertices( id, &vr1, &vd1, &vr2, &vd2, &vr3, &vd3);
 
-    printf("\nThe three vertices of %s are:\n", name);
+    printf("\nThe three vertices of %ld are:\n", id);
     printf("    (%6.2f, %6.2f)\n", vr1, vd1);
     printf("    (%6.2f, %6.2f)\n", vr2, vd2);
     printf("    (%6.2f, %6.2f)\n", vr3, vd3);
@@ -47,7 +105,7 @@ int main() {
         printf("Triangles within %5.2f degrees of (%6.2f, %6.2f)\n", radius, ra, dec);
       
         while ( iterator.hasNext() ) {
-            printf("%s\n",  mesh->indexToName( iterator.next() ));    
+            printf("%d\n",  iterator.next() );
         }
     }
   
@@ -63,5 +121,13 @@ int main() {
     mesh->intersect(ra1, dec1, ra2, dec2);
     printf("found %d trixels\n", mesh->intersectSize());
 
+    printf("\nAperture benchmark:\n");
+    benchAperture( 3, 46.0, 0.01, 2000 );
+    benchAperture( 3, 11.0, 0.01, 2000 );
+    benchAperture( 6, 46.0, 0.01, 2000 );
+    benchAperture( 6, 6.0, 0.01, 2000 );
+    benchAperture( 6, 6.0, 0.5, 2000 );
+    benchAperture( 7, 3.0, 0.002, 2000 );
+
     return 0;
 }
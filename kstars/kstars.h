@@ -329,6 +329,39 @@ public Q_SLOTS:
      */
     Q_SCRIPTABLE Q_NOREPLY void exportImage( const QString &filename, int width = -1, int height = -1, bool includeLegend = false );
 
+    /**DBUS interface function.  Render the sky charts listed in a job file.
+     * Each line of the file is one chart: "file RA Dec FOV width height [UT]",
+     * with RA in hours, Dec in degrees (J2000), FOV in degrees and the size
+     * in pixels.  The view of the sky map is left unchanged.
+     * @param jobFile the file listing the charts
+     * @return the number of charts written
+     * @see BatchChartExporter
+     */
+    Q_SCRIPTABLE int exportCharts( const QString &jobFile );
+
+    /**DBUS interface function.  Render the given sky charts.
+     * @param jobs one chart per entry, in the syntax of the job files of exportCharts()
+     * @return the number of charts written
+     */
+    Q_SCRIPTABLE int exportChartList( const QStringList &jobs );
+
+    /**DBUS interface function.  Summarize the recorded drawing times.
+     * Drawing times are only recorded while the ProfileDrawing option is set.
+     * @return one tab separated line per part of drawing with the number of
+     * frames it was drawn in, the mean time per frame and the longest time
+     * in ms, followed by the frame times and JIT update counts.  Empty if
+     * nothing was recorded.
+     * @see FrameProfiler
+     */
+    Q_SCRIPTABLE QString getDrawStatistics();
+
+    /**DBUS interface function.  Write the recorded drawing times to a file.
+     * @param fileName a file ending in ".json" is written in the Chrome trace
+     * event format, any other file as CSV
+     * @return true if the file was written
+     */
+    Q_SCRIPTABLE bool dumpDrawProfile( const QString &fileName );
+
     /**DBUS interface function.  Return a URL to retrieve Digitized Sky Survey image.
      * @param objectName name of the object.
      * @note If the object is note found, the string "ERROR" is returned.
@@ -349,6 +382,13 @@ public Q_SLOTS:
      */
     Q_SCRIPTABLE QString getObjectDataXML( const QString &objectName );
 
+    /**DBUS interface function.  Return the constellations of many sky objects at once
+     * @param objectNames names of the objects
+     * @return the constellation names, in the order of objectNames; an empty
+     * string for each object that was not found
+     */
+    Q_SCRIPTABLE QStringList getObjectConstellations( const QStringList &objectNames );
+
     /**DBUS interface function.  Set the approx field-of-view
      * @param FOV_Degrees field of view in degrees
      */
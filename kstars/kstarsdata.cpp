@@ -238,7 +238,7 @@ void KStarsData::updateTime( GeoLocation *geo, SkyMap *skymap, const bool automa
         if ( clock()->isManualMode() )
             QTimer::singleShot( 0, skymap, SLOT( forceUpdateNow() ) );
         else
-            skymap->forceUpdate();
+            skymap->forceClockUpdate();
     }
 }
 
@@ -47,6 +47,8 @@
 #include "simclock.h"
 #include "Options.h"
 #include "imageexporter.h"
+#include "batchchartexporter.h"
+#include "frameprofiler.h"
 #include "skycomponents/constellationboundarylines.h"
 
 // INDI includes
@@ -438,6 +440,26 @@ void KStars::exportImage( const QString &url, int w, int h, bool includeLegend )
     imageExporter->exportImage( url );
 }
 
+int KStars::exportCharts( const QString &jobFile ) {
+    BatchChartExporter exporter( this );
+    exporter.loadJobs( jobFile );
+    return exporter.exportAll();
+}
+
+int KStars::exportChartList( const QStringList &jobs ) {
+    BatchChartExporter exporter( this );
+    exporter.addJobs( jobs );
+    return exporter.exportAll();
+}
+
+QString KStars::getDrawStatistics() {
+    return FrameProfiler::Instance()->statistics();
+}
+
+bool KStars::dumpDrawProfile( const QString &fileName ) {
+    return FrameProfiler::Instance()->dump( fileName );
+}
+
 QString KStars::getDSSURL( const QString &objectName ) {
     SkyObject *target = data()->objectNamed( objectName );
     if ( !target ) {
@@ -453,6 +475,26 @@ QString KStars::getDSSURL( double RA_J2000, double Dec_J2000, float width, float
     return KSUtils::getDSSURL( ra, dec, width, height );
 }
 
+QStringList KStars::getObjectConstellations( const QStringList &objectNames ) {
+    QList<SkyPoint*> points;
+    QList<int> found;
+    for ( int i = 0; i < objectNames.size(); ++i ) {
+        SkyObject *target = data()->objectNamed( objectNames[i] );
+        if ( target ) {
+            points.append( target );
+            found.append( i );
+        }
+    }
+
+    QStringList names = data()->skyComposite()->getConstellationBoundary()->constellationNames( points );
+    QStringList result;
+    for ( int i = 0; i < objectNames.size(); ++i )
+        result.append( QString() );
+    for ( int i = 0; i < found.size(); ++i )
+        result[ found[i] ] = names[i];
+    return result;
+}
+
 QString KStars::getObjectDataXML( const QString &objectName ) {
     SkyObject *target = data()->objectNamed( objectName );
     if ( !target ) {
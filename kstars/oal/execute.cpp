@@ -273,14 +273,31 @@ void Execute::slotEndSession() {
         if( fileURL.isValid() ) {
 
             QFile f( fileURL.path() );
-            if( ! f.open( QIODevice::WriteOnly ) ) {
-                QString message = i18n( "Could not open file %1", f.fileName() );
-                KMessageBox::sorry( 0, message, i18n( "Could Not Open File" ) );
-                return;
+            if( f.exists() ) {
+                //Adding the session to an existing log does not rewrite what is already there
+                int answer = KMessageBox::warningYesNoCancel( 0,
+                                i18n( "The file %1 already exists. Do you want to add this session to it, or overwrite it?", f.fileName() ),
+                                i18n( "Save Session" ), KGuiItem( i18n( "Append" ) ), KGuiItem( i18n( "Overwrite" ) ) );
+                if( answer == KMessageBox::Cancel )
+                    return;
+                if( answer == KMessageBox::Yes ) {
+                    if( ! logObject->appendLog( f.fileName(), false ) ) {
+                        QString message = i18n( "Could not add the session to %1", f.fileName() );
+                        KMessageBox::sorry( 0, message, i18n( "Could Not Save Session" ) );
+                        return;
+                    }
+                    f.setFileName( QString() );
+                }
+            }
+            if( ! f.fileName().isEmpty() ) {
+                if( ! f.open( QIODevice::WriteOnly ) ) {
+                    QString message = i18n( "Could not open file %1", f.fileName() );
+                    KMessageBox::sorry( 0, message, i18n( "Could Not Open File" ) );
+                    return;
+                }
+                logObject->writeLog( &f, false );
+                f.close();
             }
-            QTextStream ostream( &f );
-            ostream<< logObject->writeLog( false );
-            f.close();
         }
 
     }
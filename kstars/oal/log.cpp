@@ -25,11 +25,154 @@
 #include "skycomponents/skymapcomposite.h"
 #include "kstarsdatetime.h"
 
+#include <QFile>
+#include <QStringList>
+#include <QVector>
+
+#include <kdebug.h>
+#include <ksavefile.h>
+
+static QString observerId( const OAL::Observer *o ) { return o->id(); }
+static QString observerName( const OAL::Observer *o ) { return o->name() + ' ' + o->surname(); }
+static QString siteId( const OAL::Site *s ) { return s->id(); }
+static QString siteName( const OAL::Site *s ) { return s->name(); }
+static QString sessionId( const OAL::Session *s ) { return s->id(); }
+static QString scopeId( const OAL::Scope *s ) { return s->id(); }
+static QString scopeName( const OAL::Scope *s ) { return s->name(); }
+static QString eyepieceId( const OAL::Eyepiece *e ) { return e->id(); }
+static QString eyepieceName( const OAL::Eyepiece *e ) { return e->name(); }
+static QString lensId( const OAL::Lens *l ) { return l->id(); }
+static QString lensName( const OAL::Lens *l ) { return l->name(); }
+static QString filterId( const OAL::Filter *f ) { return f->id(); }
+static QString filterName( const OAL::Filter *f ) { return f->name(); }
+static QString observationId( const OAL::Observation *o ) { return o->id(); }
+
+/**@return a new id made from id that is not in taken, and adds it to taken */
+static QString uniqueId( const QString &id, QSet<QString> *taken ) {
+    QString result;
+    int n = 1;
+    do {
+        result = id + '_' + QString::number( n++ );
+    } while( taken->contains( result ) );
+    taken->insert( result );
+    return result;
+}
+
+/**@short Appends the token of reader to entry, leaving out whitespace and
+ * the difference between text and CDATA, so that an entry read from a file
+ * compares equal to the same entry written again */
+static void appendCanonical( const QXmlStreamReader &reader, QString *entry ) {
+    if( reader.isStartElement() ) {
+        *entry += '<' + reader.qualifiedName().toString();
+        foreach( const QXmlStreamAttribute &a, reader.attributes() )
+            *entry += ' ' + a.qualifiedName().toString() + "=\"" + a.value().toString() + '"';
+        *entry += '>';
+    } else if( reader.isEndElement() ) {
+        *entry += "</" + reader.qualifiedName().toString() + '>';
+    } else if( reader.isCharacters() && ! reader.isWhitespace() ) {
+        *entry += reader.text().toString();
+    }
+}
+
+template <class T>
+QString OAL::Log::canonicalEntry( T *t, void (OAL::Log::*write)( T* ) ) {
+    QString xml;
+    QXmlStreamWriter buffer( &xml );
+    QXmlStreamWriter *out = writer;
+    writer = &buffer;
+    ( this->*write )( t );
+    writer = out;
+
+    QXmlStreamReader input( xml );
+    input.setNamespaceProcessing( false );
+    QString entry;
+    while( ! input.atEnd() ) {
+        input.readNext();
+        appendCanonical( input, &entry );
+    }
+    return entry;
+}
+
+template <class T>
+void OAL::Log::writeNewEntries( const QList<T*> &list, QString (*id)( const T* ), void (OAL::Log::*write)( T* ),
+                                const QString &section, const QHash<QString, QString> &existing ) {
+    //Ids are only unique within one log. An entry of this log whose id is
+    //in the file with the same content is already there; one whose id
+    //belongs to another entry is written under a new id.
+    QHash<QString, QSet<QString> >::const_iterator referenced = m_referencedIds.constFind( section );
+    QSet<QString> taken = existing.keys().toSet();
+    foreach( T *t, list )
+        taken.insert( id( t ) );
+    QHash<QString, QString> *renamed = &m_renamedIds[ section ];
+    foreach( T *t, list ) {
+        if( referenced != m_referencedIds.constEnd() && ! referenced.value().contains( id( t ) ) )
+            continue;
+        QHash<QString, QString>::const_iterator it = existing.constFind( id( t ) );
+        if( it != existing.constEnd() ) {
+            if( it.value() == canonicalEntry( t, write ) )
+                continue;
+            renamed->insert( id( t ), uniqueId( id( t ), &taken ) );
+        }
+        ( this->*write )( t );
+    }
+}
+
+template <class T>
+T* OAL::Log::ListIndex<T>::find( const QList<T*> &list, const QString &key ) {
+    if( changed( list ) )
+        rebuild( list );
+    int i = m_positions.value( key, -1 );
+    if( i < 0 )
+        return NULL;
+    if( m_key( list.at( i ) ) == key )
+        return list.at( i );
+    //An entry was replaced or changed in place since the index was built
+    rebuild( list );
+    i = m_positions.value( key, -1 );
+    return i >= 0 ? list.at( i ) : NULL;
+}
+
+template <class T>
+bool OAL::Log::ListIndex<T>::changed( const QList<T*> &list ) const {
+    if( m_size != list.size() )
+        return true;
+    return ! list.isEmpty() && ( m_first != list.first() || m_last != list.last() );
+}
+
+template <class T>
+void OAL::Log::ListIndex<T>::rebuild( const QList<T*> &list ) {
+    m_positions.clear();
+    //Backwards, so that the first entry with a key is kept as before
+    for( int i = list.size() - 1; i >= 0; --i )
+        m_positions.insert( m_key( list.at( i ) ), i );
+    m_size = list.size();
+    m_first = list.isEmpty() ? NULL : list.first();
+    m_last = list.isEmpty() ? NULL : list.last();
+}
+
+OAL::Log::Log() :
+    native( true ), ks( NULL ), writer( NULL ), reader( NULL ), geo( NULL ),
+    m_observerById( observerId ), m_observerByName( observerName ),
+    m_siteById( siteId ), m_siteByName( siteName ),
+    m_sessionById( sessionId ),
+    m_scopeById( scopeId ), m_scopeByName( scopeName ),
+    m_eyepieceById( eyepieceId ), m_eyepieceByName( eyepieceName ),
+    m_lensById( lensId ), m_lensByName( lensName ),
+    m_filterById( filterId ), m_filterByName( filterName ),
+    m_observationById( observationId )
+{
+}
+
 void OAL::Log::writeBegin() {
-    ks = KStars::Instance();
     output = "";
-    m_targetList = ks->observingList()->sessionList();
     writer = new QXmlStreamWriter(&output);
+    writeStart();
+}
+
+void OAL::Log::writeStart() {
+    ks = KStars::Instance();
+    m_targetList = ks->observingList()->sessionList();
+    m_renamedIds.clear();
     writer->setAutoFormatting( true );
     writer->writeStartDocument();
     writer->writeNamespace( "http://observation.sourceforge.net/openastronomylog", "oal" );
@@ -42,6 +185,20 @@ void OAL::Log::writeBegin() {
 QString OAL::Log::writeLog( bool _native ) {
     native = _native;
     writeBegin();
+    writeContents();
+    writeEnd();
+    return output;
+}
+
+void OAL::Log::writeLog( QIODevice *device, bool _native ) {
+    native = _native;
+    writer = new QXmlStreamWriter( device );
+    writeStart();
+    writeContents();
+    writeEnd();
+}
+
+void OAL::Log::writeContents() {
     if( native )
         writeGeoDate();
     writeObservers();
@@ -54,8 +211,150 @@ QString OAL::Log::writeLog( bool _native ) {
     writeFilters();
     writeImagers();
     writeObservations();
-    writeEnd();
-    return output;
+}
+
+bool OAL::Log::appendLog( const QString &fileName, bool _native ) {
+    native = _native;
+    ks = KStars::Instance();
+    m_targetList = ks->observingList()->sessionList();
+    m_renamedIds.clear();
+
+    //Only the observers, sites and equipment that the sessions and
+    //observations refer to are added
+    m_referencedIds.clear();
+    QStringList referencing;
+    referencing << "observers" << "sites" << "scopes" << "eyepieces" << "lenses" << "filters";
+    foreach( const QString &section, referencing )
+        m_referencedIds.insert( section, QSet<QString>() );
+    foreach( OAL::Session *s, m_sessionList )
+        m_referencedIds[ "sites" ].insert( s->site() );
+    foreach( OAL::Observation *o, m_observationList ) {
+        m_referencedIds[ "observers" ].insert( o->observer() );
+        m_referencedIds[ "sites" ].insert( o->site() );
+        m_referencedIds[ "scopes" ].insert( o->scope() );
+        m_referencedIds[ "eyepieces" ].insert( o->eyepiece() );
+        m_referencedIds[ "lenses" ].insert( o->lens() );
+        m_referencedIds[ "filters" ].insert( o->filter() );
+    }
+
+    QFile in( fileName );
+    if( ! in.open( QIODevice::ReadOnly ) )
+        return false;
+    KSaveFile out( fileName );
+    if( ! out.open() )
+        return false;
+
+    //Copy the file token by token. The new entries go at the end of
+    //their sections, the sections the file lacks before the first one
+    //that follows them, and the new observations at the end of the log.
+    QXmlStreamReader input( &in );
+    input.setNamespaceProcessing( false );
+    writer = new QXmlStreamWriter( &out );
+    writer->setAutoFormatting( true );
+
+    QStringList sections;
+    sections << "observers" << "sites" << "sessions" << "targets"
+             << "scopes" << "eyepieces" << "lenses" << "filters";
+    QSet<QString> seenSections;
+    //Entries of the current section and observations, id -> content
+    QHash<QString, QString> existing, observations;
+    QString section, entryId, entry;
+    int depth = 0, entryDepth = 0;
+    while( ! input.atEnd() ) {
+        input.readNext();
+        if( input.hasError() )
+            break;
+        if( input.isStartElement() && entryDepth == 0 &&
+            ( ( depth == 1 && input.name() == "observation" ) ||
+              ( depth == 2 && sections.contains( section ) ) ) ) {
+            entryDepth = depth + 1;
+            entryId = input.attributes().value( "id" ).toString();
+            entry.clear();
+        }
+        if( entryDepth > 0 ) {
+            appendCanonical( input, &entry );
+            if( input.isEndElement() && depth == entryDepth ) {
+                if( entryDepth == 2 )
+                    observations.insert( entryId, entry );
+                else
+                    existing.insert( entryId, entry );
+                entryDepth = 0;
+            }
+        }
+        if( input.isStartElement() ) {
+            ++depth;
+            if( depth == 2 ) {
+                section = input.name().toString();
+                existing.clear();
+                //The geodate comes first, anything unknown after the sections
+                int next = sections.indexOf( section );
+                if( section != "geodate" )
+                    writeMissingSections( sections, next >= 0 ? next : sections.size(), &seenSections );
+            }
+        } else if( input.isEndElement() ) {
+            if( depth == 2 && sections.contains( section ) ) {
+                writeNewEntries( section, existing );
+                seenSections.insert( section );
+            } else if( depth == 1 ) {
+                writeMissingSections( sections, sections.size(), &seenSections );
+                writeNewEntries( m_observationList, observationId, &OAL::Log::writeObservation, "observations", observations );
+            }
+            --depth;
+        } else if( input.isWhitespace() ) {
+            //Auto formatting indents the copy
+            continue;
+        }
+        writer->writeCurrentToken( input );
+    }
+
+    delete writer;
+    writer = NULL;
+    in.close();
+    if( input.hasError() ) {
+        kWarning() << "Could not append to" << fileName << ":" << input.errorString();
+        out.abort();
+        return false;
+    }
+    return out.finalize();
+}
+
+void OAL::Log::writeNewEntries( const QString &section, const QHash<QString, QString> &existing ) {
+    //Targets are named after the object, so one that is there is the same target
+    if( section == "observers" ) {
+        writeNewEntries( m_observerList, observerId, &OAL::Log::writeObserver, section, existing );
+    } else if( section == "sites" ) {
+        writeNewEntries( m_siteList, siteId, &OAL::Log::writeSite, section, existing );
+    } else if( section == "sessions" ) {
+        writeNewEntries( m_sessionList, sessionId, &OAL::Log::writeSession, section, existing );
+    } else if( section == "targets" ) {
+        foreach( SkyObject *o, m_targetList )
+            if( ! existing.contains( QString( o->name() ).remove( ' ' ) ) )
+                writeTarget( o );
+    } else if( section == "scopes" ) {
+        writeNewEntries( m_scopeList, scopeId, &OAL::Log::writeScope, section, existing );
+    } else if( section == "eyepieces" ) {
+        writeNewEntries( m_eyepieceList, eyepieceId, &OAL::Log::writeEyepiece, section, existing );
+    } else if( section == "lenses" ) {
+        writeNewEntries( m_lensList, lensId, &OAL::Log::writeLens, section, existing );
+    } else if( section == "filters" ) {
+        writeNewEntries( m_filterList, filterId, &OAL::Log::writeFilter, section, existing );
+    }
+}
+
+void OAL::Log::writeMissingSections( const QStringList &sections, int before, QSet<QString> *written ) {
+    for( int i = 0; i < before; ++i ) {
+        if( written->contains( sections.at( i ) ) )
+            continue;
+        writer->writeStartElement( sections.at( i ) );
+        writeNewEntries( sections.at( i ), QHash<QString, QString>() );
+        writer->writeEndElement();
+        written->insert( sections.at( i ) );
+    }
+}
+
+QString OAL::Log::writtenId( const QString &section, const QString &id ) const {
+    QHash<QString, QHash<QString, QString> >::const_iterator it = m_renamedIds.constFind( section );
+    return it == m_renamedIds.constEnd() ? id : it.value().value( id, id );
 }
 
 void OAL::Log::writeEnd() {
@@ -190,7 +489,7 @@ void OAL::Log::writeTarget( SkyObject *o ) {
 
 void OAL::Log::writeObserver( OAL::Observer *o ) {
     writer->writeStartElement( "observer" );
-    writer->writeAttribute( "id", o->id() );
+    writer->writeAttribute( "id", writtenId( "observers", o->id() ) );
     writer->writeStartElement( "name" );
     writer->writeCDATA( o->name() );
     writer->writeEndElement();
@@ -204,7 +503,7 @@ void OAL::Log::writeObserver( OAL::Observer *o ) {
 }
 void OAL::Log::writeSite( OAL::Site *s ) {
     writer->writeStartElement( "site" );
-    writer->writeAttribute( "id", s->id() );
+    writer->writeAttribute( "id", writtenId( "sites", s->id() ) );
     writer->writeStartElement( "name" );
     writer->writeCDATA( s->name() );
     writer->writeEndElement();
@@ -219,7 +518,7 @@ void OAL::Log::writeSite( OAL::Site *s ) {
 }
 void OAL::Log::writeSession( OAL::Session *s ) {
     writer->writeStartElement( "session" );
-    writer->writeAttribute( "id", s->id() ); 
+    writer->writeAttribute( "id", writtenId( "sessions", s->id() ) );
     writer->writeStartElement( "begin" );
     writer->writeCharacters( s->begin().date().toString( "yyyy-MM-dd" ) + 'T' + s->begin().time().toString( "hh:mm:ss" ) );
     writer->writeEndElement();
@@ -227,7 +526,7 @@ void OAL::Log::writeSession( OAL::Session *s ) {
     writer->writeCharacters( s->end().date().toString( "yyyy-MM-dd" ) + 'T' + s->end().time().toString( "hh:mm:ss" ) );
     writer->writeEndElement();
     writer->writeStartElement( "site" );
-    writer->writeCharacters( s->site() );
+    writer->writeCharacters( writtenId( "sites", s->site() ) );
     writer->writeEndElement();
     writer->writeStartElement( "weather" );
     writer->writeCDATA( s->weather() );
@@ -242,7 +541,7 @@ void OAL::Log::writeSession( OAL::Session *s ) {
 }
 void OAL::Log::writeScope( OAL::Scope *s ) {
     writer->writeStartElement( "scope" );
-    writer->writeAttribute( "id", s->id() ); 
+    writer->writeAttribute( "id", writtenId( "scopes", s->id() ) );
     writer->writeStartElement( "model" );
     writer->writeCDATA( s->model() );
     writer->writeEndElement();
@@ -270,7 +569,7 @@ void OAL::Log::writeScope( OAL::Scope *s ) {
 }
 void OAL::Log::writeEyepiece( OAL::Eyepiece *ep ) {
     writer->writeStartElement( "eyepiece" );
-    writer->writeAttribute( "id", ep->id() ); 
+    writer->writeAttribute( "id", writtenId( "eyepieces", ep->id() ) );
     writer->writeStartElement( "model" );
     writer->writeCDATA( ep->model() );
     writer->writeEndElement();
@@ -288,7 +587,7 @@ void OAL::Log::writeEyepiece( OAL::Eyepiece *ep ) {
 }
 void OAL::Log::writeLens( OAL::Lens *l ) {
     writer->writeStartElement( "lens" );
-    writer->writeAttribute( "id", l->id() );
+    writer->writeAttribute( "id", writtenId( "lenses", l->id() ) );
     writer->writeStartElement( "model" );
     writer->writeCDATA( l->model() );
     writer->writeEndElement();
@@ -303,7 +602,7 @@ void OAL::Log::writeLens( OAL::Lens *l ) {
 
 void OAL::Log::writeFilter( OAL::Filter *f ) {
     writer->writeStartElement( "filter" );
-    writer->writeAttribute( "id", f->id() );
+    writer->writeAttribute( "id", writtenId( "filters", f->id() ) );
     writer->writeStartElement( "model" );
     writer->writeCDATA( f->model() );
     writer->writeEndElement();
@@ -321,14 +620,15 @@ void OAL::Log::writeFilter( OAL::Filter *f ) {
 
 void OAL::Log::writeObservation( OAL::Observation *o ) {
     writer->writeStartElement( "observation" );
+    writer->writeAttribute( "id", writtenId( "observations", o->id() ) );
     writer->writeStartElement( "observer" );
-    writer->writeCharacters( o->observer() );
+    writer->writeCharacters( writtenId( "observers", o->observer() ) );
     writer->writeEndElement();
     writer->writeStartElement( "site" );
-    writer->writeCharacters( o->site() );
+    writer->writeCharacters( writtenId( "sites", o->site() ) );
     writer->writeEndElement();
     writer->writeStartElement( "session" );
-    writer->writeCharacters( o->session() );
+    writer->writeCharacters( writtenId( "sessions", o->session() ) );
     writer->writeEndElement();
     writer->writeStartElement( "target" );
     writer->writeCharacters( o->target().remove( ' ' ) );
@@ -343,16 +643,16 @@ void OAL::Log::writeObservation( OAL::Observation *o ) {
     writer->writeCharacters( QString::number( o->seeing() ) );
     writer->writeEndElement();
     writer->writeStartElement( "scope" );
-    writer->writeCharacters( o->scope() );
+    writer->writeCharacters( writtenId( "scopes", o->scope() ) );
     writer->writeEndElement();
     writer->writeStartElement( "eyepiece" );
-    writer->writeCharacters( o->eyepiece() );
+    writer->writeCharacters( writtenId( "eyepieces", o->eyepiece() ) );
     writer->writeEndElement();
     writer->writeStartElement( "lens" );
-    writer->writeCharacters( o->lens() );
+    writer->writeCharacters( writtenId( "lenses", o->lens() ) );
     writer->writeEndElement();
     writer->writeStartElement( "filter" );
-    writer->writeCharacters( o->filter() );
+    writer->writeCharacters( writtenId( "filters", o->filter() ) );
     writer->writeEndElement();
     writer->writeStartElement( "result" );
     writer->writeAttribute( "xsi:type", "oal:findingsType" );
@@ -381,7 +681,17 @@ void OAL::Log::writeGeoDate() {
 }
 void OAL::Log::readBegin( QString input ) {
     reader = new QXmlStreamReader( input );
+    readBegin();
+}
+
+void OAL::Log::readBegin( QIODevice *device ) {
+    reader = new QXmlStreamReader( device );
+    readBegin();
+}
+
+void OAL::Log::readBegin() {
     ks = KStars::Instance();
+    m_pendingTargets.clear();
     while( ! reader->atEnd() ) {
         reader->readNext();
         if( reader->isStartElement() ) {
@@ -389,6 +699,40 @@ void OAL::Log::readBegin( QString input ) {
                 readLog();
         }
     }
+    resolveTargets();
+    delete reader;
+    reader = NULL;
+}
+
+void OAL::Log::resolveTargets() {
+    //Look up all the names together, so that the stars are searched once
+    QStringList names;
+    QList<int> lookedUp;
+    for( int i = 0; i < m_pendingTargets.size(); ++i ) {
+        const QString &name = m_pendingTargets.at( i ).name;
+        if( name.isEmpty() || name == "nothing" )
+            continue;
+        names.append( name );
+        lookedUp.append( i );
+    }
+    QList<SkyObject*> found = ks->data()->skyComposite()->findByNames( names );
+    QVector<SkyObject*> objects( m_pendingTargets.size(), NULL );
+    for( int j = 0; j < lookedUp.size(); ++j )
+        objects[ lookedUp.at( j ) ] = found.at( j );
+
+    for( int i = 0; i < m_pendingTargets.size(); ++i ) {
+        const PendingTarget &t = m_pendingTargets.at( i );
+        SkyObject *o = objects.at( i );
+        if( ! o ) o = ks->data()->skyComposite()->findStarByGenetiveName( t.name );
+        if( ! o )
+            continue;
+        targetList()->append( o );
+        if( t.hasTime )
+            TimeHash.insert( o->name(), QTime::fromString( t.time, "h:mm:ss AP" ) );
+        if( t.hasNotes )
+            o->setNotes( t.notes );
+    }
+    m_pendingTargets.clear();
 }
 
 void OAL::Log::readUnknownElement() {
@@ -496,8 +840,8 @@ void OAL::Log::readFilters() {
 }
 
 void OAL::Log::readTarget() {
-    SkyObject *o = NULL;
-    QString name, time, notes;
+    PendingTarget t;
+    t.hasTime = t.hasNotes = false;
     while( ! reader->atEnd() ) {
         reader->readNext();
 
@@ -506,20 +850,13 @@ void OAL::Log::readTarget() {
 
         if( reader->isStartElement() ) {
             if( reader->name() == "name" ) {
-                name = reader->readElementText();
-                if( name != "star" ) {
-                    o = ks->data()->objectNamed( name );
-                    if( ! o ) o = ks->data()->skyComposite()->findStarByGenetiveName( name );
-                    if( o ) targetList()->append( o );
-                }
+                t.name = reader->readElementText();
             } else if( reader->name() == "time" ) {
-                time = reader->readElementText();
-                if( o )
-                    TimeHash.insert( o->name(), QTime::fromString( time, "h:mm:ss AP" ) );
+                t.time = reader->readElementText();
+                t.hasTime = true;
             } else if( reader->name() == "notes" ) {
-                notes = reader->readElementText();
-                if( o )
-                    o->setNotes( notes );
+                t.notes = reader->readElementText();
+                t.hasNotes = true;
             }
        //   else  if( reader->name() == "datasource" )
        //         kDebug() << reader->readElementText();
@@ -531,6 +868,9 @@ void OAL::Log::readTarget() {
                 readUnknownElement();
         }
     }
+    //The targets are looked up when the whole log is read
+    if( t.name != "star" )
+        m_pendingTargets.append( t );
 }
 
 
@@ -694,99 +1034,57 @@ void OAL::Log::readGeoDate() {
 }
 
 OAL::Observer* OAL::Log::findObserverByName( QString name ) {
-    foreach( OAL::Observer *obs, *observerList() )
-        if( QString(obs->name() + ' ' + obs->surname()) == name )
-            return obs;
-    return NULL;
+    return m_observerByName.find( m_observerList, name );
 }
 
 OAL::Observer* OAL::Log::findObserverById( QString id ) {
-    foreach( OAL::Observer *obs, *observerList() )
-        if( obs->id() == id )
-            return obs;
-    return NULL;
+    return m_observerById.find( m_observerList, id );
 }
 
 OAL::Session* OAL::Log::findSessionByName( QString id ) {
-    foreach( OAL::Session *s, *sessionList() )
-        if( s->id()  == id )
-            return s;
-    return NULL;
+    return m_sessionById.find( m_sessionList, id );
 }
 
 OAL::Site* OAL::Log::findSiteById( QString id ) {
-    foreach( OAL::Site *s, *siteList() )
-        if( s->id()  == id )
-            return s;
-    return NULL;
+    return m_siteById.find( m_siteList, id );
 }
 
 OAL::Site* OAL::Log::findSiteByName( QString name ) {
-    foreach( OAL::Site *s, *siteList() )
-        if( s->name()  == name )
-            return s;
-    return NULL;
+    return m_siteByName.find( m_siteList, name );
 }
 
 OAL::Scope* OAL::Log::findScopeById( QString id ) {
-    foreach( OAL::Scope *s, *scopeList() )
-        if( s->id()  == id )
-            return s;
-    return NULL;
+    return m_scopeById.find( m_scopeList, id );
 }
 
 OAL::Eyepiece* OAL::Log::findEyepieceById( QString id ) {
-    foreach( OAL::Eyepiece *e, *eyepieceList() )
-        if( e->id()  == id )
-            return e;
-    return NULL;
+    return m_eyepieceById.find( m_eyepieceList, id );
 }
 
 OAL::Lens* OAL::Log::findLensById( QString id ) {
-    foreach( OAL::Lens *l, *lensList() )
-        if( l->id()  == id )
-            return l;
-    return NULL;
+    return m_lensById.find( m_lensList, id );
 }
 
 OAL::Filter* OAL::Log::findFilterById( QString id ) {
-    foreach( OAL::Filter *f, *filterList() )
-        if( f->id()  == id )
-            return f;
-    return NULL;
+    return m_filterById.find( m_filterList, id );
 }
 
 OAL::Scope* OAL::Log::findScopeByName( QString name ) {
-    foreach( OAL::Scope *s, *scopeList() )
-        if( s->name()  == name )
-            return s;
-    return NULL;
+    return m_scopeByName.find( m_scopeList, name );
 }
 
 OAL::Eyepiece* OAL::Log::findEyepieceByName( QString name ) {
-    foreach( OAL::Eyepiece *e, *eyepieceList() )
-        if( e->name()  == name )
-            return e;
-    return NULL;
+    return m_eyepieceByName.find( m_eyepieceList, name );
 }
 
 OAL::Filter* OAL::Log::findFilterByName( QString name ) {
-    foreach( OAL::Filter *f, *filterList() )
-        if( f->name()  == name )
-            return f;
-    return NULL;
+    return m_filterByName.find( m_filterList, name );
 }
 
 OAL::Lens* OAL::Log::findLensByName( QString name ) {
-    foreach( OAL::Lens *l, *lensList() )
-        if( l->name()  == name )
-            return l;
-    return NULL;
+    return m_lensByName.find( m_lensList, name );
 }
 
 OAL::Observation* OAL::Log::findObservationByName( QString id ) {
-    foreach( OAL::Observation *o, *observationList() )
-        if( o->id()  == id )
-            return o;
-    return NULL;
+    return m_observationById.find( m_observationList, id );
 }
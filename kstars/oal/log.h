@@ -20,7 +20,10 @@
 
 #include "oal/oal.h"
 
+#include <QHash>
+#include <QSet>
 #include <QString>
+#include <QStringList>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
@@ -37,10 +40,27 @@
 #include "oal/observation.h"
 
 class KStars;
+class QIODevice;
 
 class OAL::Log {
     public:
+        Log();
         QString writeLog( bool native = true );
+        /**@short Writes the log to device as it is generated, without
+         * building the document in memory first.
+         */
+        void writeLog( QIODevice *device, bool native = true );
+        /**@short Adds this log to the OAL log in fileName.
+         * The file is copied in one streaming pass, and the entries of
+         * this log are inserted at the end of their sections. An entry
+         * whose id is already taken in the file gets a new id, and the
+         * references to it are written with that id; targets already in
+         * the file are not written again. Sections the file lacks are
+         * inserted in schema order, before the first observation, and the
+         * observations go at the end, as the OAL schema requires.
+         * @return false if the file could not be read or written
+         */
+        bool appendLog( const QString &fileName, bool native = true );
         void writeBegin();
         void writeGeoDate();
         void writeObservers();
@@ -74,6 +94,10 @@ class OAL::Log {
 //        void writeImager();
         void writeEnd();
         void readBegin( QString input );
+        /**@short Reads the log from device as a stream; the targets are
+         * looked up together once the whole log has been read.
+         */
+        void readBegin( QIODevice *device );
         void readLog();
         void readUnknownElement();
         void readTargets();
@@ -110,6 +134,54 @@ class OAL::Log {
         GeoLocation* geoLocation() { return geo; }
         inline QString writtenOutput() const { return output; }
     private:
+        /**@short Finds the entries of a list by a key, such as the id or the
+         * name. The position of each key is remembered and checked on every
+         * hit. The index is rebuilt when the check fails or when the list
+         * changed, which is noticed by its size and its first and last
+         * entries, so the lists may still be changed directly. A miss on an
+         * unchanged list costs a single hash lookup.
+         */
+        template <class T> class ListIndex {
+            public:
+                typedef QString (*KeyFunction)( const T* );
+                explicit ListIndex( KeyFunction key ) : m_key( key ), m_size( -1 ), m_first( NULL ), m_last( NULL ) {}
+                T* find( const QList<T*> &list, const QString &key );
+            private:
+                bool changed( const QList<T*> &list ) const;
+                void rebuild( const QList<T*> &list );
+                KeyFunction m_key;
+                int m_size;
+                const T *m_first, *m_last;   ///< only compared, never used
+                QHash<QString, int> m_positions;
+        };
+
+        /**@short A target read from a log, looked up when the whole log is read */
+        struct PendingTarget {
+            QString name, time, notes;
+            bool hasTime, hasNotes;
+        };
+
+        void readBegin();
+        void resolveTargets();
+        void writeStart();
+        void writeContents();
+        /**@short Writes the entries of this log for section that are not in
+         * existing, which maps the ids of the entries in the file to their content */
+        void writeNewEntries( const QString &section, const QHash<QString, QString> &existing );
+        /**@short Writes the entries of list with write that are not in existing.
+         * An entry whose id is in existing with other content gets a new id,
+         * and entries of a section in m_referencedIds are only written if referenced. */
+        template <class T>
+        void writeNewEntries( const QList<T*> &list, QString (*id)( const T* ), void (OAL::Log::*write)( T* ),
+                              const QString &section, const QHash<QString, QString> &existing );
+        /**@return the entry t as written by write, in the form existing entries are compared in */
+        template <class T>
+        QString canonicalEntry( T *t, void (OAL::Log::*write)( T* ) );
+        /**@short Writes the sections before the one at index before that are not in written */
+        void writeMissingSections( const QStringList &sections, int before, QSet<QString> *written );
+        /**@return the id to write for the entry of section with id */
+        QString writtenId( const QString &section, const QString &id ) const;
+
         QList<SkyObject *> m_targetList;
         QList<OAL::Observer *> m_observerList;
         QList<OAL::Eyepiece *> m_eyepieceList; 
@@ -130,5 +202,16 @@ class OAL::Log {
         QHash<QString, QTime> TimeHash;
         KStarsDateTime dt;
         GeoLocation *geo;
+        QList<PendingTarget> m_pendingTargets;
+        QHash<QString, QHash<QString, QString> > m_renamedIds;   ///< section -> ids renamed by appendLog()
+        QHash<QString, QSet<QString> > m_referencedIds;         ///< section -> ids appendLog() adds entries for
+        ListIndex<OAL::Observer> m_observerById, m_observerByName;
+        ListIndex<OAL::Site> m_siteById, m_siteByName;
+        ListIndex<OAL::Session> m_sessionById;
+        ListIndex<OAL::Scope> m_scopeById, m_scopeByName;
+        ListIndex<OAL::Eyepiece> m_eyepieceById, m_eyepieceByName;
+        ListIndex<OAL::Lens> m_lensById, m_lensByName;
+        ListIndex<OAL::Filter> m_filterById, m_filterByName;
+        ListIndex<OAL::Observation> m_observationById;
 };
 #endif
@@ -59,12 +59,22 @@ public:
     /** Update cached values for projector */
     void setViewParams( const ViewParams& p );
 
+    /** Return the ViewParams of this projection */
+    ViewParams viewParams() const { return m_vp; }
+
     /** Return the type of this projection */
     virtual SkyMap::Projection type() const = 0;
 
     /** Return the FOV of this projection */
     double fov() const;
 
+    /** This function returns the cosine of the maximum field angle,
+        i.e., the maximum angular distance from the focus for
+        which a point should be projected.
+        Default is 0, i.e., 90 degrees.
+        */
+    virtual double cosMaxFieldAngle() const { return 0; }
+
     /**Check if the current point on screen is a valid point on the sky. This is needed
         *to avoid a crash of the program if the user clicks on a point outside the sky (the
         *corners of the sky map at the lowest zoom level are the invalid points).
@@ -211,13 +221,6 @@ protected:
         */
     virtual double projectionL(double x) const { return x; }
 
-    /** This function returns the cosine of the maximum field angle,
-        i.e., the maximum angular distance from the focus for
-        which a point should be projected.
-        Default is 0, i.e., 90 degrees.
-        */
-    virtual double cosMaxFieldAngle() const { return 0; }
-
     /** Helper function for drawing ground.
         @return the point with Alt = 0, az = @p az
         */
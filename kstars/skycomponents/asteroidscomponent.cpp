@@ -26,6 +26,7 @@
 #include "Options.h"
 #include "skyobjects/ksasteroid.h"
 #include "kstarsdata.h"
+#include "ksnumbers.h"
 #include "ksfilereader.h"
 #include <kdebug.h>
 #include <kglobal.h>
@@ -34,15 +35,26 @@
 #include <kio/jobuidelegate.h>
 #include <kstandarddirs.h>
 #include <QPen>
+#include <QtAlgorithms>
+
+#include <limits>
+
+namespace {
+    // The most asteroids brighterThan() creates in one call
+    const int MaxQueryAsteroids = 5000;
+}
 
 
 AsteroidsComponent::AsteroidsComponent(SolarSystemComposite *parent)
-    : SolarSystemListComponent(parent) {
+    : SolarSystemListComponent(parent), m_skipLimit( 0.0 ),
+      m_materializedLimit( -std::numeric_limits<double>::infinity() ) {
     loadData();
 }
 
 AsteroidsComponent::~AsteroidsComponent()
-{}
+{
+    qDeleteAll( m_retired );
+}
 
 bool AsteroidsComponent::selected() {
     return Options::showAsteroids();
@@ -78,18 +90,18 @@ bool AsteroidsComponent::selected() {
  * @li 23 orbit classification [string]
  */
 void AsteroidsComponent::loadData() {
-    QString name, full_name, orbit_id, orbit_class, dimensions;
-    int mJD;
-    double q, a, e, dble_i, dble_w, dble_N, dble_M, H, G, earth_moid;
-    long double JD;
-    float diameter, albedo, rot_period, period;
-    bool neo;
+    QString full_name;
+    MinorBodyStore::Elements el;
 
     emitProgressText( i18n("Loading asteroids") );
 
-    // Clear lists
-    m_ObjectList.clear();
+    // Clear lists. The names go first, so that the asteroids need not be
+    // looked up in them one by one. The old asteroids may still be focused
+    // or on the observing list, so they are kept until the end.
     objectNames( SkyObject::ASTEROID ).clear();
+    m_retired += m_ObjectList;
+    m_ObjectList.clear();
+    m_store.clear();
 
     QList< QPair<QString, KSParser::DataTypes> > sequence;
     sequence.append(qMakePair(QString("full name"), KSParser::D_QSTRING));
@@ -125,58 +137,168 @@ void AsteroidsComponent::loadData() {
         row_content = asteroid_parser.ReadNextRow();
         full_name = row_content["full name"].toString();
         full_name = full_name.trimmed();
-        int catN  = full_name.section(' ', 0, 0).toInt();
-        name = full_name.section(' ', 1, -1);
-        mJD  = row_content["epoch_mjd"].toInt();
-        q    = row_content["q"].toDouble();
-        a    = row_content["a"].toDouble();
-        e    = row_content["e"].toDouble();
-        dble_i = row_content["i"].toDouble();
-        dble_w = row_content["w"].toDouble();
-        dble_N = row_content["om"].toDouble();
-        dble_M = row_content["ma"].toDouble();
-        orbit_id = row_content["orbit_id"].toString();
-        H   = row_content["H"].toDouble();
-        G   = row_content["G"].toDouble();
-        neo = row_content["neo"].toString() == "Y";
-        diameter = row_content["diameter"].toFloat();
-        dimensions = row_content["extent"].toString();
-        albedo  = row_content["albedo"].toFloat();
-        rot_period = row_content["rot_period"].toFloat();
-        period  = row_content["per_y"].toFloat();
-        earth_moid  = row_content["moid"].toDouble();
-        orbit_class = row_content["class"].toString();
-
-        JD = static_cast<double>(mJD) + 2400000.5;
-
-        KSAsteroid *new_asteroid = new KSAsteroid( catN, name, QString(), JD,
-                                          a, e,
-                                          dms(dble_i), dms(dble_w),
-                                          dms(dble_N), dms(dble_M),
-                                          H, G );
-        new_asteroid->setPerihelion(q);
-        new_asteroid->setOrbitID(orbit_id);
-        new_asteroid->setNEO(neo);
-        new_asteroid->setDiameter(diameter);
-        new_asteroid->setDimensions(dimensions);
-        new_asteroid->setAlbedo(albedo);
-        new_asteroid->setRotationPeriod(rot_period);
-        new_asteroid->setPeriod(period);
-        new_asteroid->setEarthMOID(earth_moid);
-        new_asteroid->setOrbitClass(orbit_class);
-        new_asteroid->setAngularSize(0.005);
-        m_ObjectList.append(new_asteroid);
+        el.catN = full_name.section(' ', 0, 0).toInt();
+        el.name = full_name.section(' ', 1, -1);
+        el.JD   = static_cast<double>( row_content["epoch_mjd"].toInt() ) + 2400000.5;
+        el.q    = row_content["q"].toDouble();
+        el.a    = row_content["a"].toDouble();
+        el.e    = row_content["e"].toDouble();
+        el.i    = row_content["i"].toDouble();
+        el.w    = row_content["w"].toDouble();
+        el.N    = row_content["om"].toDouble();
+        el.M    = row_content["ma"].toDouble();
+        el.orbitID = row_content["orbit_id"].toString();
+        el.H    = row_content["H"].toDouble();
+        el.G    = row_content["G"].toDouble();
+        el.neo  = row_content["neo"].toString() == "Y";
+        el.diameter   = row_content["diameter"].toDouble();
+        el.dimensions = row_content["extent"].toString();
+        el.albedo     = row_content["albedo"].toDouble();
+        el.rotationPeriod = row_content["rot_period"].toDouble();
+        el.period     = row_content["per_y"].toDouble();
+        el.earthMOID  = row_content["moid"].toDouble();
+        el.orbitClass = row_content["class"].toString();
+        m_store.append( el );
 
         // Add name to the list of object names
-        objectNames(SkyObject::ASTEROID).append(name);
+        objectNames(SkyObject::ASTEROID).append(el.name);
     }
+
+    // The KSAsteroid objects are created by materialize() and proxy()
+    m_proxies.fill( 0, m_store.size() );
+    m_materializedLimit = -std::numeric_limits<double>::infinity();
 }
 
+KSAsteroid* AsteroidsComponent::proxy( int row )
+{
+    if ( ! m_proxies[row] ) {
+        m_proxies[row] = m_store.createAsteroid( row );
+        m_ObjectList.append( m_proxies[row] );
+    }
+    return m_proxies[row];
+}
+
+void AsteroidsComponent::materialize( double limit )
+{
+    if ( limit <= m_materializedLimit )
+        return;
+    for ( int row = 0; row < m_store.size(); ++row ) {
+        if ( ! m_proxies[row] && m_store.brightestMagnitude( row ) <= limit )
+            proxy( row );
+    }
+    m_materializedLimit = limit;
+}
+
+void AsteroidsComponent::updatePlanets( KSNumbers *num )
+{
+    m_skipLimit = Options::magLimitAsteroid();
+    materialize( m_skipLimit );
+    SolarSystemListComponent::updatePlanets( num );
+}
+
+bool AsteroidsComponent::skipUpdate( KSPlanetBase *p, const KSNumbers *num )
+{
+    KSAsteroid *ast = (KSAsteroid*) p;
+    double bound = ast->brightestMagnitude( num->julianDay() );
+    if ( bound <= m_skipLimit )
+        return false;
+    ast->setMagnitudeBound( bound );
+    return true;
+}
+
+void AsteroidsComponent::updateSkipped( KSNumbers *num )
+{
+    m_skipLimit = Options::magLimitAsteroid();
+    materialize( m_skipLimit );
+
+    QVector<KSPlanetBase*> bodies;
+    foreach ( SkyObject *so, m_ObjectList ) {
+        KSAsteroid *ast = (KSAsteroid*) so;
+        if ( ast->solvedJD() != num->julianDay() && ! skipUpdate( ast, num ) )
+            bodies.append( ast );
+    }
+    updateBodies( bodies, num );
+}
+
+QList<SkyObject*> AsteroidsComponent::brighterThan( double magLimit )
+{
+    KSNumbers *num = KStarsData::Instance()->updateNum();
+    QVector<KSPlanetBase*> bodies;
+    QList<SkyObject*> result;
+
+    // Asteroids the sky map created already
+    foreach ( SkyObject *so, m_ObjectList ) {
+        KSAsteroid *ast = (KSAsteroid*) so;
+        if ( ast->solvedJD() == 0 ) {
+            bodies.append( ast );
+            result.append( ast );
+        }
+        else if ( ast->magnitudeBound() == -std::numeric_limits<double>::infinity() )
+            result.append( ast );
+        else if ( ast->brightestMagnitude( num->julianDay() ) <= magLimit ) {
+            bodies.append( ast );
+            result.append( ast );
+        }
+    }
+
+    // The others are picked from the magnitude column of the store, the
+    // brightest first, so a faint limit can not create every asteroid
+    QVector< QPair<double, int> > rows;
+    for ( int row = 0; row < m_store.size(); ++row ) {
+        if ( ! m_proxies[row] && m_store.brightestMagnitude( row ) <= magLimit )
+            rows.append( qMakePair( m_store.brightestMagnitude( row ), row ) );
+    }
+    if ( rows.size() > MaxQueryAsteroids ) {
+        qSort( rows );
+        rows.resize( MaxQueryAsteroids );
+    }
+
+    QVector<KSAsteroid*> created;
+    created.reserve( rows.size() );
+    for ( int i = 0; i < rows.size(); ++i ) {
+        created.append( m_store.createAsteroid( rows[i].second ) );
+        bodies.append( created.last() );
+    }
+    updateBodies( bodies, num );
+
+    // Keep only those that are bright enough now; the caller may hold them
+    for ( int i = 0; i < created.size(); ++i ) {
+        KSAsteroid *ast = created[i];
+        if ( ast->mag() <= magLimit ) {
+            m_proxies[ rows[i].second ] = ast;
+            m_ObjectList.append( ast );
+            result.append( ast );
+        } else {
+            delete ast;
+        }
+    }
+    return result;
+}
+
+SkyObject* AsteroidsComponent::findByName( const QString &name )
+{
+    // An asteroid is created and computed when it is looked up
+    int row = m_store.find( name );
+    if ( row < 0 )
+        return SolarSystemListComponent::findByName( name );
+    KSAsteroid *ast = proxy( row );
+    KSNumbers *num = KStarsData::Instance()->updateNum();
+    if ( ast->solvedJD() != num->julianDay() ) {
+        QVector<KSPlanetBase*> bodies;
+        bodies.append( ast );
+        updateBodies( bodies, num );
+    }
+    return ast;
+}
 
 void AsteroidsComponent::draw( SkyPainter *skyp )
 {
     if ( ! selected() ) return;
 
+    // Asteroids skipped against a brighter limit may be visible now
+    if ( Options::magLimitAsteroid() > m_skipLimit )
+        updateSkipped( KStarsData::Instance()->updateNum() );
+
     bool hideLabels =  ! Options::showAsteroidNames() ||
                        ( SkyMap::Instance()->isSlewing() && Options::hideLabels() );
 
@@ -194,6 +316,7 @@ void AsteroidsComponent::draw( SkyPainter *skyp )
         // FIXME: God help us!
         KSAsteroid *ast = (KSAsteroid*) so;
 
+        if ( ast->magnitudeBound() > Options::magLimitAsteroid() ) continue;
         if ( ast->mag() > Options::magLimitAsteroid() ) continue;
 
         bool drawn = skyp->drawPointSource(ast,ast->mag());
@@ -209,6 +332,8 @@ SkyObject* AsteroidsComponent::objectNearest( SkyPoint *p, double &maxrad ) {
     if ( ! selected() ) return 0;
 
     foreach ( SkyObject *o, m_ObjectList ) {
+        KSAsteroid *ast = (KSAsteroid*) o;
+        if ( ast->magnitudeBound() > Options::magLimitAsteroid() ) continue;
         if ( o->mag() > Options::magLimitAsteroid() ) continue;
 
         double r = o->angularDistanceTo( p ).Degrees();
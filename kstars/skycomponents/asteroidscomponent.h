@@ -19,13 +19,21 @@
 #define ASTEROIDSCOMPONENT_H
 
 #include "solarsystemlistcomponent.h"
+#include "minorbodystore.h"
 #include "datahandlers/ksparser.h"
 #include <QList>
+#include <QVector>
 #include "typedef.h"
 
 /**@class AsteroidsComponent
  * Represents the asteroids on the sky map.
  *
+ * The asteroids are kept in a MinorBodyStore. A KSAsteroid is only created
+ * for an asteroid that can reach the magnitude limit, that is looked up
+ * by name or that another tool asks for through brighterThan(), so the
+ * object list holds just those; the names of all asteroids are still known
+ * to the find dialog.
+ *
  * @author Thomas Kabelmann
  * @version 0.1
  */
@@ -40,11 +48,50 @@ public:
     virtual ~AsteroidsComponent();
     virtual void draw( SkyPainter *skyp );
     virtual bool selected();
+    virtual void updatePlanets( KSNumbers *num );
+    virtual SkyObject* findByName( const QString &name );
     virtual SkyObject* objectNearest( SkyPoint *p, double &maxrad );
     void updateDataFile();
+
+    /**@return the asteroids that may be brighter than magLimit. Those not
+     * computed yet because the sky map did not need them are computed for
+     * the current time, so the position and magnitude of every returned
+     * asteroid are current. Asteroids the sky map did not create are
+     * picked from the store, at most a few thousand of the brightest,
+     * and kept only if they are brighter than magLimit now.
+     */
+    QList<SkyObject*> brighterThan( double magLimit );
     QString ans();
+
+protected:
+    /**@short Skips asteroids that can not reach the magnitude limit.
+     *
+     * A skipped asteroid keeps its last position and magnitude and gets a
+     * magnitude bound instead, which keeps the sky map from drawing or
+     * picking it. Other users get it computed through brighterThan().
+     */
+    virtual bool skipUpdate( KSPlanetBase *p, const KSNumbers *num );
+
 private:
     void loadData();
+
+    /**@short Computes the skipped asteroids that may now be bright enough */
+    void updateSkipped( KSNumbers *num );
+
+    /**@return the KSAsteroid of row in the store, created if needed */
+    KSAsteroid* proxy( int row );
+
+    /**@short Creates the KSAsteroid of every stored asteroid that can
+     * reach magnitude limit
+     */
+    void materialize( double limit );
+
+    double m_skipLimit; ///< magnitude limit the last update skipped against
+
+    MinorBodyStore m_store;
+    QVector<KSAsteroid*> m_proxies;  ///< by row, 0 if not created yet
+    double m_materializedLimit;      ///< limit the last materialize() scanned for
+    QList<SkyObject*> m_retired;     ///< asteroids of a replaced data file
 };
 
 #endif
@@ -17,6 +17,7 @@
 
 #include "constellationboundarylines.h"
 
+#include <cmath>
 #include <cstdio>
 
 #include <QPen>
@@ -88,8 +89,10 @@ ConstellationBoundaryLines::ConstellationBoundaryLines( SkyComposite *parent )
             if ( lineList ) appendLine( lineList );
             lineList = 0;
 
-            if ( polyList )
+            if ( polyList ) {
+                m_polyLists.append( polyList );
                 appendPoly( polyList, idxFile, verbose );
+            }
             QString cName = line.mid(1);
             polyList = new PolyList( cName );
             if ( verbose == -1 ) printf(":\n");
@@ -141,8 +144,12 @@ ConstellationBoundaryLines::ConstellationBoundaryLines( SkyComposite *parent )
 
     if( lineList )
         appendLine( lineList );
-    if( polyList )
+    if( polyList ) {
+        m_polyLists.append( polyList );
         appendPoly( polyList, idxFile, verbose );
+    }
+
+    buildCellTable();
 }
 
 bool ConstellationBoundaryLines::selected()
@@ -252,15 +259,102 @@ PolyList* ConstellationBoundaryLines::ContainingPoly( SkyPoint *p )
     return 0;
 }
 
+void ConstellationBoundaryLines::buildCellTable()
+{
+    const double raStep  = 24.0 / RACells;
+    const double decStep = 180.0 / DecCells;
+    const double eps = 1e-6;
+
+    // Mark every cell that the bounding box of a boundary edge touches
+    m_cells.fill( NoCell, RACells * DecCells );
+    foreach ( PolyList *polyList, m_polyLists ) {
+        const QPolygonF *poly = polyList->poly();
+        int n = poly->size();
+        for ( int i = 0; i < n; i++ ) {
+            const QPointF &a = poly->at( i );
+            const QPointF &b = poly->at( ( i + 1 ) % n );
+            int ra0  = (int) floor( ( qMin( a.x(), b.x() ) - eps ) / raStep );
+            int ra1  = (int) floor( ( qMax( a.x(), b.x() ) + eps ) / raStep );
+            int dec0 = qBound( 0, (int) floor( ( qMin( a.y(), b.y() ) + 90.0 - eps ) / decStep ), DecCells - 1 );
+            int dec1 = qBound( 0, (int) floor( ( qMax( a.y(), b.y() ) + 90.0 + eps ) / decStep ), DecCells - 1 );
+            for ( int r = ra0; r <= ra1; r++ ) {
+                int col = ( ( r % RACells ) + RACells ) % RACells;      // wrapped boundaries have RA < 0
+                for ( int row = dec0; row <= dec1; row++ )
+                    m_cells[ row * RACells + col ] = BoundaryCell;
+            }
+        }
+    }
+
+    // No boundary passes through a connected group of the other cells, so
+    // one polygon test gives the constellation of the whole group.  Groups
+    // do not reach across 0h and 12h, where ContainingPoly() switches between
+    // wrapped and plain RA.
+    QHash<PolyList*, int> polyIndex;
+    for ( int i = 0; i < m_polyLists.size(); i++ )
+        polyIndex.insert( m_polyLists[i], i );
+
+    QVector<bool> done( m_cells.size(), false );
+    QVector<int> stack;
+    for ( int start = 0; start < m_cells.size(); start++ ) {
+        if ( done[ start ] || m_cells[ start ] == BoundaryCell )
+            continue;
+
+        SkyPoint center( ( start % RACells + 0.5 ) * raStep, ( start / RACells + 0.5 ) * decStep - 90.0 );
+        PolyList *polyList = ContainingPoly( &center );
+        uchar value = ( polyList && polyIndex.contains( polyList ) ) ? polyIndex.value( polyList ) : NoCell;
+
+        stack.append( start );
+        done[ start ] = true;
+        while ( ! stack.isEmpty() ) {
+            int cell = stack.last();
+            stack.pop_back();
+            m_cells[ cell ] = value;
+
+            int col = cell % RACells;
+            int row = cell / RACells;
+            int neighbors[4] = { -1, -1, -1, -1 };
+            if ( col > 0 && col != RACells / 2 )
+                neighbors[0] = cell - 1;
+            if ( col < RACells - 1 && col != RACells / 2 - 1 )
+                neighbors[1] = cell + 1;
+            if ( row > 0 )
+                neighbors[2] = cell - RACells;
+            if ( row < DecCells - 1 )
+                neighbors[3] = cell + RACells;
+            for ( int i = 0; i < 4; i++ ) {
+                int next = neighbors[i];
+                if ( next >= 0 && ! done[ next ] && m_cells[ next ] != BoundaryCell ) {
+                    done[ next ] = true;
+                    stack.append( next );
+                }
+            }
+        }
+    }
+}
+
+PolyList* ConstellationBoundaryLines::lookup( SkyPoint *p )
+{
+    if ( m_cells.isEmpty() || m_polyLists.size() >= NoCell )
+        return ContainingPoly( p );
+
+    int col = qBound( 0, (int) ( p->ra().Hours() * RACells / 24.0 ), RACells - 1 );
+    int row = qBound( 0, (int) ( ( p->dec().Degrees() + 90.0 ) * DecCells / 180.0 ), DecCells - 1 );
+    uchar value = m_cells[ row * RACells + col ];
+    if ( value == BoundaryCell )
+        return ContainingPoly( p );
+    if ( value == NoCell )
+        return 0;
+    return m_polyLists[ value ];
+}
+
 
 //-------------------------------------------------------------------
 // The routines for providing public access to the boundary index
 // start here.  (Some of them may not be needed (or working)).
 //-------------------------------------------------------------------
 
-QString ConstellationBoundaryLines::constellationName( SkyPoint *p )
+QString ConstellationBoundaryLines::polyName( PolyList *polyList ) const
 {
-    PolyList *polyList = ContainingPoly( p );
     if ( polyList ) {
         return ( Options::useLocalConstellNames() ?
                  i18nc( "Constellation name (optional)", polyList->name().toUpper().toLocal8Bit().data() ) :
@@ -268,3 +362,23 @@ QString ConstellationBoundaryLines::constellationName( SkyPoint *p )
     }
     return i18n("Unknown");
 }
+
+QString ConstellationBoundaryLines::constellationName( SkyPoint *p )
+{
+    return polyName( lookup( p ) );
+}
+
+QStringList ConstellationBoundaryLines::constellationNames( const QList<SkyPoint*> &points )
+{
+    // Translate each name once
+    QHash<PolyList*, QString> names;
+    QStringList result;
+    foreach ( SkyPoint *p, points ) {
+        PolyList *polyList = lookup( p );
+        QHash<PolyList*, QString>::const_iterator iter = names.constFind( polyList );
+        if ( iter == names.constEnd() )
+            iter = names.insert( polyList, polyName( polyList ) );
+        result.append( iter.value() );
+    }
+    return result;
+}
@@ -22,6 +22,7 @@
 
 #include <QHash>
 #include <QPolygonF>
+#include <QStringList>
 
 class PolyList;
 class ConstellationBoundary;
@@ -56,6 +57,11 @@ public:
 
     QString constellationName( SkyPoint *p );
 
+    /**@short Finds the constellations of many points at once.
+     * @return the constellation names, in the order of points
+     */
+    QStringList constellationNames( const QList<SkyPoint*> &points );
+
     virtual bool selected();
 
     virtual void preDraw( SkyPainter *skyp );
@@ -70,9 +76,32 @@ private:
 
     PolyList* ContainingPoly( SkyPoint *p );
 
+    /* @short fills m_cells.  Cells no boundary passes through get the
+     * constellation found by ContainingPoly() at one cell of each connected
+     * group of such cells; the others are marked BoundaryCell.
+     */
+    void buildCellTable();
+
+    /* @short returns the constellation containing p, from the cell table
+     * where possible and from the polygons near boundaries.
+     */
+    PolyList* lookup( SkyPoint *p );
+
+    /* @short returns the (possibly localized) name of polyList */
+    QString polyName( PolyList *polyList ) const;
+
     SkyMesh*   m_skyMesh;
     PolyIndex  m_polyIndex;
     int        m_polyIndexCnt;
+
+    // A grid in RA and Dec, since the boundaries are polygons in RA and Dec
+    enum { RACells  = 384,               // 1/16 hour
+           DecCells = 360 };             // 1/2 degree
+    enum { NoCell = 254,                 // in no constellation
+           BoundaryCell = 255 };         // a boundary passes through
+
+    QVector<PolyList*> m_polyLists;      // all boundaries, in file order
+    QVector<uchar>     m_cells;          // index into m_polyLists, by Dec row then RA
 };
 
 
@@ -362,6 +362,9 @@ void DeepSkyComponent::appendIndex( DeepSkyObject *o, DeepSkyIndex* dsIndex, Tri
 
 void DeepSkyComponent::draw( SkyPainter *skyp )
 {
+    for ( int i = 0; i <= MAX_LINENUMBER_MAG; i++ )
+        m_labelList[ i ]->clear();
+
     if ( ! selected() ) return;
 
     bool drawFlag;
@@ -476,6 +479,7 @@ void DeepSkyComponent::drawLabels()
 
     SkyLabeler *labeler = SkyLabeler::Instance();
     labeler->setPen( QColor( KStarsData::Instance()->colorScheme()->colorNamed( "DSNameColor" ) ) );
+    const Projector *proj = SkyMap::Instance()->projector();
 
     int max = int( m_zoomMagLimit * 10.0 );
     if ( max < 0 ) max = 0;
@@ -484,9 +488,11 @@ void DeepSkyComponent::drawLabels()
     for ( int i = 0; i <= max; i++ ) {
         LabelList* list = m_labelList[ i ];
         for ( int j = 0; j < list->size(); j++ ) {
+            // the object may have set since it was drawn into a cached layer
+            if ( ! proj->checkVisibility( list->at(j).obj ) )
+                continue;
             labeler->drawNameLabel(list->at(j).obj, list->at(j).o);
         }
-        list->clear();
     }
 
 }
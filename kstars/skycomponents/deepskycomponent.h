@@ -62,8 +62,9 @@ public:
 
     virtual void draw( SkyPainter *skyp );
 
-    /* @short draw all the labels in the prioritized LabelLists and then
-     * clear the LabelLists.
+    /* @short draw all the labels in the prioritized LabelLists.  The
+     * LabelLists are cleared by draw() so the labels of a cached sky layer
+     * can be drawn again without redrawing the objects.
      */
     void drawLabels();
 
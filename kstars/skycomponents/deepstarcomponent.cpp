@@ -43,6 +43,8 @@
 
 DeepStarComponent::DeepStarComponent( SkyComposite *parent, QString fileName, float trigMag, bool staticstars ) :
     ListComponent(parent),
+    m_drawAperture( 0 ),
+    m_searchBuffer( 0 ),
     m_reindexNum( J2000 ),
     triggerMag( trigMag ),
     m_FaintMagnitude(-5.0), 
@@ -150,6 +152,8 @@ DeepStarComponent::~DeepStarComponent() {
   if( fileOpened )
     starReader.closeFile();
   fileOpened = false;
+  delete m_drawAperture;
+  delete m_searchBuffer;
 }
 
 bool DeepStarComponent::selected() {
@@ -182,9 +186,6 @@ void DeepStarComponent::draw( SkyPainter *skyp ) {
     float radius = map->projector()->fov();
     if ( radius > 90.0 ) radius = 90.0;
 
-    if ( m_skyMesh != SkyMesh::Instance() && m_skyMesh->inDraw() ) {
-        printf("Warning: aborting concurrent DeepStarComponent::draw()");
-    }
     bool checkSlewing = ( map->isSlewing() && Options::hideOnSlew() );
 
     //shortcuts to inform whether to draw different objects
@@ -204,12 +205,10 @@ void DeepStarComponent::draw( SkyPainter *skyp ) {
 
     m_zoomMagLimit = maglim;
 
-    m_skyMesh->inDraw( true );
-
     SkyPoint* focus = map->focus();
-    m_skyMesh->aperture( focus, radius + 1.0, DRAW_BUF ); // divide by 2 for testing
+    m_skyMesh->aperture( m_drawAperture, focus, radius + 1.0 ); // divide by 2 for testing
 
-    MeshIterator region(m_skyMesh, DRAW_BUF);
+    MeshIterator region( m_drawAperture->visible() );
 
     magLim = maglim;
 
@@ -301,8 +300,6 @@ void DeepStarComponent::draw( SkyPainter *skyp ) {
         t_drawUnnamed += t.restart();
 
     }
-    m_skyMesh->inDraw( false );
-
 }
 
 bool DeepStarComponent::openDataFile() {
@@ -336,6 +333,10 @@ bool DeepStarComponent::openDataFile() {
             }
         }
         meshLevel = htm_level;
+        delete m_drawAperture;
+        m_drawAperture = new MeshAperture( m_skyMesh );
+        delete m_searchBuffer;
+        m_searchBuffer = new MeshBuffer( m_skyMesh );
         fread( &MSpT, 2, 1, starReader.getFileHandle() );
         if( starReader.getByteSwap() )
             MSpT = bswap_16( MSpT );
@@ -374,9 +375,9 @@ SkyObject* DeepStarComponent::objectNearest( SkyPoint *p, double &maxrad )
     if( !fileOpened )
         return NULL;
 
-    m_skyMesh->index( p, maxrad + 1.0, OBJ_NEAREST_BUF);
+    m_skyMesh->index( m_searchBuffer, p, maxrad + 1.0 );
 
-    MeshIterator region( m_skyMesh, OBJ_NEAREST_BUF );
+    MeshIterator region( m_searchBuffer );
 
     while ( region.hasNext() ) {
         Trixel currentRegion = region.next();
@@ -422,9 +423,9 @@ bool DeepStarComponent::starsInAperture( QList<StarObject *> &list, const SkyPoi
     Q_ASSERT( center.ra0().Degrees() >= 0.0 );
     Q_ASSERT( center.dec0().Degrees() <= 90.0 );
 
-    m_skyMesh->intersect( center.ra0().Degrees(), center.dec0().Degrees(), radius, (BufNum) OBJ_NEAREST_BUF );
+    m_skyMesh->intersect( m_searchBuffer, center.ra0().Degrees(), center.dec0().Degrees(), radius );
 
-    MeshIterator region( m_skyMesh, OBJ_NEAREST_BUF );
+    MeshIterator region( m_searchBuffer );
 
     if( maglim < -28 )
         maglim = m_FaintMagnitude;
@@ -40,6 +40,8 @@
 #include "starblocklist.h"
 
 class SkyMesh;
+class MeshAperture;
+class MeshBuffer;
 class StarObject;
 class SkyLabeler;
 class BinFileHelper;
@@ -119,6 +121,8 @@ public:
 
 private:
     SkyMesh*       m_skyMesh;
+    MeshAperture*  m_drawAperture;   // Trixels visible in draw(), our own so we don't clobber DRAW_BUF
+    MeshBuffer*    m_searchBuffer;   // Trixels searched by objectNearest() and starsInAperture()
     KSNumbers      m_reindexNum;
     int            meshLevel;
 
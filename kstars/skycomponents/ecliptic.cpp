@@ -73,6 +73,14 @@ void Ecliptic::draw( SkyPainter *skyp )
 
     m_label.reset();
     drawLines( skyp );
+}
+
+void Ecliptic::drawLabels()
+{
+    if ( ! selected() ) return;
+
+    KStarsData *data = KStarsData::Instance();
+    QColor color( data->colorScheme()->colorNamed( "EclColor" ) );
     SkyLabeler::Instance()->setPen( QPen( QBrush( color ), 1, Qt::SolidLine ) );
     m_label.draw();
 
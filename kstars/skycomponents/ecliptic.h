@@ -39,6 +39,10 @@ public:
     explicit Ecliptic( SkyComposite *parent );
 
     virtual void draw( SkyPainter *skyp );
+    /* @short draws the line label found by the last draw() and the
+     * compass labels.  Kept apart from draw() so the lines can be cached.
+     */
+    void drawLabels();
     virtual void drawCompassLabels();
     virtual bool selected();
 
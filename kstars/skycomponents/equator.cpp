@@ -71,6 +71,11 @@ void Equator::draw( SkyPainter *skyp )
     
     m_label.reset();
     NoPrecessIndex::draw( skyp );
+}
+
+void Equator::drawLabels()
+{
+    if ( ! selected() ) return;
 
     KStarsData *data = KStarsData::Instance();
     QColor color( data->colorScheme()->colorNamed( "EqColor" ) );
@@ -41,6 +41,10 @@ public:
 
     virtual bool selected();
     virtual void draw( SkyPainter *skyp );
+    /* @short draws the line label found by the last draw() and the
+     * compass labels.  Kept apart from draw() so the lines can be cached.
+     */
+    void drawLabels();
     virtual void drawCompassLabels();
     virtual LineListLabel* label() {return &m_label;};
 
@@ -70,8 +70,9 @@ public:
     /* @short if the date in num differs from the last time we indexed by
      * more than our update interval then we re-index all the stars in our
      * list that have actually changed trixels.
+     * @return true if any star was moved to a different trixel.
      */
-    void reindex( KSNumbers *num, StarIndex* starIndex );
+    bool reindex( KSNumbers *num, StarIndex* starIndex );
 
     /* @short prints out some brief statistics.
      */
@@ -102,6 +102,14 @@ bool HorizontalCoordinateGrid::selected()
             ! ( Options::hideOnSlew() && Options::hideGrids() && SkyMap::IsSlewing() ) );
 }
 
+void HorizontalCoordinateGrid::draw( SkyPainter *skyp )
+{
+    if ( ! selected() )
+        return;
+    preDraw( skyp );
+    drawAllLines( skyp );
+}
+
 void HorizontalCoordinateGrid::preDraw( SkyPainter* skyp )
 {
     KStarsData *data = KStarsData::Instance();
@@ -38,6 +38,11 @@ public:
     	*/
     explicit HorizontalCoordinateGrid( SkyComposite *parent );
 
+    /* @short The grid points move with respect to the trixel index as
+     * the sky turns so every line is drawn.
+     */
+    virtual void draw( SkyPainter *skyp );
+
     void preDraw( SkyPainter *skyp );
     
     void update( KSNumbers* );
@@ -35,7 +35,10 @@ class KSNumbers;
 class LineList
 {
 public:
-    LineList() : drawID(0), updateID(0), updateNumID(0) {}
+    LineList() : drawID(0), updateID(0), updateNumID(0), capRadius(180.0) {
+        capAxis[0] = 1.0;
+        capAxis[1] = capAxis[2] = 0.0;
+    }
 
     /* A global drawID (in SkyMesh) is updated at the start of each draw
      * cycle.  Since an extended object is often covered by more than one
@@ -47,6 +50,14 @@ public:
     UpdateID updateID;
     UpdateID updateNumID;
 
+    /* A bounding cap around the (unprecessed) points, set by
+     * LineListIndex::appendLine().  capAxis is a unit vector and capRadius
+     * is in degrees.  A radius of 180 means the line is not bounded and
+     * is never rejected.
+     */
+    double   capAxis[3];
+    double   capRadius;
+
     /* @short return the list of points for iterating or appending
      * (or whatever).
      */
@@ -42,6 +42,7 @@
 #include "kstarsdata.h"
 #include "skyobjects/skyobject.h"
 #include "skymap.h"
+#include "frameprofiler.h"
 
 #include "skymesh.h"
 #include "linelist.h"
@@ -64,6 +65,48 @@ LineListIndex::~LineListIndex()
     delete m_polyIndex;
 }
 
+// Finds a cap around the points of lineList so drawLines() can reject it
+// cheaply.  Caps of 90 degrees or more are not convex so they are left
+// unbounded.
+static void setBoundingCap( LineList* lineList )
+{
+    SkyList* points = lineList->points();
+    lineList->capRadius = 180.0;
+    if ( points->size() == 0 )
+        return;
+
+    double x = 0.0, y = 0.0, z = 0.0;
+    double sinRa, cosRa, sinDec, cosDec;
+    for ( int i = 0; i < points->size(); i++ ) {
+        points->at( i )->ra0().SinCos( sinRa, cosRa );
+        points->at( i )->dec0().SinCos( sinDec, cosDec );
+        x += cosDec * cosRa;
+        y += cosDec * sinRa;
+        z += sinDec;
+    }
+
+    double norm = sqrt( x * x + y * y + z * z );
+    if ( norm < 1e-6 * points->size() )
+        return;
+
+    double axis[3] = { x / norm, y / norm, z / norm };
+    double minDot = 1.0;
+    for ( int i = 0; i < points->size(); i++ ) {
+        points->at( i )->ra0().SinCos( sinRa, cosRa );
+        points->at( i )->dec0().SinCos( sinDec, cosDec );
+        double dot = axis[0] * cosDec * cosRa + axis[1] * cosDec * sinRa + axis[2] * sinDec;
+        if ( dot < minDot )
+            minDot = dot;
+    }
+
+    if ( minDot <= 0.0 )
+        return;
+
+    for ( int k = 0; k < 3; k++ )
+        lineList->capAxis[k] = axis[k];
+    lineList->capRadius = acos( minDot ) / dms::DegToRad;
+}
+
 // This is a callback for the indexLines() function below
 const IndexHash& LineListIndex::getIndexHash(LineList* lineList ) {
     return skyMesh()->indexLine( lineList->points() );
@@ -87,6 +130,7 @@ void LineListIndex::appendLine( LineList* lineList, int debug)
         m_lineIndex->value( trixel )->append( lineList );
     }
 
+    setBoundingCap( lineList );
     m_listList.append( lineList);
 }
 
@@ -137,18 +181,26 @@ void LineListIndex::JITupdate( LineList* lineList )
 {
     KStarsData *data = KStarsData::Instance();
     lineList->updateID = data->updateID();
+    FrameProfiler::count( FrameProfiler::LineJITUpdates );
     SkyList* points = lineList->points();
 
+    const dms* lst = data->lst();
+    const dms* lat = data->geo()->lat();
+
+    // Precess (if needed) and convert each point in a single pass
     if ( lineList->updateNumID != data->updateNumID() ) {
         lineList->updateNumID = data->updateNumID();
         KSNumbers* num = data->updateNum();
         for (int i = 0; i < points->size(); i++ ) {
-            points->at( i )->updateCoords( num );
+            SkyPoint* p = points->at( i );
+            p->updateCoords( num );
+            p->EquatorialToHorizontal( lst, lat );
         }
     }
-
-    for (int i = 0; i < points->size(); i++ ) {
-        points->at( i )->EquatorialToHorizontal( data->lst(), data->geo()->lat() );
+    else {
+        for (int i = 0; i < points->size(); i++ ) {
+            points->at( i )->EquatorialToHorizontal( lst, lat );
+        }
     }
 }
 
@@ -178,15 +230,26 @@ void LineListIndex::drawLines( SkyPainter *skyp )
 {
     DrawID   drawID   = skyMesh()->drawID();
     UpdateID updateID = KStarsData::Instance()->updateID();
+    MeshBufNum_t bufNum = drawBuffer();
+
+    MeshIterator region( skyMesh(), bufNum );
+    while ( region.hasNext() ) {
+
+        LineListList* lineListList = m_lineIndex->value( region.next() );
+        if ( lineListList == 0 ) continue;
 
-    foreach ( LineListList* lineListList, m_lineIndex->values() ) {
         for (int i = 0; i < lineListList->size(); i++) {
             LineList* lineList = lineListList->at( i );
 
+            // draw each LineList at most once
             if ( lineList->drawID == drawID )
                 continue;
             lineList->drawID = drawID;
 
+            // long lines can touch a visible trixel without being visible
+            if ( ! skyMesh()->capInBuffer( lineList->capAxis, lineList->capRadius, bufNum ) )
+                continue;
+
             if ( lineList->updateID != updateID )
                 JITupdate( lineList );
 
@@ -195,6 +258,20 @@ void LineListIndex::drawLines( SkyPainter *skyp )
     }
 }
 
+void LineListIndex::drawAllLines( SkyPainter *skyp )
+{
+    UpdateID updateID = KStarsData::Instance()->updateID();
+
+    for (int i = 0; i < m_listList.size(); i++) {
+        LineList* lineList = m_listList.at( i );
+
+        if ( lineList->updateID != updateID )
+            JITupdate( lineList );
+
+        skyp->drawSkyPolyline(lineList, skipList(lineList), label() );
+    }
+}
+
 void LineListIndex::drawFilled( SkyPainter *skyp )
 {
     DrawID drawID     = skyMesh()->drawID();
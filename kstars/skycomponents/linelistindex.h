@@ -112,11 +112,18 @@ protected:
      */
     void appendBoth( LineList* lineList, int debug=0 );
 
-    /* @short Draws all the lines in m_listList as simple lines in float
-     * mode.
+    /* @short Draws the lines indexed in the trixels of drawBuffer() as
+     * simple lines in float mode.  Lines whose bounding cap lies outside
+     * the aperture are skipped before they are JIT updated.
      */
     void drawLines( SkyPainter* skyp );
 
+    /* @short Draws every line in m_listList without consulting the index.
+     * Used by subclasses whose points move with respect to the index, such
+     * as the horizontal coordinate grid.
+     */
+    void drawAllLines( SkyPainter* skyp );
+
     /* @short Draws all the lines in m_listList as filled polygons in float
      * mode.
      */
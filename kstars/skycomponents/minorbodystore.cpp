@@ -0,0 +1,134 @@
+/***************************************************************************
+                 minorbodystore.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2014-06-16
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "minorbodystore.h"
+
+#include "dms.h"
+#include "skyobjects/ksasteroid.h"
+
+MinorBodyStore::Elements::Elements() :
+    catN( 0 ), JD( 0 ), a( 0.0 ), e( 0.0 ), i( 0.0 ), w( 0.0 ), N( 0.0 ), M( 0.0 ),
+    H( 0.0 ), G( 0.0 ), q( 0.0 ), earthMOID( 0.0 ),
+    diameter( 0.0 ), albedo( 0.0 ), rotationPeriod( 0.0 ), period( 0.0 ), neo( false )
+{
+}
+
+int MinorBodyStore::StringPool::intern( const QString &s )
+{
+    QHash<QString, int>::const_iterator it = m_ids.constFind( s );
+    if ( it != m_ids.constEnd() )
+        return it.value();
+    int id = m_strings.size();
+    m_strings.append( s );
+    m_ids.insert( s, id );
+    return id;
+}
+
+void MinorBodyStore::StringPool::clear()
+{
+    m_strings.clear();
+    m_ids.clear();
+}
+
+MinorBodyStore::MinorBodyStore()
+{
+}
+
+void MinorBodyStore::clear()
+{
+    m_JD.clear();
+    m_a.clear(); m_e.clear(); m_i.clear(); m_w.clear(); m_N.clear(); m_M.clear();
+    m_H.clear(); m_G.clear(); m_q.clear(); m_earthMOID.clear();
+    m_diameter.clear(); m_albedo.clear(); m_rotationPeriod.clear(); m_period.clear();
+    m_brightest.clear();
+    m_catN.clear();
+    m_neo.clear();
+    m_names.clear();
+    m_orbitID.clear(); m_orbitClass.clear(); m_dimensions.clear();
+    m_pool.clear();
+    m_nameIndex.clear();
+}
+
+int MinorBodyStore::append( const Elements &el )
+{
+    int row = size();
+
+    m_JD.append( el.JD );
+    m_a.append( el.a );
+    m_e.append( el.e );
+    m_i.append( el.i );
+    m_w.append( el.w );
+    m_N.append( el.N );
+    m_M.append( el.M );
+
+    m_H.append( el.H );
+    m_G.append( el.G );
+    m_q.append( el.q );
+    m_earthMOID.append( el.earthMOID );
+    m_diameter.append( el.diameter );
+    m_albedo.append( el.albedo );
+    m_rotationPeriod.append( el.rotationPeriod );
+    m_period.append( el.period );
+    m_catN.append( el.catN );
+    m_neo.append( el.neo );
+
+    // Without an epoch the distance from the Sun spans the whole orbit
+    if ( el.e < 1.0 )
+        m_brightest.append( KSAsteroid::brightestMagnitude( el.H, el.G, el.a * ( 1.0 - el.e ), el.a * ( 1.0 + el.e ) ) );
+    else
+        m_brightest.append( KSAsteroid::brightestMagnitude( el.H, el.G, el.q, 1.0e10 ) );
+
+    m_names.append( el.name );
+    m_orbitID.append( m_pool.intern( el.orbitID ) );
+    m_orbitClass.append( m_pool.intern( el.orbitClass ) );
+    m_dimensions.append( m_pool.intern( el.dimensions ) );
+
+    m_nameIndex.insert( qHash( el.name.toLower() ), row );
+    return row;
+}
+
+int MinorBodyStore::find( const QString &name ) const
+{
+    uint key = qHash( name.toLower() );
+    QMultiHash<uint, int>::const_iterator it = m_nameIndex.constFind( key );
+    for ( ; it != m_nameIndex.constEnd() && it.key() == key; ++it ) {
+        if ( QString::compare( m_names[ it.value() ], name, Qt::CaseInsensitive ) == 0 )
+            return it.value();
+    }
+    return -1;
+}
+
+KSAsteroid* MinorBodyStore::createAsteroid( int row ) const
+{
+    KSAsteroid *ast = new KSAsteroid( m_catN[row], m_names[row], QString(), m_JD[row],
+                                      m_a[row], m_e[row],
+                                      dms( m_i[row] ), dms( m_w[row] ),
+                                      dms( m_N[row] ), dms( m_M[row] ),
+                                      m_H[row], m_G[row] );
+    ast->setPerihelion( m_q[row] );
+    ast->setOrbitID( m_pool.at( m_orbitID[row] ) );
+    ast->setNEO( m_neo[row] );
+    ast->setDiameter( m_diameter[row] );
+    ast->setDimensions( m_pool.at( m_dimensions[row] ) );
+    ast->setAlbedo( m_albedo[row] );
+    ast->setRotationPeriod( m_rotationPeriod[row] );
+    ast->setPeriod( m_period[row] );
+    ast->setEarthMOID( m_earthMOID[row] );
+    ast->setOrbitClass( m_pool.at( m_orbitClass[row] ) );
+    ast->setAngularSize( 0.005 );
+    return ast;
+}
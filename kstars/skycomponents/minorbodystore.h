@@ -0,0 +1,120 @@
+/***************************************************************************
+                  minorbodystore.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2014-06-16
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef MINORBODYSTORE_H
+#define MINORBODYSTORE_H
+
+#include <QHash>
+#include <QMultiHash>
+#include <QString>
+#include <QVector>
+
+class KSAsteroid;
+
+/**@class MinorBodyStore
+ * Keeps the orbital elements and catalog data of many asteroids in columns
+ * instead of one KSAsteroid per body. A KSAsteroid costs several hundred
+ * bytes plus its strings; a row here is about a third of that, and the
+ * repeated strings (orbit ids and classes, dimensions) are kept once in a
+ * pool. This is what makes the full list of numbered asteroids fit.
+ *
+ * KSAsteroid objects are created from a row with createAsteroid() only for
+ * the bodies that are drawn or looked up. Rows are found by name through a
+ * case insensitive index.
+ *
+ * @author The KStars team
+ */
+class MinorBodyStore
+{
+public:
+    /**@short The data of one asteroid, as read from the data file */
+    struct Elements {
+        Elements();
+
+        int catN;
+        QString name;
+        long double JD;      ///< epoch of the elements
+        double a, e;         ///< semi-major axis (AU) and eccentricity
+        double i, w, N, M;   ///< inclination, argument of perihelion, ascending node, mean anomaly (degrees)
+        double H, G;         ///< absolute magnitude and slope parameter
+        double q;            ///< perihelion distance (AU)
+        double earthMOID;
+        double diameter, albedo, rotationPeriod, period;
+        bool neo;
+        QString orbitID, orbitClass, dimensions;
+    };
+
+    MinorBodyStore();
+
+    /**@short Removes all bodies */
+    void clear();
+
+    /**@short Appends a body
+     * @return its row
+     */
+    int append( const Elements &el );
+
+    /**@return the number of bodies */
+    inline int size() const { return m_a.size(); }
+
+    /**@return the row of the body called name (case insensitive), or -1 */
+    int find( const QString &name ) const;
+
+    /**@return the name of the body in row */
+    inline const QString& name( int row ) const { return m_names[row]; }
+
+    /**@return a magnitude the body in row is never brighter than,
+     * see KSAsteroid::brightestMagnitude()
+     */
+    inline double brightestMagnitude( int row ) const { return m_brightest[row]; }
+
+    /**@short Creates a KSAsteroid for the body in row; the caller owns it */
+    KSAsteroid* createAsteroid( int row ) const;
+
+private:
+    /**@short Keeps one copy of each distinct string */
+    class StringPool {
+    public:
+        int intern( const QString &s );
+        inline const QString& at( int id ) const { return m_strings[id]; }
+        void clear();
+    private:
+        QVector<QString> m_strings;
+        QHash<QString, int> m_ids;
+    };
+
+    // Orbital elements
+    QVector<long double> m_JD;
+    QVector<double> m_a, m_e, m_i, m_w, m_N, m_M;
+
+    // Photometry and catalog data
+    QVector<double> m_H, m_G, m_q, m_earthMOID;
+    QVector<double> m_diameter, m_albedo, m_rotationPeriod, m_period;
+    QVector<double> m_brightest;
+    QVector<int> m_catN;
+    QVector<bool> m_neo;
+
+    // Strings, the repeated ones as ids into the pool
+    QVector<QString> m_names;
+    QVector<int> m_orbitID, m_orbitClass, m_dimensions;
+    StringPool m_pool;
+
+    // qHash() of the lower case name to the rows
+    QMultiHash<uint, int> m_nameIndex;
+};
+
+#endif
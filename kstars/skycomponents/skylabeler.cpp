@@ -23,21 +23,20 @@
 #include <QPixmap>
 
 #include "Options.h"
+#include "frameprofiler.h"
 #include "kstarsdata.h"   // MINZOOM
 #include "skymap.h"
 #include "projections/projector.h"
 
-//---------------------------------------------------------------------------//
-// A Little data container class
-//---------------------------------------------------------------------------//
+// Room reserved in each row so that rows hardly ever need to grow
+#define LABEL_ROW_RESERVE 32
 
-typedef struct LabelRun
-{
-    LabelRun(int s, int e) : start(s), end(e) {}
-    int start;
-    int end;
+// Drop the width cache of a font once it gets this big
+#define MAX_CACHED_WIDTHS 20000
 
-} LabelRun;
+// Labels are kept in place if the map scrolled less than this fraction
+// of its size since the last frame
+#define MAX_KEEP_SHIFT 0.25
 
 
 //----- Now for the main event ----------------------------------------------//
@@ -80,32 +79,29 @@ SkyLabeler::SkyLabeler() :
         m_maxY(0),
         m_size(0),
         m_fontMetrics( QFont() ),
+        m_lastZoom(0),
         m_picture(-1),
         labelList( NUM_LABEL_TYPES ),
         m_proj(0)
 {
     m_errors = 0;
     m_minDeltaX = 30;    // when to merge two adjacent regions
-    m_marks = m_hits = m_misses = m_elements = 0;
+    m_marks = m_hits = m_misses = m_elements = m_kept = 0;
+    m_widthHits = m_widthMisses = 0;
+    m_unclaimed = 0;
+    m_widths = &m_widthCache[ QFont().key() ];
 }
 
 
 SkyLabeler::~SkyLabeler()
 {
-    for (int y = 0; y < screenRows.size(); y++ ) {
-        LabelRow* row = screenRows[y];
-        for ( int i = 0; i < row->size(); i++) {
-            delete row->at(i);
-        }
-        delete row;
-    }
 }
 
 bool SkyLabeler::drawGuideLabel( QPointF& o, const QString& text, double angle )
 {
     // Create bounding rectangle by rotating the (height x width) rectangle
     qreal h = m_fontMetrics.height();
-    qreal w = m_fontMetrics.width( text );
+    qreal w = labelWidth( text );
     qreal s = sin( angle * dms::PI / 180.0 );
     qreal c = cos( angle * dms::PI / 180.0 );
 
@@ -155,19 +151,62 @@ bool SkyLabeler::drawNameLabel(SkyObject* obj, const QPointF& _p)
     double offset = obj->labelOffset();
     QPointF p( _p.x()+offset, _p.y()+offset );
 
-    if ( !markText( p, sLabel ) ) {
+    // A label kept from the last frame gives up its reservation and is
+    // then marked where it is drawn now, like any other label.
+    QMultiHash<QString, int>::iterator it = m_reservedText.find( sLabel );
+    if ( it != m_reservedText.end() ) {
+        m_reserved[ it.value() ].claimed = true;
+        m_reservedText.erase( it );
+        m_unclaimed--;
+        if ( markText( p, sLabel ) )
+            m_kept++;
+        else
+            return false;
+    }
+    else if ( !markText( p, sLabel ) ) {
         return false;
-    } else {
-        m_p.drawText( p, sLabel );
-        return true;
     }
+
+    m_p.drawText( p, sLabel );
+
+    if ( Options::keepLabelPlacement() ) {
+        PlacedLabel placed;
+        placed.text    = sLabel;
+        placed.claimed = false;
+        placed.rect = QRectF( p.x(), p.y() - m_fontMetrics.height(),
+                              labelWidth( sLabel ), m_fontMetrics.height() );
+        m_placed.append( placed );
+    }
+    return true;
 }
 
 
 void SkyLabeler::setFont( const QFont& font )
 {
     m_p.setFont( font );
+    setMetricsFont( font );
+}
+
+void SkyLabeler::setMetricsFont( const QFont& font )
+{
     m_fontMetrics = QFontMetrics( font );
+    m_widths = &m_widthCache[ font.key() ];
+}
+
+qreal SkyLabeler::labelWidth( const QString& text )
+{
+    QHash<QString, qreal>::const_iterator it = m_widths->constFind( text );
+    if ( it != m_widths->constEnd() ) {
+        m_widthHits++;
+        return it.value();
+    }
+
+    m_widthMisses++;
+    if ( m_widths->size() >= MAX_CACHED_WIDTHS )
+        m_widths->clear();
+    qreal width = m_fontMetrics.width( text );
+    m_widths->insert( text, width );
+    return width;
 }
 
 void SkyLabeler::setPen(const QPen& pen)
@@ -196,8 +235,8 @@ void SkyLabeler::getMargins( const QString& text, float *left,
                              float *right, float *top, float *bot )
 {
     float height     = m_fontMetrics.height();
-    float width      = m_fontMetrics.width( text );
-    float sideMargin = m_fontMetrics.width("MM") + width / 2.0;
+    float width      = labelWidth( text );
+    float sideMargin = labelWidth( "MM" ) + width / 2.0;
 
     // Create the margins within which it is okay to draw the label
     *right = m_p.window().width() - sideMargin;
@@ -206,10 +245,18 @@ void SkyLabeler::getMargins( const QString& text, float *left,
     *bot   = m_p.window().height() - 2.0 * height;
 }
 
+QSize SkyLabeler::projectorSize() const
+{
+    ViewParams vp = m_proj->viewParams();
+    return QSize( int( vp.width ), int( vp.height ) );
+}
+
 void SkyLabeler::reset( SkyMap* skyMap )
 {
     // ----- Set up Projector ---
     m_proj = skyMap->projector();
+    // The view may be other than the sky map's, e.g. for batch charts
+    QSize viewSize = projectorSize();
     // ----- Set up Painter -----
     if( m_p.isActive() )
         m_p.end();
@@ -217,14 +264,14 @@ void SkyLabeler::reset( SkyMap* skyMap )
     m_p.begin(&m_picture);
     //This works around BUG 10496 in Qt
     m_p.drawPoint( 0, 0 );
-    m_p.drawPoint( skyMap->width() + 1, skyMap->height() + 1);
+    m_p.drawPoint( viewSize.width() + 1, viewSize.height() + 1);
     // ----- Set up Zoom Dependent Font -----
 
     m_stdFont = QFont( m_p.font() );
     setZoomFont();
     m_skyFont = m_p.font();
-    m_fontMetrics = QFontMetrics( m_skyFont );
-    m_minDeltaX = (int) m_fontMetrics.width("MMMMM");
+    setMetricsFont( m_skyFont );
+    m_minDeltaX = (int) labelWidth( "MMMMM" );
 
     // ----- Set up Zoom Dependent Offset -----
     m_offset = SkyLabeler::ZoomOffset();
@@ -232,38 +279,35 @@ void SkyLabeler::reset( SkyMap* skyMap )
     // ----- Prepare Virtual Screen -----
     m_yScale = (m_fontMetrics.height() + 1.0);
 
-    int maxY = int( skyMap->height() / m_yScale );
+    int maxY = int( viewSize.height() / m_yScale );
     if ( maxY < 1 ) maxY = 1;                         // prevents a crash below?
 
-    int m_maxX = skyMap->width();
+    int m_maxX = viewSize.width();
     m_size = (maxY + 1) * m_maxX;
 
     // Resize if needed:
     if ( maxY > m_maxY ) {
-        screenRows.resize( m_maxY );
-        for ( int y = m_maxY; y <= maxY; y++) {
-            screenRows.append( new LabelRow() );
+        int oldSize = screenRows.size();
+        screenRows.resize( maxY + 1 );
+        for ( int y = oldSize; y <= maxY; y++) {
+            screenRows[y].reserve( LABEL_ROW_RESERVE );
         }
         //printf("resize: %d -> %d, size:%d\n", m_maxY, maxY, screenRows.size());
     }
 
-    // Clear all pre-existing rows as needed
-
-    int minMaxY = (maxY < m_maxY) ? maxY : m_maxY;
-
-    for (int y = 0; y <= minMaxY; y++) {
-        LabelRow* row = screenRows[y];
-        for ( int i = 0; i < row->size(); i++) {
-            delete row->at(i);
-        }
-        row->clear();
+    // Clear all pre-existing rows.  Rows keep their storage.
+    for (int y = 0; y < screenRows.size(); y++) {
+        screenRows[y].resize( 0 );
     }
 
     // never decrease m_maxY:
     if ( m_maxY < maxY ) m_maxY = maxY;
 
     // reset the counters
-    m_marks = m_hits = m_misses = m_elements = 0;
+    m_marks = m_hits = m_misses = m_elements = m_kept = 0;
+    m_widthHits = m_widthMisses = 0;
+
+    keepPlacements( skyMap );
 
     //----- Clear out labelList -----
     for (int i = 0; i < labelList.size(); i++) {
@@ -271,6 +315,79 @@ void SkyLabeler::reset( SkyMap* skyMap )
     }
 }
 
+void SkyLabeler::keepPlacements( SkyMap* skyMap )
+{
+    QVector<PlacedLabel> placed;
+    qSwap( placed, m_placed );
+    m_placed.reserve( placed.size() );
+    releaseReservations();
+
+    QSize viewSize = projectorSize();
+    bool sameView = ( m_lastZoom == Options::zoomFactor() && m_lastSize == viewSize );
+    m_lastFocus = *skyMap->focus();
+    m_lastZoom  = Options::zoomFactor();
+    m_lastSize  = viewSize;
+
+    if ( ! Options::keepLabelPlacement() || ! sameView || placed.isEmpty() )
+        return;
+
+    // The last focus was at the center of the screen, so wherever it is
+    // projected now tells us how far the map scrolled.
+    bool visible = false;
+    QPointF o = m_proj->toScreen( &m_lastFocus, false, &visible );
+    QPointF shift = o - QPointF( 0.5 * viewSize.width(), 0.5 * viewSize.height() );
+    if ( ! visible || fabs( shift.x() ) > MAX_KEEP_SHIFT * viewSize.width()
+                   || fabs( shift.y() ) > MAX_KEEP_SHIFT * viewSize.height() )
+        return;
+
+    // The labels did not overlap last frame and all move by the same
+    // shift, so the reservations do not overlap each other either.
+    // They are kept apart from screenRows so that the ones not drawn
+    // again can be released at the end of the frame.
+    // Each one is listed in the label rows it covers, so that markRegion()
+    // only looks at the reservations near the label being placed.
+    if ( m_reservedRows.size() < screenRows.size() )
+        m_reservedRows.resize( screenRows.size() );
+    for ( int i = 0; i < placed.size(); i++ ) {
+        QRectF r = placed[i].rect.translated( shift );
+        if ( ! m_proj->onScreen( r.topLeft() ) )
+            continue;
+        placed[i].rect = r;
+        int minY = qBound( 0, int( r.top() / m_yScale ), m_maxY );
+        int maxY = qBound( 0, int( r.bottom() / m_yScale ), m_maxY );
+        for ( int y = minY; y <= maxY; y++ )
+            m_reservedRows[ y ].append( m_reserved.size() );
+        m_reservedText.insertMulti( placed[i].text, m_reserved.size() );
+        m_reserved.append( placed[i] );
+    }
+    m_unclaimed = m_reserved.size();
+}
+
+void SkyLabeler::releaseReservations()
+{
+    if ( ! m_reserved.isEmpty() ) {
+        // Rows keep their storage, like screenRows
+        for ( int y = 0; y < m_reservedRows.size(); y++ )
+            m_reservedRows[ y ].resize( 0 );
+    }
+    m_reserved.clear();
+    m_reservedText.clear();
+    m_unclaimed = 0;
+}
+
+bool SkyLabeler::reservedRegion( const QRectF& region, int minY, int maxY ) const
+{
+    for ( int y = minY; y <= maxY; y++ ) {
+        const QVector<int>& row = m_reservedRows.at( y );
+        for ( int i = 0; i < row.size(); i++ ) {
+            const PlacedLabel& reserved = m_reserved.at( row.at( i ) );
+            if ( ! reserved.claimed && reserved.rect.intersects( region ) )
+                return true;
+        }
+    }
+    return false;
+}
+
 void SkyLabeler::draw(QPainter& p)
 {
     //FIXME: need a better soln. Apparently starting a painter
@@ -278,6 +395,12 @@ void SkyLabeler::draw(QPainter& p)
     // But it's not like that's something that should be in the docs, right?
     // No, that's definitely better to leave to people to figure out on their own.
     if( m_p.isActive() ) { m_p.end(); }
+    // All labels of this frame are in; free the space of those not redrawn.
+    releaseReservations();
+    FrameProfiler::count( FrameProfiler::LabelsDrawn, m_hits );
+    FrameProfiler::count( FrameProfiler::LabelsRejected, m_misses );
+    FrameProfiler::count( FrameProfiler::LabelsKept, m_kept );
+    FrameProfiler::count( FrameProfiler::LabelWidthsMeasured, m_widthMisses );
     m_picture.play(&p); //can't replay while it's being painted on
                         //this is also undocumented btw.
     //m_p.begin(&m_picture);
@@ -291,7 +414,7 @@ void SkyLabeler::draw(QPainter& p)
 bool SkyLabeler::markText( const QPointF& p, const QString& text )
 {
 
-    qreal maxX =  p.x() + m_fontMetrics.width( text );
+    qreal maxX =  p.x() + labelWidth( text );
     qreal minY = p.y() - m_fontMetrics.height();
     return markRegion( p.x(), maxX, p.y(), minY );
 }
@@ -330,16 +453,23 @@ bool SkyLabeler::markRegion( qreal left, qreal right, qreal top, qreal bot )
     // check to see if we overlap any existing label
     // We must check all rows before we start marking
     for (int y = minY; y <= maxY; y++ ) {
-        LabelRow* row = screenRows[ y ];
+        const LabelRow& row = screenRows.at( y );
         int i;
-        for ( i = 0; i < row->size(); i++) {
-            if ( row->at( i )->end < minX ) continue;  // skip past these
-            if ( row->at( i )->start > maxX ) break;
+        for ( i = 0; i < row.size(); i++) {
+            if ( row.at( i ).end < minX ) continue;  // skip past these
+            if ( row.at( i ).start > maxX ) break;
             m_misses++;
             return false;
         }
     }
 
+    // ... and the space kept for last frame's labels not yet drawn again
+    if ( m_unclaimed > 0 &&
+         reservedRegion( QRectF( QPointF( left, top ), QPointF( right, bot ) ).normalized(), minY, maxY ) ) {
+        m_misses++;
+        return false;
+    }
+
     m_hits++;
     m_marks += (maxX - minX + 1) * (maxY - minY + 1);
 
@@ -347,11 +477,11 @@ bool SkyLabeler::markRegion( qreal left, qreal right, qreal top, qreal bot )
     // screenRows.
 
     for ( int y = minY; y <= maxY; y++ ) {
-        LabelRow* row = screenRows[ y ];
+        LabelRow& row = screenRows[ y ];
 
         // Simplest case: an empty row
-        if ( row->size() < 1 ) {
-            row->append( new LabelRun( minX, maxX ) );
+        if ( row.size() < 1 ) {
+            row.append( LabelRun( minX, maxX ) );
             m_elements++;
             continue;
         }
@@ -359,31 +489,31 @@ bool SkyLabeler::markRegion( qreal left, qreal right, qreal top, qreal bot )
         // Find out our place in the universe (or row).
         // H'mm.  Maybe we could cache these numbers above.
         int i;
-        for ( i = 0; i < row->size(); i++ ) {
-            if ( row->at(i)->end >= minX ) break;
+        for ( i = 0; i < row.size(); i++ ) {
+            if ( row.at(i).end >= minX ) break;
         }
 
         // i now points to first label PAST ours
 
         // if we are first, append or merge at start of list
         if ( i == 0 ) {
-            if ( row->at(0)->start - maxX < m_minDeltaX ) {
-                row->at(0)->start = minX;
+            if ( row.at(0).start - maxX < m_minDeltaX ) {
+                row[0].start = minX;
             }
             else {
-                row->insert( 0, new LabelRun(minX, maxX) );
+                row.insert( 0, LabelRun(minX, maxX) );
                 m_elements++;
             }
             continue;
         }
 
         // if we are past the last label, merge or append at end
-        else if ( i == row->size() ) {
-            if ( minX - row->at(i-1)->end < m_minDeltaX ) {
-                row->at(i-1)->end = maxX;
+        else if ( i == row.size() ) {
+            if ( minX - row.at(i-1).end < m_minDeltaX ) {
+                row[i-1].end = maxX;
             }
             else {
-                row->append( new LabelRun(minX, maxX) );
+                row.append( LabelRun(minX, maxX) );
                 m_elements++;
             }
             continue;
@@ -392,30 +522,29 @@ bool SkyLabeler::markRegion( qreal left, qreal right, qreal top, qreal bot )
         // if we got here, we must insert or merge the new label
         //  between [i-1] and [i]
 
-        bool mergeHead = ( minX - row->at(i-1)->end < m_minDeltaX );
-        bool mergeTail = ( row->at(i)->start - maxX < m_minDeltaX );
+        bool mergeHead = ( minX - row.at(i-1).end < m_minDeltaX );
+        bool mergeTail = ( row.at(i).start - maxX < m_minDeltaX );
 
         // double merge => combine all 3 into one
         if ( mergeHead && mergeTail ) {
-            row->at(i-1)->end = row->at(i)->end;
-            delete row->at( i );
-            row->removeAt( i );
+            row[i-1].end = row.at(i).end;
+            row.remove( i );
             m_elements--;
         }
 
         // Merge label with [i-1]
         else if ( mergeHead ) {
-            row->at(i-1)->end = maxX;
+            row[i-1].end = maxX;
         }
 
         // Merge label with [i]
         else if ( mergeTail ) {
-            row->at(i)->start = minX;
+            row[i].start = minX;
         }
 
         // insert between the two
         else {
-            row->insert( i, new LabelRun( minX, maxX) );
+            row.insert( i, LabelRun( minX, maxX) );
             m_elements++;
         }
     }
@@ -514,7 +643,8 @@ void SkyLabeler::printInfo()
 {
     printf("SkyLabeler:\n");
     printf("  fillRatio=%.1f%%\n", fillRatio() );
-    printf("  hits=%d  misses=%d  ratio=%.1f%%\n", m_hits, m_misses, hitRatio());
+    printf("  hits=%d  misses=%d  ratio=%.1f%%  kept=%d\n", m_hits, m_misses, hitRatio(), m_kept);
+    printf("  width cache: hits=%d  misses=%d\n", m_widthHits, m_widthMisses );
     printf("  yScale=%.1f maxY=%d\n", m_yScale, m_maxY );
 
     printf("  screenRows=%d elements=%d virtualSize=%.1f Kbytes\n",
@@ -539,19 +669,19 @@ void SkyLabeler::printInfo()
 
     // Check for errors in the data structure
     for (int y = 0; y <= m_maxY; y++) {
-        LabelRow* row = screenRows[y];
-        int size = row->size();
+        const LabelRow& row = screenRows.at( y );
+        int size = row.size();
         if ( size < 2 ) continue;
 
         bool error = false;
         for (int i = 1; i < size; i++) {
-            if ( row->at(i-1)->end > row->at(i)->start ) error = true;
+            if ( row.at(i-1).end > row.at(i).start ) error = true;
         }
         if ( ! error ) continue;
 
         printf("ERROR: %3d: ", y );
-        for (int i=0; i < row->size(); i++) {
-            printf("(%d, %d) ", row->at(i)->start, row->at(i)->end );
+        for (int i=0; i < row.size(); i++) {
+            printf("(%d, %d) ", row.at(i).start, row.at(i).end );
         }
         printf("\n");
     }
@@ -21,20 +21,32 @@
 #include <QFontMetricsF>
 #include <QList>
 #include <QVector>
+#include <QHash>
 #include <QPainter>
 #include <QPicture>
 #include <QFont>
+#include <QSize>
 
 #include "skylabel.h"
+#include "skyobjects/skypoint.h"
 
 class QString;
 class QPointF;
 class SkyMap;
 class Projector;
-struct LabelRun;
 
-typedef QList<LabelRun*>	LabelRow;
-typedef QVector<LabelRow*>  ScreenRows;
+/** A run of covered pixels in one strip of the virtual screen */
+struct LabelRun
+{
+    LabelRun() : start(0), end(0) {}
+    LabelRun(int s, int e) : start(s), end(e) {}
+    int start;
+    int end;
+};
+Q_DECLARE_TYPEINFO(LabelRun, Q_PRIMITIVE_TYPE);
+
+typedef QVector<LabelRun>   LabelRow;
+typedef QVector<LabelRow>   ScreenRows;
 
 
 /**
@@ -61,9 +73,21 @@ typedef QVector<LabelRow*>  ScreenRows;
  * The information in the X-dimension is completed run length encoded. A
  * consecutive run of pixels in one strip that are covered by one or more labels
  * is stored in a LabelRun object that merely stores the start pixel and the end
- * pixel.  A LabelRow is a list of LabelRun's stored in ascending order.  This
- * saves a lot of space over an explicit array and it also makes checking for
- * overlaps faster and even makes inserting new overlaps faster on average.
+ * pixel.  A LabelRow is a flat vector of LabelRun's stored in ascending order.
+ * This saves a lot of space over an explicit array and it also makes checking
+ * for overlaps faster and even makes inserting new overlaps faster on average.
+ * The rows keep their storage from one frame to the next, so once the labeler
+ * has warmed up placing labels does not allocate at all.
+ *
+ * Measuring text is the other expensive part, so the width of every label is
+ * cached per font.  And if the map has only been scrolled a little since the
+ * last frame (and KeepLabelPlacement is set) reset() reserves the regions of
+ * the labels drawn last frame, shifted by the scroll.  Other labels may not
+ * take that space until the end of the frame, so when those objects are
+ * drawn again their label usually still fits at its old place.  This stops
+ * labels from jumping between neighboring objects while the map moves.
+ * A kept label is still checked against the labels drawn before it, so it
+ * can be dropped if a label with a higher priority moved into its way.
  *
  * Synopsis:
  *
@@ -167,7 +191,8 @@ public:
     void reset( SkyMap* skyMap );
 
     /**
-     * @short Draws labels using the given painter
+     * @short Draws labels using the given painter, and adds the counters
+     * of this frame to the FrameProfiler.
      * @param p the painter to draw labels with
      */
     void draw(QPainter& p);
@@ -215,6 +240,12 @@ public:
      */
     QFontMetricsF& fontMetrics() { return m_fontMetrics; }
 
+    /**
+     * @short returns the width of text in the current font.  Widths are
+     * cached per font, so this is much cheaper than asking fontMetrics().
+     */
+    qreal labelWidth( const QString& text );
+
 
     //----- Drawing/Adding Labels -----//
 
@@ -321,6 +352,31 @@ public:
     int marks() { return m_marks; }
 
 private:
+    /** A label drawn this frame, remembered to keep it in place next frame.
+     *  Labels are matched by their text rather than by object, since deep
+     *  stars are recycled from one frame to the next. */
+    struct PlacedLabel {
+        QString    text;
+        QRectF     rect;
+        bool       claimed;   ///< as a reservation: drawn again this frame
+    };
+
+    /** Sets the font used to measure labels, without touching the painter */
+    void setMetricsFont( const QFont& font );
+
+    /** Reserves the regions of last frame's labels if the map only scrolled a bit */
+    void keepPlacements( SkyMap* skyMap );
+
+    /** Drops the reservations of this frame, whether claimed or not */
+    void releaseReservations();
+
+    /** @return true if the region, which covers the label rows minY to maxY,
+     *  overlaps a reservation not claimed yet */
+    bool reservedRegion( const QRectF& region, int minY, int maxY ) const;
+
+    /** The size of the view the projector draws onto */
+    QSize projectorSize() const;
+
     ScreenRows screenRows;
 
     int m_maxX;
@@ -333,6 +389,9 @@ private:
     int m_misses;
     int m_elements;
     int m_errors;
+    int m_kept;
+    int m_widthHits;
+    int m_widthMisses;
 
     qreal  m_yScale;
     double m_offset;
@@ -340,6 +399,18 @@ private:
     QFont		 m_stdFont, m_skyFont;
     QFontMetricsF m_fontMetrics;
 
+    QHash<QString, QHash<QString, qreal> > m_widthCache;  // font key -> text -> width
+    QHash<QString, qreal>* m_widths;                      // widths for the current font
+
+    QVector<PlacedLabel>        m_placed;      // labels drawn this frame
+    QVector<PlacedLabel>        m_reserved;    // last frame's labels, shifted
+    QMultiHash<QString, int>    m_reservedText; // label text -> index in m_reserved
+    QVector< QVector<int> >     m_reservedRows; // label row -> indices in m_reserved
+    int                         m_unclaimed;   // reservations not drawn yet
+    SkyPoint m_lastFocus;
+    double   m_lastZoom;
+    QSize    m_lastSize;
+
     QPainter m_p;
     QPicture m_picture;
 
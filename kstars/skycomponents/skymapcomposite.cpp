@@ -48,6 +48,7 @@
 #include "supernovaecomponent.h"
 
 
+#include "frameprofiler.h"
 #include "skymesh.h"
 #include "skylabeler.h"
 #include "skypainter.h"
@@ -55,6 +56,15 @@
 
 #include "typedef.h"
 
+namespace {
+    // Draws one component as a profiled section
+    inline void drawComponent( SkyComponent *component, SkyPainter *skyp, const char *name )
+    {
+        FrameProfiler::Scope scope( name );
+        component->draw( skyp );
+    }
+}
+
 SkyMapComposite::SkyMapComposite(SkyComposite *parent ) :
         SkyComposite(parent), m_reindexNum( J2000 )
 {
@@ -116,6 +126,7 @@ SkyMapComposite::~SkyMapComposite()
 
 void SkyMapComposite::update(KSNumbers *num )
 {
+    FrameProfiler::Scope scope( "Update" );
     //printf("updating SkyMapComposite\n");
     //1. Milky Way
     //m_MilkyWay->update( data, num );
@@ -153,11 +164,13 @@ void SkyMapComposite::update(KSNumbers *num )
 
 void SkyMapComposite::updatePlanets(KSNumbers *num )
 {
+    FrameProfiler::Scope scope( "Update planets" );
     m_SolarSystem->updatePlanets( num );
 }
 
 void SkyMapComposite::updateMoons(KSNumbers *num )
 {
+    FrameProfiler::Scope scope( "Update moons" );
     m_SolarSystem->updateMoons( num );
 }
 
@@ -168,6 +181,11 @@ void SkyMapComposite::updateMoons(KSNumbers *num )
 //z-ordering (the layering) of the components.  Objects which
 //should appear "behind" others should be drawn first.
 void SkyMapComposite::draw( SkyPainter *skyp )
+{
+    draw( skyp, AllLayers );
+}
+
+void SkyMapComposite::draw( SkyPainter *skyp, int layers )
 {
     SkyMap *map = SkyMap::Instance();
     KStarsData *data = KStarsData::Instance();
@@ -197,11 +215,16 @@ void SkyMapComposite::draw( SkyPainter *skyp )
 
     m_skyMesh->inDraw( true );
     SkyPoint* focus = map->focus();
-    m_skyMesh->aperture( focus, radius + 1.0, DRAW_BUF ); // divide by 2 for testing
-
-    // create the no-precess aperture if needed
-    if ( Options::showEquatorialGrid() || Options::showHorizontalGrid() || Options::showCBounds() || Options::showEquator() ) {
-        m_skyMesh->index( focus, radius + 1.0, NO_PRECESS_BUF );
+    {
+        FrameProfiler::Scope scope( "Aperture" );
+        m_skyMesh->aperture( focus, radius + 1.0, DRAW_BUF ); // divide by 2 for testing
+
+        // create the no-precess aperture if needed.  The line components
+        // only draw lines indexed in its trixels so ask them directly since
+        // the grids can be auto-selected.
+        if ( m_EquatorialCoordinateGrid->selected() || m_CBoundLines->selected() || m_Equator->selected() ) {
+            m_skyMesh->index( focus, radius + 1.0, NO_PRECESS_BUF );
+        }
     }
 
     // clear marks from old labels and prep fonts
@@ -212,62 +235,77 @@ void SkyMapComposite::draw( SkyPainter *skyp )
     // FIXME: REGRESSION. Labeler now know nothing about infoboxes
     // map->infoBoxes()->reserveBoxes( psky );
 
-    if( KStars::Instance() ) {
-        const QList<SkyObject*> obsList = KStars::Instance()->observingList()->sessionList();
-        if( Options::obsListText() )
-            foreach( SkyObject* obj, obsList ) {
-                SkyLabeler::AddLabel( obj, SkyLabeler::RUDE_LABEL );
-            }
-    }
-        
+    if ( layers & StaticLayer ) {
+        drawComponent( m_MilkyWay, skyp, "Milky Way" );
+
+        drawComponent( m_EquatorialCoordinateGrid, skyp, "Equatorial grid" );
+        drawComponent( m_HorizontalCoordinateGrid, skyp, "Horizontal grid" );
 
-    m_MilkyWay->draw( skyp );
+        // Draw constellation boundary lines only if we draw western constellations
+        if ( m_Cultures->current() == "Western" )
+            drawComponent( m_CBoundLines, skyp, "Constellation boundaries" );
 
-    m_EquatorialCoordinateGrid->draw( skyp );
-    m_HorizontalCoordinateGrid->draw( skyp );
+        drawComponent( m_CLines, skyp, "Constellation lines" );
 
-    // Draw constellation boundary lines only if we draw western constellations
-    if ( m_Cultures->current() == "Western" )
-        m_CBoundLines->draw( skyp );
+        drawComponent( m_Equator, skyp, "Equator" );
 
-    m_CLines->draw( skyp );
+        drawComponent( m_Ecliptic, skyp, "Ecliptic" );
 
-    m_Equator->draw( skyp );
+        drawComponent( m_DeepSky, skyp, "Deep sky" );
 
-    m_Ecliptic->draw( skyp );
+        drawComponent( m_CustomCatalogs, skyp, "Custom catalogs" );
+
+        drawComponent( m_Stars, skyp, "Stars" );
+    }
 
-    m_DeepSky->draw( skyp );
+    if ( ! ( layers & DynamicLayer ) ) {
+        m_skyMesh->inDraw( false );
+        return;
+    }
 
-    m_CustomCatalogs->draw( skyp );
+    if( KStars::Instance() ) {
+        const QList<SkyObject*> obsList = KStars::Instance()->observingList()->sessionList();
+        if( Options::obsListText() )
+            foreach( SkyObject* obj, obsList ) {
+                SkyLabeler::AddLabel( obj, SkyLabeler::RUDE_LABEL );
+            }
+    }
 
-    m_Stars->draw( skyp );
+    m_Equator->drawLabels();
+    m_Ecliptic->drawLabels();
 
-    m_SolarSystem->drawTrails( skyp );
-    m_SolarSystem->draw( skyp );
+    {
+        FrameProfiler::Scope scope( "Trails" );
+        m_SolarSystem->drawTrails( skyp );
+    }
+    drawComponent( m_SolarSystem, skyp, "Solar system" );
 
-    m_Satellites->draw( skyp );
+    drawComponent( m_Satellites, skyp, "Satellites" );
 
-    m_Supernovae->draw(skyp);
+    drawComponent( m_Supernovae, skyp, "Supernovae" );
 
-    map->drawObjectLabels( labelObjects() );
+    {
+        FrameProfiler::Scope scope( "Labels" );
+        map->drawObjectLabels( labelObjects() );
 
-    m_skyLabeler->drawQueuedLabels();
-    m_CNames->draw( skyp );
-    m_Stars->drawLabels();
-    m_DeepSky->drawLabels();
+        m_skyLabeler->drawQueuedLabels();
+        m_CNames->draw( skyp );
+        m_Stars->drawLabels();
+        m_DeepSky->drawLabels();
+    }
 
     m_ObservingList->pen = QPen( QColor(data->colorScheme()->colorNamed( "ObsListColor" )), 1. );
     if( KStars::Instance() && !m_ObservingList->list )
         m_ObservingList->list = &KStars::Instance()->observingList()->sessionList();
     if( m_ObservingList )
-        m_ObservingList->draw( skyp );
+        drawComponent( m_ObservingList, skyp, "Observing list" );
 
-    m_Flags->draw( skyp );
+    drawComponent( m_Flags, skyp, "Flags" );
 
     m_StarHopRouteList->pen = QPen( QColor(data->colorScheme()->colorNamed( "StarHopRouteColor" )), 1. );
-    m_StarHopRouteList->draw( skyp );
+    drawComponent( m_StarHopRouteList, skyp, "Star hop route" );
     
-    m_Horizon->draw( skyp );
+    drawComponent( m_Horizon, skyp, "Horizon" );
 
     m_skyMesh->inDraw( false );
 
@@ -445,6 +483,38 @@ SkyObject* SkyMapComposite::findByName( const QString &name ) {
     return 0;
 }
 
+QList<SkyObject*> SkyMapComposite::findByNames( const QStringList &names ) {
+    //Same order as findByName(), with all the names that are still
+    //missing looked up among the stars together
+    QList<SkyObject*> result;
+    QStringList missing;
+    QList<int> missingIndex;
+    for ( int i = 0; i < names.size(); ++i ) {
+        const QString &name = names[i];
+        SkyObject *o = m_SolarSystem->findByName( name );
+        if ( ! o ) o = m_DeepSky->findByName( name );
+        if ( ! o ) o = m_CustomCatalogs->findByName( name );
+        if ( ! o ) o = m_CNames->findByName( name );
+        result.append( o );
+        if ( ! o ) {
+            missing.append( name );
+            missingIndex.append( i );
+        }
+    }
+
+    if ( missing.isEmpty() )
+        return result;
+
+    QList<SkyObject*> stars = m_Stars->findByNames( missing );
+    for ( int j = 0; j < missing.size(); ++j ) {
+        SkyObject *o = stars[j];
+        if ( ! o )
+            o = m_Supernovae->findByName( missing[j] );
+        result[ missingIndex[j] ] = o;
+    }
+    return result;
+}
+
 
 SkyObject* SkyMapComposite::findStarByGenetiveName( const QString name ) {
     return m_Stars->findStarByGenetiveName( name );
@@ -565,8 +635,8 @@ const QList<SkyObject*>& SkyMapComposite::stars() const {
 }
 
 
-const QList<SkyObject*>& SkyMapComposite::asteroids() const {
-    return m_SolarSystem->asteroids();
+QList<SkyObject*> SkyMapComposite::asteroids( double magLimit ) {
+    return m_SolarSystem->asteroids( magLimit );
 }
 
 const QList<SkyObject*>& SkyMapComposite::comets() const {
@@ -67,6 +67,15 @@ class SkyMapComposite : public QObject, public SkyComposite
     Q_OBJECT
 
 public:
+    /**
+    	*The layers drawn by draw().  The static layer holds everything that
+    	*only moves on screen when the view or the precession changes (Milky
+    	*Way, grids, lines, deep-sky objects and stars) so a renderer may cache
+    	*it.  The dynamic layer holds the solar system, satellites, the horizon
+    	*and all the labels, including those of the static layer.
+    	*/
+    enum DrawLayer { StaticLayer = 1, DynamicLayer = 2, AllLayers = StaticLayer | DynamicLayer };
+
     /**
     	*Constructor
     	*@p parent pointer to the parent SkyComponent
@@ -114,6 +123,16 @@ public:
     	*/
     virtual void draw( SkyPainter *skyp );
 
+    /**
+    	*@short Draw only the given layers
+    	*@p skyp the SkyPainter on which to paint
+    	*@p layers OR-ed DrawLayer flags
+    	*@note the dynamic layer redraws the labels of the static layer from
+    	*the last time it was drawn, so the static layer must be drawn first
+    	*whenever the view changes.
+    	*/
+    void draw( SkyPainter *skyp, int layers );
+
     /**
       *@return the object nearest a given point in the sky.
       *@param p The point to find an object near
@@ -146,6 +165,16 @@ public:
     	*/
     virtual SkyObject* findByName( const QString &name );
 
+    /**
+    	*@short Search the children for many names at once.
+    	*Gives the same results as findByName() for each name, but the
+    	*stars, the longest list, are searched only once for all of them.
+    	*@p names the names to be matched
+    	*@return the matching SkyObjects in the order of names, with
+    	*NULL pointers where no match was found.
+    	*/
+    QList<SkyObject*> findByNames( const QStringList &names );
+
     /**
       *@return the list of objects in the region defined by skypoints 
       *@param p1 first sky point (top-left vertex of rectangular region)
@@ -177,7 +206,9 @@ public:
     const QList<DeepSkyObject*>& deepSkyObjects() const;
     const QList<SkyObject*>& constellationNames() const;
     const QList<SkyObject*>& stars() const;
-    const QList<SkyObject*>& asteroids() const;
+    /** @return the asteroids that may be brighter than magLimit, with
+     *  their positions and magnitudes computed */
+    QList<SkyObject*> asteroids( double magLimit );
     const QList<SkyObject*>& comets() const;
     const QList<SkyObject*>& supernovae() const;
 
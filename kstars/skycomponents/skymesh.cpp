@@ -61,15 +61,74 @@ SkyMesh::SkyMesh( int level) :
 {
     errLimit = HTMesh::size() / 4;
     m_inDraw = false;
+    m_drawAperture = new MeshAperture( this );
+
+    // Until a buffer is filled every cap overlaps it
+    for ( int i = 0; i < NUM_MESH_BUF; i++ ) {
+        m_bufCenter[i][0] = 1.0;
+        m_bufCenter[i][1] = m_bufCenter[i][2] = 0.0;
+        m_bufRadius[i] = 180.0;
+    }
 }
 
-void SkyMesh::aperture(SkyPoint *p0, double radius, MeshBufNum_t bufNum)
+SkyMesh::~SkyMesh()
+{
+    delete m_drawAperture;
+}
+
+void SkyMesh::setBufCircle( const dms& ra, const dms& dec, double radius, MeshBufNum_t bufNum )
+{
+    if ( bufNum >= NUM_MESH_BUF )
+        return;
+
+    double sinRa, cosRa, sinDec, cosDec;
+    ra.SinCos( sinRa, cosRa );
+    dec.SinCos( sinDec, cosDec );
+    m_bufCenter[bufNum][0] = cosDec * cosRa;
+    m_bufCenter[bufNum][1] = cosDec * sinRa;
+    m_bufCenter[bufNum][2] = sinDec;
+    m_bufRadius[bufNum] = radius;
+}
+
+bool SkyMesh::capInBuffer( const double* axis, double radius, MeshBufNum_t bufNum ) const
+{
+    if ( bufNum >= NUM_MESH_BUF )
+        return true;
+
+    double sum = radius + m_bufRadius[bufNum];
+    if ( sum >= 180.0 )
+        return true;
+
+    const double* center = m_bufCenter[bufNum];
+    double dot = axis[0] * center[0] + axis[1] * center[1] + axis[2] * center[2];
+    return dot >= cos( sum * dms::DegToRad );
+}
+
+SkyPoint SkyMesh::apertureCenter( const SkyPoint *p0 )
 {
-    KStarsData* data = KStarsData::Instance();
     // FIXME: simple copying leads to incorrect results because RA0 && dec0 are both zero sometimes
     SkyPoint p1( p0->ra(), p0->dec() );
-    long double now = data->updateNum()->julianDay();
+    long double now = KStarsData::Instance()->updateNum()->julianDay();
     p1.apparentCoord( now, J2000 );
+    return p1;
+}
+
+void SkyMesh::aperture( MeshBuffer* result, const SkyPoint *p0, double radius ) const
+{
+    SkyPoint p1 = apertureCenter( p0 );
+    HTMesh::intersect( result, p1.ra().Degrees(), p1.dec().Degrees(), radius );
+}
+
+void SkyMesh::aperture( MeshAperture* result, const SkyPoint *p0, double radius ) const
+{
+    SkyPoint p1 = apertureCenter( p0 );
+    result->update( p1.ra().Degrees(), p1.dec().Degrees(), radius );
+}
+
+void SkyMesh::aperture(SkyPoint *p0, double radius, MeshBufNum_t bufNum)
+{
+    KStarsData* data = KStarsData::Instance();
+    SkyPoint p1 = apertureCenter( p0 );
 
     if ( radius == 1.0 ) {
         printf("\n ra0 = %8.4f   dec0 = %8.4f\n", p0->ra().Degrees(), p0->dec().Degrees() );
@@ -82,7 +141,19 @@ void SkyMesh::aperture(SkyPoint *p0, double radius, MeshBufNum_t bufNum)
         printf("p0 - p2 = %6.4f degrees\n", p0->angularDistanceTo( &p2 ).Degrees() );
     }
 
-    HTMesh::intersect( p1.ra().Degrees(), p1.dec().Degrees(), radius, (BufNum) bufNum);
+    if ( bufNum == DRAW_BUF ) {
+        // The draw aperture usually moves only a little between frames
+        m_drawAperture->update( p1.ra().Degrees(), p1.dec().Degrees(), radius );
+        MeshBuffer* buffer = meshBuffer( DRAW_BUF );
+        buffer->reset();
+        MeshIterator visible( m_drawAperture->visible() );
+        while ( visible.hasNext() )
+            buffer->append( visible.next() );
+    }
+    else {
+        HTMesh::intersect( p1.ra().Degrees(), p1.dec().Degrees(), radius, (BufNum) bufNum);
+    }
+    setBufCircle( p1.ra(), p1.dec(), radius, bufNum );
     m_drawID++;
 
     return;
@@ -90,7 +161,12 @@ void SkyMesh::aperture(SkyPoint *p0, double radius, MeshBufNum_t bufNum)
         printf("Warining: overlapping buffer: %d\n", bufNum);
 }
 
-Trixel SkyMesh::index(const SkyPoint* p)
+void SkyMesh::index( MeshBuffer* result, const SkyPoint *p, double radius ) const
+{
+    HTMesh::intersect( result, p->ra().Degrees(), p->dec().Degrees(), radius );
+}
+
+Trixel SkyMesh::index(const SkyPoint* p) const
 {
     return HTMesh::index( p->ra0().Degrees(), p->dec0().Degrees() );
 }
@@ -102,6 +178,13 @@ Trixel SkyMesh::indexStar( StarObject *star )
     return HTMesh::index( ra, dec );
 }
 
+Trixel SkyMesh::indexStar( StarObject *star, KSNumbers *num ) const
+{
+    double ra, dec;
+    star->getIndexCoords( num, &ra, &dec );
+    return HTMesh::index( ra, dec );
+}
+
 void SkyMesh::indexStar( StarObject* star1, StarObject* star2 )
 {
     double ra1, ra2, dec1, dec2;
@@ -114,6 +197,7 @@ void SkyMesh::indexStar( StarObject* star1, StarObject* star2 )
 void SkyMesh::index(const SkyPoint *p, double radius, MeshBufNum_t bufNum )
 {
     HTMesh::intersect( p->ra().Degrees(), p->dec().Degrees(), radius, (BufNum) bufNum );
+    setBufCircle( p->ra(), p->dec(), radius, bufNum );
 
     return;
     if ( m_inDraw && bufNum != DRAW_BUF )
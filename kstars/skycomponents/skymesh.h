@@ -30,11 +30,13 @@
 #include "htmesh/HTMesh.h"
 #include "htmesh/MeshIterator.h"
 #include "htmesh/MeshBuffer.h"
+#include "htmesh/MeshAperture.h"
 
 #include "typedef.h"
 
 class KSNumbers;
 class StarObject;
+class dms;
 
 class SkyPoint;
 class QPolygonF;
@@ -99,6 +101,8 @@ protected:
     SkyMesh( SkyMesh& skyMesh );
 
 public:
+    ~SkyMesh();
+
     /* @short creates the single instance of SkyMesh.  The level indicates
      * how fine a mesh we will use. The number of triangles (trixels) in the
      * mesh will be 8 * 4^level so a mesh of level 5 will have 8 * 4^5 = 8 *
@@ -135,9 +139,27 @@ public:
      */
     void aperture( SkyPoint *center, double radius, MeshBufNum_t bufNum=DRAW_BUF );
 
+    /* @short reentrant version of aperture() that puts the trixels in the
+     * caller's buffer.  It leaves the drawID and the numbered buffers alone
+     * so it is safe to call from other threads and while drawing.
+     */
+    void aperture( MeshBuffer* result, const SkyPoint *center, double radius ) const;
+
+    /* @short moves the caller's MeshAperture to the aperture around center.
+     * Small moves are handled incrementally, see MeshAperture.  Like the
+     * version above it leaves the drawID and the numbered buffers alone.
+     */
+    void aperture( MeshAperture* result, const SkyPoint *center, double radius ) const;
+
+    /* @short returns the tracker behind DRAW_BUF.  Its entered() and left()
+     * buffers hold the trixels that came into and went out of view with the
+     * last aperture() call on DRAW_BUF.
+     */
+    const MeshAperture* drawAperture() const { return m_drawAperture; }
+
     /* @short returns the index of the trixel containing p.
      */
-    Trixel index( const SkyPoint *p );
+    Trixel index( const SkyPoint *p ) const;
 
     /**
      * @short returns the sky region needed to cover the rectangle defined by two
@@ -168,6 +190,11 @@ public:
      */
     Trixel indexStar( StarObject *star );
 
+    /* @short reentrant version of the above that takes the time from num
+     * instead of setKSNumbers().
+     */
+    Trixel indexStar( StarObject *star, KSNumbers *num ) const;
+
     /* @short fills the default buffer with all the trixels needed to cover
      * the line connecting the two stars.
      */
@@ -204,6 +231,11 @@ public:
      */
     void index( const SkyPoint *center, double radius, MeshBufNum_t bufNum=DRAW_BUF );
 
+    /* @short reentrant version of the above that puts the trixels in the
+     * caller's buffer.
+     */
+    void index( MeshBuffer* result, const SkyPoint *center, double radius ) const;
+
     /* @short finds the indices of the trixels covering the line segment
      * connecting p1 and p2.
      */
@@ -283,6 +315,15 @@ public:
      */
     int incDrawID() { return ++m_drawID; }
 
+    /* @short returns false if a cap with unit vector axis and the given
+     * radius (in degrees) cannot overlap the circle last passed to
+     * aperture() or index() for bufNum.  The axis must be in the same
+     * frame as that circle: J2000 for the apertures, unprecessed for
+     * NO_PRECESS_BUF.  Used by LineListIndex to reject long lines whose
+     * trixels are visible but whose points are not.
+     */
+    bool capInBuffer( const double* axis, double radius, MeshBufNum_t bufNum ) const;
+
     /* @short Draws the outline of all the trixels in the specified buffer.
      * This was very useful during debugging.  I don't precess the points
      * because I mainly use it with the IN_CONSTELL_BUF which is not
@@ -297,6 +338,9 @@ public:
     void inDraw( bool inDraw ) { m_inDraw = inDraw; }
 
 private:
+    /* @short remembers the circle used to fill bufNum for capInBuffer() */
+    void setBufCircle( const dms& ra, const dms& dec, double radius, MeshBufNum_t bufNum );
+
     DrawID m_drawID;
     int    errLimit;
     int    m_debug;
@@ -305,6 +349,9 @@ private:
     KSNumbers   m_KSNumbers;
 
     bool        m_inDraw;
+    MeshAperture* m_drawAperture;
+    double      m_bufCenter[NUM_MESH_BUF][3];
+    double      m_bufRadius[NUM_MESH_BUF];
     static int defaultLevel;
     static QMap<int, SkyMesh *> pinstances;
 };
@@ -111,8 +111,8 @@ void SolarSystemComposite::drawTrails( SkyPainter* skyp )
             comp->drawTrails( skyp );
 }
 
-const QList<SkyObject*>& SolarSystemComposite::asteroids() const {
-    return m_AsteroidsComponent->objectList();
+QList<SkyObject*> SolarSystemComposite::asteroids( double magLimit ) {
+    return m_AsteroidsComponent->brighterThan( magLimit );
 }
 
 const QList<SkyObject*>& SolarSystemComposite::comets() const {
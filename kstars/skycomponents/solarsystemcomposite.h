@@ -45,7 +45,7 @@ public:
     ~SolarSystemComposite();
 
     KSPlanet* earth() { return m_Earth; }
-    const QList<SkyObject*>& asteroids() const;
+    QList<SkyObject*> asteroids( double magLimit );
     const QList<SkyObject*>& comets() const;
 
     bool selected();
@@ -19,6 +19,8 @@
 #include "solarsystemcomposite.h"
 
 #include <QPen>
+#include <QThread>
+#include <QtConcurrentMap>
 #include <klocale.h>
 
 #include "Options.h"
@@ -27,6 +29,29 @@
 #include "kstarsdata.h"
 #include "skymap.h"
 
+namespace {
+    // Bodies per parallel batch; fewer are done on the calling thread
+    const int BatchSize = 256;
+
+    struct UpdateBatch {
+        KSPlanetBase * const *bodies;
+        int count;
+        const KSNumbers *num;
+        const dms *lat;
+        const dms *lst;
+        const KSPlanetBase *earth;
+    };
+
+    void updateBatch( UpdateBatch &batch )
+    {
+        for ( int i = 0; i < batch.count; ++i ) {
+            KSPlanetBase *p = batch.bodies[i];
+            p->findPosition( batch.num, batch.lat, batch.lst, batch.earth );
+            p->EquatorialToHorizontal( batch.lst, batch.lat );
+        }
+    }
+}
+
 SolarSystemListComponent::SolarSystemListComponent( SolarSystemComposite *p ) :
     ListComponent( p ),
     m_Earth( p->earth() )
@@ -50,16 +75,56 @@ void SolarSystemListComponent::update(KSNumbers * ) {
 
 void SolarSystemListComponent::updatePlanets(KSNumbers *num ) {
     if ( selected() ) {
-        KStarsData *data = KStarsData::Instance(); 
+        QVector<KSPlanetBase*> bodies;
+        bodies.reserve( m_ObjectList.size() );
         foreach ( SkyObject *o, m_ObjectList ) {
             KSPlanetBase *p = (KSPlanetBase*)o;
-            p->findPosition( num, data->geo()->lat(), data->lst(), m_Earth );
-            p->EquatorialToHorizontal( data->lst(), data->geo()->lat() );
+            if ( p->hasTrail() || ! skipUpdate( p, num ) )
+                bodies.append( p );
+        }
+        updateBodies( bodies, num );
+    }
+}
+
+bool SolarSystemListComponent::skipUpdate( KSPlanetBase *, const KSNumbers * ) {
+    return false;
+}
 
-            if ( p->hasTrail() )
-                p->updateTrail( data->lst(), data->geo()->lat() );
+void SolarSystemListComponent::updateBodies( const QVector<KSPlanetBase*> &bodies, KSNumbers *num ) {
+    KStarsData *data = KStarsData::Instance();
+    const dms *lat = data->geo()->lat();
+    const dms *lst = data->lst();
+
+    QVector<KSPlanetBase*> parallel;
+    parallel.reserve( bodies.size() );
+    foreach ( KSPlanetBase *p, bodies ) {
+        if ( p->hasTrail() ) {
+            p->findPosition( num, lat, lst, m_Earth );
+            p->EquatorialToHorizontal( lst, lat );
+            p->updateTrailWindow( num->julianDay() );
+            p->updateTrail( lst, lat );
+        } else {
+            parallel.append( p );
         }
     }
+
+    QList<UpdateBatch> batches;
+    for ( int i = 0; i < parallel.size(); i += BatchSize ) {
+        UpdateBatch batch;
+        batch.bodies = parallel.constData() + i;
+        batch.count  = qMin( BatchSize, parallel.size() - i );
+        batch.num    = num;
+        batch.lat    = lat;
+        batch.lst    = lst;
+        batch.earth  = m_Earth;
+        batches.append( batch );
+    }
+
+    if ( batches.size() > 1 && QThread::idealThreadCount() > 1 )
+        QtConcurrent::blockingMap( batches, updateBatch );
+    else
+        for ( int i = 0; i < batches.size(); ++i )
+            updateBatch( batches[i] );
 }
 
 
@@ -20,7 +20,10 @@
 
 #include "listcomponent.h"
 
+#include <QVector>
+
 class KSPlanet;
+class KSPlanetBase;
 class SolarSystemComposite;
 
 /**
@@ -49,6 +52,23 @@ public:
 protected:
     void drawTrails( SkyPainter* skyp );
 
+    /**@short Decide whether a body can be skipped by updatePlanets().
+     *
+     * Components with many faint bodies reimplement this to skip the bodies
+     * that can not be seen at the time of num. The default skips nothing.
+     * @return true if the position of p is not needed
+     */
+    virtual bool skipUpdate( KSPlanetBase *p, const KSNumbers *num );
+
+    /**@short Compute the positions of bodies for the time of num.
+     *
+     * Bodies without trails are computed in parallel batches; this returns
+     * when all of them are done, so the positions never change while the
+     * sky is drawn. Bodies with trails are done on the calling thread since
+     * the set of trail objects is shared.
+     */
+    void updateBodies( const QVector<KSPlanetBase*> &bodies, KSNumbers *num );
+
 private:
     KSPlanet *m_Earth;
 };
@@ -84,8 +84,10 @@ void SolarSystemSingleComponent::updatePlanets(KSNumbers *num) {
         KStarsData *data = KStarsData::Instance(); 
         m_Planet->findPosition( num, data->geo()->lat(), data->lst(), m_Earth );
         m_Planet->EquatorialToHorizontal( data->lst(), data->geo()->lat() );
-        if ( m_Planet->hasTrail() )
+        if ( m_Planet->hasTrail() ) {
+            m_Planet->updateTrailWindow( num->julianDay() );
             m_Planet->updateTrail( data->lst(), data->geo()->lat() );
+        }
     }
 }
 
@@ -53,7 +53,7 @@
 StarComponent *StarComponent::pinstance = 0;
 
 StarComponent::StarComponent(SkyComposite *parent )
-    : ListComponent(parent), m_reindexNum(J2000), m_FaintMagnitude(-5.0),
+    : ListComponent(parent), m_indexVersion(0), m_reindexNum(J2000), m_FaintMagnitude(-5.0),
       starsLoaded(false), focusStar(NULL)
 {
     m_skyMesh = SkyMesh::Instance();
@@ -140,7 +140,8 @@ void StarComponent::reindex( KSNumbers *num )
 
     // otherwise we just re-index fast movers as needed
     for ( int j = 0; j < m_highPMStars.size(); j++ )
-        m_highPMStars.at( j )->reindex( num, m_starIndex );
+        if( m_highPMStars.at( j )->reindex( num, m_starIndex ) )
+            ++m_indexVersion;
 }
 
 void StarComponent::reindexAll( KSNumbers *num )
@@ -162,6 +163,7 @@ void StarComponent::reindexAll( KSNumbers *num )
 
     m_reindexNum = KSNumbers( *num );
     m_skyMesh->setKSNumbers( num );
+    ++m_indexVersion;
 
     // clear out the old index
     for ( int i = 0; i < m_starIndex->size(); i++ ) {
@@ -231,6 +233,9 @@ float StarComponent::zoomMagnitudeLimit() {
 
 void StarComponent::draw( SkyPainter *skyp )
 {
+    for ( int i = 0; i <= MAX_LINENUMBER_MAG; i++ )
+        m_labelList[ i ]->clear();
+
     if( !selected() )
         return;
 
@@ -288,11 +293,38 @@ void StarComponent::draw( SkyPainter *skyp )
 
     int nTrixels = 0;
 
+    // Only stars get drawn from here on, so let the painter batch them
+    skyp->beginPointSources();
+
     while( region.hasNext() ) {
         ++nTrixels;
         Trixel currentRegion = region.next();
         StarList* starList = m_starIndex->at( currentRegion );
 
+        // Painters that keep the trixel resident on the GPU only need
+        // the stars that get a label.
+        if( skyp->drawStarTrixel( currentRegion, starList, maglim, m_indexVersion ) ) {
+            if( m_hideLabels )
+                continue;
+            for (int i=0; i < starList->size(); ++i) {
+                StarObject *curStar = starList->at( i );
+                if( !curStar )
+                    continue;
+                float mag = curStar->mag();
+                if ( mag > maglim || mag > labelMagLim )
+                    break;
+                if ( curStar->updateID != updateID )
+                    curStar->JITupdate();
+                if ( proj->checkVisibility( curStar ) ) {
+                    bool visible = false;
+                    QPointF o = proj->toScreen( curStar, true, &visible );
+                    if( visible && proj->onScreen( o ) )
+                        addLabel( o, curStar );
+                }
+            }
+            continue;
+        }
+
         for (int i=0; i < starList->size(); ++i) {
             StarObject *curStar = starList->at( i );
             if( !curStar )
@@ -327,6 +359,8 @@ void StarComponent::draw( SkyPainter *skyp )
     for( int i =0; i < m_DeepStarComponents.size(); ++i ) {
         m_DeepStarComponents.at( i )->draw( skyp );
     }
+
+    skyp->flushPointSources();
 }
 
 void StarComponent::addLabel( const QPointF& p, StarObject *star )
@@ -344,6 +378,7 @@ void StarComponent::drawLabels()
 
     SkyLabeler *labeler = SkyLabeler::Instance();
     labeler->setPen( QColor( KStarsData::Instance()->colorScheme()->colorNamed( "SNameColor" ) ) );
+    const Projector *proj = SkyMap::Instance()->projector();
 
     int max = int( m_zoomMagLimit * 10.0 );
     if ( max < 0 ) max = 0;
@@ -352,9 +387,11 @@ void StarComponent::drawLabels()
     for ( int i = 0; i <= max; i++ ) {
         LabelList* list = m_labelList[ i ];
         for ( int j = 0; j < list->size(); j++ ) {
+            // the star may have set since it was drawn into a cached layer
+            if ( ! proj->checkVisibility( list->at(j).obj ) )
+                continue;
             labeler->drawNameLabel( list->at(j).obj, list->at(j).o );
         }
-        list->clear();
     }
 
 }
@@ -511,6 +548,34 @@ SkyObject* StarComponent::findByName( const QString &name ) {
     return 0;
 }
 
+QList<SkyObject*> StarComponent::findByNames( const QStringList &names ) {
+    QList<SkyObject*> result;
+    QHash<QString, QList<int> > wanted; // lower case name -> positions in names
+    for ( int i = 0; i < names.size(); ++i ) {
+        result.append( 0 );
+        if ( ! names[i].isEmpty() )
+            wanted[ names[i].toLower() ].append( i );
+    }
+
+    foreach( SkyObject* o, m_ObjectList ) {
+        if ( wanted.isEmpty() )
+            break;
+        // The names findByName() compares
+        QString keys[4] = { o->name(), o->longname(), o->name2(), ((StarObject *)o)->gname(false) };
+        for ( int k = 0; k < 4; ++k ) {
+            if ( keys[k].isEmpty() )
+                continue;
+            QHash<QString, QList<int> >::iterator it = wanted.find( keys[k].toLower() );
+            if ( it != wanted.end() ) {
+                foreach ( int i, it.value() )
+                    result[i] = o;
+                wanted.erase( it );
+            }
+        }
+    }
+    return result;
+}
+
 void StarComponent::objectsInArea( QList<SkyObject*>& list, const SkyRegion& region )
 {
     for( SkyRegion::const_iterator it = region.constBegin(); it != region.constEnd(); ++it )
@@ -627,7 +692,7 @@ void StarComponent::starsInAperture( QList<StarObject*> &list, const SkyPoint &c
         for (int i=0; i < starList->size(); ++i) {
             StarObject* star =  starList->at( i );
             if( !star ) continue;
-            if ( star->mag() > m_FaintMagnitude ) continue;
+            if ( star->mag() > maglim ) continue;
             if( star->angularDistanceTo( &center ).Degrees() <= radius )
                 list.append( star );
         }
@@ -81,8 +81,9 @@ public:
 
     void draw( SkyPainter *skyp );
 
-    /* @short draw all the labels in the prioritized LabelLists and then
-     * clear the LabelLists. */
+    /* @short draw all the labels in the prioritized LabelLists.  The
+     * LabelLists are cleared by draw() so the labels of a cached sky layer
+     * can be drawn again without redrawing the stars. */
     void drawLabels();
 
     static float zoomMagnitudeLimit();
@@ -103,6 +104,17 @@ public:
      */
     virtual SkyObject* findByName( const QString &name );
 
+    /**
+     *@short Find many stars by name in one pass over the stars
+     *
+     * Gives the same results as calling findByName() for each name, but
+     * walks the star list only once.
+     *
+     *@param names  Names to search for
+     *@return  The stars, in the order of names; NULL where no star matches
+     */
+    QList<SkyObject*> findByNames( const QStringList &names );
+
     /**
      * @short Searches the region(s) and appends the SkyObjects found to the list of sky objects
      *
@@ -166,6 +178,7 @@ private:
     
     SkyMesh*       m_skyMesh;
     StarIndex*     m_starIndex;
+    int            m_indexVersion;   // Bumped whenever stars move between trixels
 
     KSNumbers      m_reindexNum;
     double         m_reindexInterval;
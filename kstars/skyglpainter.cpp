@@ -27,10 +27,13 @@
 
 #include <GL/gl.h>
 #include <QGLWidget>
+#include <QGLBuffer>
+#include <QGLShaderProgram>
 
 #include "skymap.h"
 #include "kstarsdata.h"
 #include "Options.h"
+#include "frameprofiler.h"
 
 #include "texturemanager.h"
 
@@ -48,17 +51,126 @@
 #include "skyobjects/trailobject.h"
 #include "skyobjects/satellite.h"
 #include "skyobjects/supernova.h"
+#include "skyobjects/starobject.h"
+
+// Not in every gl.h, these are core since OpenGL 2.0
+#ifndef GL_VERTEX_PROGRAM_POINT_SIZE
+#define GL_VERTEX_PROGRAM_POINT_SIZE 0x8642
+#endif
+#ifndef GL_POINT_SPRITE
+#define GL_POINT_SPRITE 0x8861
+#endif
+
+// Above this zoom level the nutation and aberration left out by the
+// star shader become visible, so stars go through drawPointSource().
+#define STAR_SHADER_MAXZOOM 1.e4
+
+namespace {
+
+/* GLSL 1.20 keeps this working on Mesa's llvmpipe. Stars come in as
+ * J2000 unit vectors; toHoriz takes them to the horizontal frame
+ * (x = cos(alt)cos(az), y = cos(alt)sin(az), z = sin(alt)) and toView
+ * rotates either frame so that z points at the focus, x east and y north,
+ * which is what Projector::toScreenVec() works out with trigonometry. */
+const char *starVertexShader =
+    "#version 120\n"
+    "attribute vec3 position;\n"
+    "attribute float mag;\n"
+    "attribute vec3 color;\n"
+    "uniform mat3 toHoriz;\n"
+    "uniform mat3 toView;\n"
+    "uniform bool useAltAz;\n"
+    "uniform bool useRefraction;\n"
+    "uniform bool fillGround;\n"
+    "uniform int projection;\n"
+    "uniform float cosMaxFieldAngle;\n"
+    "uniform float zoom;\n"
+    "uniform vec2 screenSize;\n"
+    "uniform float sizeFactor;\n"
+    "uniform float sizeMagLim;\n"
+    "varying vec3 starColor;\n"
+    "\n"
+    "// SkyPoint::refract(), in degrees\n"
+    "float refract(float alt) {\n"
+    "    const float altCrit = -1.0;\n"
+    "    float corrCrit = 1.02 / tan(radians(altCrit + 10.3/(altCrit + 5.11))) / 60.0;\n"
+    "    if( alt > altCrit )\n"
+    "        return alt + 1.02 / tan(radians(alt + 10.3/(alt + 5.11))) / 60.0;\n"
+    "    return alt + corrCrit * (alt + 90.0) / (altCrit + 90.0);\n"
+    "}\n"
+    "\n"
+    "void main() {\n"
+    "    starColor = color;\n"
+    "    gl_PointSize = clamp(sizeFactor*(sizeMagLim - mag)/sizeMagLim + 1.0, 1.0, 10.0);\n"
+    "    // Anything outside the clip volume is dropped\n"
+    "    gl_Position = vec4(2.0, 2.0, 2.0, 1.0);\n"
+    "    vec3 h = toHoriz * position;\n"
+    "    if( fillGround && h.z < sin(radians(-1.0)) )\n"
+    "        return;\n"
+    "    if( useAltAz && useRefraction ) {\n"
+    "        float r = length(h.xy);\n"
+    "        float alt = radians(refract(degrees(asin(clamp(h.z, -1.0, 1.0)))));\n"
+    "        if( r > 0.0 )\n"
+    "            h = vec3(h.xy * (cos(alt)/r), sin(alt));\n"
+    "    }\n"
+    "    vec3 v = toView * (useAltAz ? h : position);\n"
+    "    float c = v.z;\n"
+    "    if( c <= cosMaxFieldAngle )\n"
+    "        return;\n"
+    "    float k;\n"
+    "    if( projection == %1 ) {\n"
+    "        k = sqrt(2.0/(1.0 + c));\n"
+    "    } else if( projection == %2 ) {\n"
+    "        float a = acos(clamp(c, -1.0, 1.0));\n"
+    "        k = a > 0.0 ? a/sin(a) : 1.0;\n"
+    "    } else if( projection == %3 ) {\n"
+    "        k = 1.0;\n"
+    "    } else if( projection == %4 ) {\n"
+    "        k = 1.0/c;\n"
+    "    } else {\n"
+    "        k = 2.0/(1.0 + c);\n"
+    "    }\n"
+    "    vec2 p = 0.5*screenSize - zoom*k*v.xy;\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix * vec4(p, 0.0, 1.0);\n"
+    "}\n";
+
+const char *starFragmentShader =
+    "#version 120\n"
+    "uniform sampler2D starTexture;\n"
+    "varying vec3 starColor;\n"
+    "void main() {\n"
+    "    gl_FragColor = vec4(starColor, 1.0) * texture2D(starTexture, gl_PointCoord);\n"
+    "}\n";
+
+QMatrix3x3 toQMatrix( const Matrix3f& m )
+{
+    qreal values[9];
+    for(int i = 0; i < 3; ++i)
+        for(int j = 0; j < 3; ++j)
+            values[3*i + j] = m(i,j);
+    return QMatrix3x3( values );
+}
+
+// Star colors are baked into the vertex buffers
+int starColorKey()
+{
+    return 100*Options::starColorMode() + Options::starColorIntensity();
+}
+
+}
 
 Vector2f SkyGLPainter::m_vertex[NUMTYPES][6*BUFSIZE];
 Vector2f SkyGLPainter::m_texcoord[NUMTYPES][6*BUFSIZE];
 Vector3f SkyGLPainter::m_color[NUMTYPES][6*BUFSIZE];
 int      SkyGLPainter::m_idx[NUMTYPES];
 bool     SkyGLPainter::m_init = false;
+QHash<const QGLContext*, SkyGLPainter::StarResources*> SkyGLPainter::m_starResources;
 
 
                                  
 SkyGLPainter::SkyGLPainter( QGLWidget *widget ) :
-                                     SkyPainter()
+                                     SkyPainter(),
+                                     m_starFrameState(0)
 {
     m_widget = widget;
     if( !m_init ) {
@@ -77,6 +189,26 @@ SkyGLPainter::SkyGLPainter( QGLWidget *widget ) :
         //Generate textures that were loaded before the SkyMap was
         m_init = true;
     }
+    m_stars = m_starResources.value( widget->context() );
+    if( !m_stars ) {
+        m_stars = new StarResources;
+        m_stars->program = 0;
+        m_stars->programFailed = false;
+        m_starResources.insert( widget->context(), m_stars );
+    }
+}
+
+void SkyGLPainter::releaseContext( const QGLContext *context )
+{
+    StarResources *res = m_starResources.take( context );
+    if( !res )
+        return;
+    foreach( StarTrixelBuffer *buf, res->buffers ) {
+        delete buf->vbo;
+        delete buf;
+    }
+    delete res->program;
+    delete res;
 }
 
 void SkyGLPainter::drawBuffer(int type)
@@ -143,6 +275,17 @@ bool SkyGLPainter::addItem(SkyPoint* p, int type, float width, char sp)
     m_vertex[type][i + 4] = vec + Vector2f( w,-w);
     m_vertex[type][i + 5] = vec + Vector2f( w, w);
 
+    Vector3f c = pointColor(sp);
+    for(int j = 0; j < 6; ++j) {
+        m_color[type][i+j] = c;
+    }
+    
+    ++m_idx[type];
+    return true;
+}
+
+Vector3f SkyGLPainter::pointColor(char sp) const
+{
     Vector3f c(1.,1.,1.);
     if( sp != 'x' && Options::starColorMode() != 0 ) {
         // We have a star and aren't drawing real star colors
@@ -179,14 +322,8 @@ bool SkyGLPainter::addItem(SkyPoint* p, int type, float width, char sp)
 
         // Get RGB ratios and put them in 'c'
         c = Vector3f( starColor.redF(), starColor.greenF(), starColor.blueF() );
-
     }
-    for(int j = 0; j < 6; ++j) {
-        m_color[type][i+j] = c;
-    }
-    
-    ++m_idx[type];
-    return true;
+    return c;
 }
 
 void SkyGLPainter::drawTexturedRectangle( const QImage& img,
@@ -341,6 +478,192 @@ bool SkyGLPainter::drawPointSource(SkyPoint* loc, float mag, char sp)
     return addItem(loc, SkyObject::STAR, starWidth(mag), sp);
 }
 
+bool SkyGLPainter::setupStarProgram()
+{
+    if( m_starFrameState )
+        return m_starFrameState > 0;
+    m_starFrameState = -1;
+
+    // Equirectangular is not an azimuthal projection, the shader can't do it
+    ViewParams vp = m_proj->viewParams();
+    if( m_stars->programFailed || m_proj->type() == SkyMap::Equirectangular ||
+        vp.zoomFactor > STAR_SHADER_MAXZOOM )
+        return false;
+
+    if( !m_stars->program ) {
+        m_stars->programFailed = true;
+        if( !QGLShaderProgram::hasOpenGLShaderPrograms( m_widget->context() ) )
+            return false;
+        m_stars->program = new QGLShaderProgram( m_widget->context() );
+        QString vertexSource = QString( starVertexShader )
+            .arg( SkyMap::Lambert ).arg( SkyMap::AzimuthalEquidistant )
+            .arg( SkyMap::Orthographic ).arg( SkyMap::Gnomonic );
+        if( !m_stars->program->addShaderFromSourceCode( QGLShader::Vertex, vertexSource ) ||
+            !m_stars->program->addShaderFromSourceCode( QGLShader::Fragment, starFragmentShader ) ||
+            !m_stars->program->link() ) {
+            kWarning() << "Star shader failed, drawing stars one by one:" << m_stars->program->log();
+            delete m_stars->program;
+            m_stars->program = 0;
+            return false;
+        }
+        m_stars->programFailed = false;
+    }
+
+    KStarsData *data = KStarsData::Instance();
+    KSNumbers *num = data->updateNum();
+
+    // Precession from J2000, see SkyPoint::precess()
+    Matrix3f P;
+    for(int i = 0; i < 3; ++i)
+        for(int j = 0; j < 3; ++j)
+            P(i,j) = num->p2( j, i );
+
+    // Equatorial to horizontal, see SkyPoint::EquatorialToHorizontal()
+    double sinLST, cosLST, sinLat, cosLat;
+    data->lst()->SinCos( sinLST, cosLST );
+    data->geo()->lat()->SinCos( sinLat, cosLat );
+    Matrix3f H;
+    H << -sinLat*cosLST, -sinLat*sinLST, cosLat,
+         -sinLST,         cosLST,        0,
+          cosLat*cosLST,  cosLat*sinLST, sinLat;
+
+    // Rotate the focus onto the z axis
+    double sinX0, cosX0, sinY0, cosY0;
+    if( vp.useAltAz ) {
+        vp.focus->az().SinCos( sinX0, cosX0 );
+        vp.focus->alt().SinCos( sinY0, cosY0 );
+    } else {
+        vp.focus->ra().SinCos( sinX0, cosX0 );
+        vp.focus->dec().SinCos( sinY0, cosY0 );
+    }
+    Matrix3f V;
+    if( vp.useAltAz )
+        V.row(0) << sinX0, -cosX0, 0;
+    else
+        V.row(0) << -sinX0, cosX0, 0;
+    V.row(1) << -sinY0*cosX0, -sinY0*sinX0, cosY0;
+    V.row(2) <<  cosY0*cosX0,  cosY0*sinX0, sinY0;
+
+    Matrix3f toHoriz = H*P;
+    Matrix3f toView = vp.useAltAz ? V : Matrix3f( V*P );
+
+    m_stars->program->bind();
+    m_stars->program->setUniformValue( "toHoriz", toQMatrix( toHoriz ) );
+    m_stars->program->setUniformValue( "toView", toQMatrix( toView ) );
+    m_stars->program->setUniformValue( "useAltAz", (GLint)vp.useAltAz );
+    m_stars->program->setUniformValue( "useRefraction", (GLint)vp.useRefraction );
+    m_stars->program->setUniformValue( "fillGround", (GLint)vp.fillGround );
+    m_stars->program->setUniformValue( "projection", (GLint)m_proj->type() );
+    m_stars->program->setUniformValue( "cosMaxFieldAngle", (GLfloat)m_proj->cosMaxFieldAngle() );
+    m_stars->program->setUniformValue( "zoom", (GLfloat)vp.zoomFactor );
+    m_stars->program->setUniformValue( "screenSize", (GLfloat)vp.width, (GLfloat)vp.height );
+    // Same size as starWidth()
+    m_stars->program->setUniformValue( "sizeFactor", (GLfloat)( 10.0 + log10( vp.zoomFactor ) - log10( MINZOOM ) ) );
+    m_stars->program->setUniformValue( "sizeMagLim", (GLfloat)sizeMagLimit() );
+    m_stars->program->setUniformValue( "starTexture", (GLint)0 );
+    m_stars->program->release();
+
+    m_starFrameState = 1;
+    return true;
+}
+
+void SkyGLPainter::uploadStarTrixel(StarTrixelBuffer *buf, const StarList* stars, int version)
+{
+    KSNumbers *num = KStarsData::Instance()->updateNum();
+
+    QVector<float> vertices;
+    vertices.reserve( 7*stars->size() );
+    buf->mags.clear();
+    buf->maxPM = 0;
+    for(int i = 0; i < stars->size(); ++i) {
+        StarObject *star = stars->at( i );
+        if( !star )
+            continue;
+        double ra, dec, sinRA, cosRA, sinDec, cosDec;
+        star->getIndexCoords( num, &ra, &dec );
+        dms( ra ).SinCos( sinRA, cosRA );
+        dms( dec ).SinCos( sinDec, cosDec );
+        Vector3f c = pointColor( star->spchar() );
+        vertices << cosDec*cosRA << cosDec*sinRA << sinDec << star->mag()
+                 << c[0] << c[1] << c[2];
+        buf->mags.append( star->mag() );
+        buf->maxPM = qMax( buf->maxPM, star->pmMagnitude() );
+    }
+
+    if( !buf->vbo ) {
+        buf->vbo = new QGLBuffer( QGLBuffer::VertexBuffer );
+        buf->vbo->setUsagePattern( QGLBuffer::StaticDraw );
+        buf->vbo->create();
+    }
+    buf->vbo->bind();
+    buf->vbo->allocate( vertices.constData(), vertices.size()*sizeof(float) );
+    buf->vbo->release();
+
+    buf->version  = version;
+    buf->size     = stars->size();
+    buf->colorKey = starColorKey();
+    buf->millenia = num->julianMillenia();
+}
+
+bool SkyGLPainter::drawStarTrixel(Trixel trixel, const StarList* stars, float maglim, int version)
+{
+    if( !setupStarProgram() )
+        return false;
+
+    StarTrixelBuffer *buf = m_stars->buffers.value( trixel );
+    if( !buf ) {
+        buf = new StarTrixelBuffer;
+        buf->vbo = 0;
+        buf->version = -1;
+        m_stars->buffers.insert( trixel, buf );
+    }
+
+    // Re-upload if stars moved between trixels, the colors changed or
+    // proper motion has moved a star by more than an arcsecond.
+    double millenia = KStarsData::Instance()->updateNum()->julianMillenia();
+    if( buf->version != version || buf->size != stars->size() ||
+        buf->colorKey != starColorKey() ||
+        buf->maxPM * fabs( millenia - buf->millenia ) > 1.0 )
+        uploadStarTrixel( buf, stars, version );
+    if( !buf->vbo->isCreated() )
+        return false;
+
+    int count = qUpperBound( buf->mags.constBegin(), buf->mags.constEnd(), maglim ) - buf->mags.constBegin();
+    if( count == 0 )
+        return true;
+
+    glEnable( GL_TEXTURE_2D );
+    TextureManager::bindTexture( "star", m_widget );
+    glEnable( GL_BLEND );
+    glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+    glDisable( GL_POINT_SMOOTH );
+    glEnable( GL_POINT_SPRITE );
+    glEnable( GL_VERTEX_PROGRAM_POINT_SIZE );
+
+    const int stride = 7*sizeof(float);
+    m_stars->program->bind();
+    buf->vbo->bind();
+    m_stars->program->enableAttributeArray( "position" );
+    m_stars->program->enableAttributeArray( "mag" );
+    m_stars->program->enableAttributeArray( "color" );
+    m_stars->program->setAttributeBuffer( "position", GL_FLOAT, 0, 3, stride );
+    m_stars->program->setAttributeBuffer( "mag", GL_FLOAT, 3*sizeof(float), 1, stride );
+    m_stars->program->setAttributeBuffer( "color", GL_FLOAT, 4*sizeof(float), 3, stride );
+
+    glDrawArrays( GL_POINTS, 0, count );
+
+    m_stars->program->disableAttributeArray( "position" );
+    m_stars->program->disableAttributeArray( "mag" );
+    m_stars->program->disableAttributeArray( "color" );
+    buf->vbo->release();
+    m_stars->program->release();
+
+    glDisable( GL_VERTEX_PROGRAM_POINT_SIZE );
+    glDisable( GL_POINT_SPRITE );
+    glEnable( GL_POINT_SMOOTH );
+    return true;
+}
+
 void SkyGLPainter::drawSkyPolygon(LineList* list)
 {
     SkyList *points = list->points();
@@ -634,6 +957,7 @@ void SkyGLPainter::drawSkyBackground()
 
 void SkyGLPainter::end()
 {
+    FrameProfiler::Scope scope( "GL flush" );
     for(int i = 0; i < NUMTYPES; ++i) {
         drawBuffer(i);
     }
@@ -642,6 +966,7 @@ void SkyGLPainter::end()
 void SkyGLPainter::begin()
 {
     m_proj = m_sm->projector();
+    m_starFrameState = 0;
     
     //Load ortho projection
     glViewport(0,0,m_widget->width(),m_widget->height());
@@ -24,19 +24,31 @@
 #include <Eigen/Core>
 using namespace Eigen;
 
+#include <QHash>
+#include <QVector>
+
 #include "skypainter.h"
 #include "skyobjects/skyobject.h"
 #include "projections/projector.h"
 
 class QGLWidget;
+class QGLContext;
+class QGLBuffer;
+class QGLShaderProgram;
 
 class SkyGLPainter : public SkyPainter
 {
 public:
     explicit SkyGLPainter( QGLWidget *widget );
+
+    /** Deletes the star buffers and shader made for context. Call it while
+     *  the context is still current, before it is destroyed. */
+    static void releaseContext( const QGLContext *context );
+
     virtual bool drawPlanet(KSPlanetBase* planet);
     virtual bool drawDeepSkyObject(DeepSkyObject* obj, bool drawImage = false);
     virtual bool drawPointSource(SkyPoint* loc, float mag, char sp = 'A');
+    virtual bool drawStarTrixel(Trixel trixel, const StarList* stars, float maglim, int version);
     virtual void drawSkyPolygon(LineList* list);
     virtual void drawSkyPolyline(LineList* list, SkipList* skipList = 0, LineListLabel* label = 0);
     virtual void drawSkyLine(SkyPoint* a, SkyPoint* b);
@@ -52,7 +64,33 @@ public:
     virtual bool drawSupernova(Supernova* sup);
     void drawText( int x, int y, const QString text, QFont font, QColor color );
 private:
+    /** Star geometry of one trixel, resident in a vertex buffer. Each
+     *  vertex holds the J2000 unit vector, magnitude and color of a star. */
+    struct StarTrixelBuffer {
+        QGLBuffer *vbo;
+        QVector<float> mags;   ///< magnitudes in vertex order, ascending
+        int   version;         ///< index version the buffer was built for
+        int   size;            ///< size of the star list it was built from
+        int   colorKey;        ///< star color options it was built with
+        double millenia;       ///< epoch the proper motions were applied for
+        double maxPM;          ///< largest proper motion in the trixel, mas/yr
+    };
+
+    /** GL objects of the star shader path. They belong to one GL context,
+     *  so painters of the same context share them from frame to frame. */
+    struct StarResources {
+        QHash<Trixel, StarTrixelBuffer*> buffers;
+        QGLShaderProgram *program;
+        bool programFailed;
+    };
+
     bool addItem(SkyPoint* p, int type, float width, char sp = 'a');
+    /** @return the color of a point source of spectral type sp */
+    Vector3f pointColor(char sp) const;
+    /** Set the uniforms of the star shader for this frame.
+     *  @return false if the shader path can't be used for this frame */
+    bool setupStarProgram();
+    void uploadStarTrixel(StarTrixelBuffer *buf, const StarList* stars, int version);
     void drawBuffer(int type);
     void drawPolygon(const QVector< Vector2f >& poly, bool convex = true, bool flush_buffers = true);
 
@@ -73,6 +111,9 @@ private:
     static Vector3f m_color[NUMTYPES][6*BUFSIZE];
     static int m_idx[NUMTYPES];
     static bool m_init; ///< keep track of whether we have filled the texcoord array
+    static QHash<const QGLContext*, StarResources*> m_starResources;
+    StarResources *m_stars; ///< the star resources of m_widget's context
+    int m_starFrameState; ///< 0: uniforms not yet set, 1: ready, -1: unusable this frame
     QGLWidget* m_widget; // Pointer to (GL) widget on which we are painting
 };
 
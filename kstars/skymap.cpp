@@ -144,7 +144,7 @@ SkyMap* SkyMap::Instance( )
 
 SkyMap::SkyMap() : 
     QGraphicsView( KStars::Instance() ),
-    computeSkymap(true), rulerMode(false),
+    computeSkymap(true), computeStaticLayer(true), rulerMode(false),
     data( KStarsData::Instance() ), pmenu(0),
     ClickedObject(0), FocusObject(0), m_proj(0),
     m_previewLegend(false), m_objPointingMode(false)
@@ -983,6 +983,13 @@ void SkyMap::setZoomFactor(double factor) {
 // if now=true, SkyMap::paintEvent() is run immediately, rather than being added to the event queue
 // also, determine new coordinates of mouse cursor.
 void SkyMap::forceUpdate( bool now )
+{
+    // Anything but the clock may have changed what the static layer shows
+    computeStaticLayer = true;
+    forceClockUpdate( now );
+}
+
+void SkyMap::forceClockUpdate( bool now )
 {
     QPoint mp( mapFromGlobal( QCursor::pos() ) );
     if (! projector()->unusablePoint( mp )) {
@@ -1022,30 +1029,34 @@ void SkyMap::setupProjector() {
         m_proj->setViewParams(p);
     else {
         delete m_proj;
-        switch( Options::projection() ) {
-            case Gnomonic:
-                m_proj = new GnomonicProjector(p);
-                break;
-            case Stereographic:
-                m_proj = new StereographicProjector(p);
-                break;
-            case Orthographic:
-                m_proj = new OrthographicProjector(p);
-                break;
-            case AzimuthalEquidistant:
-                m_proj = new AzimuthalEquidistantProjector(p);
-                break;
-            case Equirectangular:
-                m_proj = new EquirectangularProjector(p);
-                break;
-            case Lambert: default:
-                //TODO: implement other projection classes
-                m_proj = new LambertProjector(p);
-                break;
-        }
+        m_proj = createProjector( Options::projection(), p );
     }
 }
 
+Projector* SkyMap::createProjector( int type, const ViewParams& p ) {
+    switch( type ) {
+        case Gnomonic:
+            return new GnomonicProjector(p);
+        case Stereographic:
+            return new StereographicProjector(p);
+        case Orthographic:
+            return new OrthographicProjector(p);
+        case AzimuthalEquidistant:
+            return new AzimuthalEquidistantProjector(p);
+        case Equirectangular:
+            return new EquirectangularProjector(p);
+        case Lambert: default:
+            //TODO: implement other projection classes
+            return new LambertProjector(p);
+    }
+}
+
+Projector* SkyMap::swapProjector( Projector *proj ) {
+    Projector *old = m_proj;
+    m_proj = proj;
+    return old;
+}
+
 void SkyMap::setZoomMouseCursor()
 {
     mouseMoveCursor = false;	// no mousemove cursor
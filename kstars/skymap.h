@@ -46,6 +46,7 @@ class SkyObject;
 class InfoBoxWidget;
 class InfoBoxes;
 class Projector;
+class ViewParams;
 
 class QGraphicsScene;
 
@@ -74,7 +75,7 @@ class SkyMap : public QGraphicsView {
     Q_OBJECT
         
     friend class SkyMapDrawAbstract; // FIXME: SkyMapDrawAbstract requires a lot of access to SkyMap
-    friend class SkyMapQDraw; // FIXME: SkyMapQDraw requires access to computeSkymap
+    friend class SkyMapQDraw; // FIXME: SkyMapQDraw requires access to computeSkymap and m_proj
 
  protected:
     /**
@@ -236,6 +237,20 @@ class SkyMap : public QGraphicsView {
     /** @short Call to set up the projector before a draw cycle. */
     void setupProjector();
 
+    /** @short Creates a projector of the given projection type.
+        @param type the projection, as in Options::projection()
+        @param p the view to project onto
+        @return a new projector owned by the caller
+        */
+    static Projector* createProjector( int type, const ViewParams& p );
+
+    /** @short Makes @p proj the projector used for drawing.
+        Used to draw views other than the sky map's own, e.g. by BatchChartExporter.
+        @return the previous projector, which the caller owns until it is
+        swapped back in
+        */
+    Projector* swapProjector( Projector *proj );
+
     /**@ Set zoom factor.
       *@param factor zoom factor
       */
@@ -300,6 +315,13 @@ public slots:
      */
     void forceUpdate( bool now=false );
 
+    /**@short Recalculates the sky after the simulation clock advanced.
+     * Unlike forceUpdate() this keeps the cached static sky layer, which
+     * the QPainter renderer then only redraws if the view actually moved.
+     * @param now if true, paintEvent() is run immediately.  Otherwise, it is added to the event queue
+     */
+    void forceClockUpdate( bool now=false );
+
     /**@short Convenience function; simply calls forceUpdate(true).
      * @see forceUpdate()
      */
@@ -596,6 +618,9 @@ private:
     //if false only old pixmap will repainted with bitBlt(), this
     // saves a lot of cpu usage
     bool computeSkymap;
+    //if false and the view did not change, the cached static sky layer
+    // is reused; cleared by forceUpdate() but not by clock updates
+    bool computeStaticLayer;
     // True if we are either looking for angular distance or star hopping directions
     bool rulerMode;
     // True only if we are looking for star hopping directions. If
@@ -24,11 +24,16 @@
 
 #include <QPainter>
 #include <QPixmap>
+#include <QPicture>
+#include <QImage>
+#include <QThread>
+#include <QtConcurrentMap>
 
 #include "skymapdrawabstract.h"
 #include "skymap.h"
 #include "Options.h"
 #include "fov.h"
+#include "frameprofiler.h"
 #include "kstars.h"
 #include "kstarsdata.h"
 #include "ksnumbers.h"
@@ -58,6 +63,25 @@
 
 bool SkyMapDrawAbstract::m_DrawLock = false;
 
+namespace {
+    // One horizontal strip of the image painted by rasterizeTiled()
+    struct SkyTile {
+        uchar *bits;
+        int top, width, height, bytesPerLine;
+        QImage::Format format;
+        QPicture picture;
+    };
+
+    void paintSkyTile( SkyTile &tile ) {
+        // Wrap the rows of the target image so no compositing is needed
+        QImage strip( tile.bits, tile.width, tile.height, tile.bytesPerLine, tile.format );
+        QPainter p( &strip );
+        p.translate( 0, -tile.top );
+        tile.picture.play( &p );
+        p.end();
+    }
+}
+
 SkyMapDrawAbstract::SkyMapDrawAbstract( SkyMap *sm ) :
     m_KStarsData( KStarsData::Instance() ), m_SkyMap( sm ) {
     m_fpstime.start();
@@ -69,7 +93,10 @@ void SkyMapDrawAbstract::drawOverlays( QPainter& p, bool drawFov ) {
         return;
 
     //draw labels
-    SkyLabeler::Instance()->draw(p);
+    {
+        FrameProfiler::Scope scope( "Draw labels" );
+        SkyLabeler::Instance()->draw(p);
+    }
 
     if( drawFov ) {
         //draw FOV symbol
@@ -91,6 +118,9 @@ void SkyMapDrawAbstract::drawOverlays( QPainter& p, bool drawFov ) {
         m_SkyMap->updateAngleRuler();
         drawAngleRuler( p );
     }
+
+    if ( Options::showDrawProfile() )
+        FrameProfiler::Instance()->drawOverlay( p, p.viewport() );
 }
 
 void SkyMapDrawAbstract::drawAngleRuler( QPainter &p ) {
@@ -332,6 +362,35 @@ void SkyMapDrawAbstract::exportSkyImage(SkyQPainter *painter, bool scale)
     painter->setVectorStars( vectorStarState ); // Restore the state of the painter
 }
 
+void SkyMapDrawAbstract::rasterizeTiled( const QPicture &picture, QImage *image ) {
+    if( image->isNull() )
+        return;
+
+    int count = qMax( 1, QThread::idealThreadCount() );
+    int rows = ( image->height() + count - 1 ) / count;
+
+    // bits() detaches the image here, in the calling thread
+    uchar *bits = image->bits();
+
+    QList<SkyTile> tiles;
+    for( int top = 0; top < image->height(); top += rows ) {
+        SkyTile tile;
+        tile.bits = bits + top * image->bytesPerLine();
+        tile.top = top;
+        tile.width = image->width();
+        tile.height = qMin( rows, image->height() - top );
+        tile.bytesPerLine = image->bytesPerLine();
+        tile.format = image->format();
+        // QPicture::play() reads through a shared buffer, so every tile
+        // plays its own deep copy of the picture
+        tile.picture = picture;
+        tile.picture.detach();
+        tiles.append( tile );
+    }
+
+    QtConcurrent::blockingMap( tiles, paintSkyTile );
+}
+
 void SkyMapDrawAbstract::calculateFPS()
 {
     if(m_framecount == 25) {
@@ -25,6 +25,8 @@
 
 class SkyMap;
 class SkyQPainter;
+class QPicture;
+class QImage;
 
 /**
  *@short This class defines the methods that both rendering engines
@@ -105,6 +107,17 @@ class SkyMapDrawAbstract {
       */
     void exportSkyImage( SkyQPainter *painter, bool scale = false );
 
+    /**@short Rasterize a recorded sky picture into an image using several threads.
+      * The image is split into horizontal strips which are painted concurrently,
+      * each by its own QPainter working directly on the rows of @p image.
+      * Only the rasterization runs in parallel: the picture must already hold
+      * the finished scene, so the components, SkyMesh and SkyLabeler are only
+      * ever touched by the GUI thread.
+      *@param picture the scene, recorded with a SkyQPainter on a QPicture
+      *@param image the image to paint on. It must already have its final size.
+      */
+    static void rasterizeTiled( const QPicture &picture, QImage *image );
+
     /**@short Draw "user labels".  User labels are name labels attached to objects manually with
      * the right-click popup menu.  Also adds a label to the FocusObject if the Option UseAutoLabel
      * is true.
@@ -23,6 +23,7 @@
 #include "skyglpainter.h"
 #include "skymapgldraw.h"
 #include "skymap.h"
+#include "frameprofiler.h"
 
 
 SkyMapGLDraw::SkyMapGLDraw( SkyMap *sm ) :
@@ -35,6 +36,13 @@ SkyMapGLDraw::SkyMapGLDraw( SkyMap *sm ) :
         qWarning() << "No stencil buffer; can't draw concave polygons";
 }
 
+SkyMapGLDraw::~SkyMapGLDraw()
+{
+    // The context goes away with QGLWidget, so free its buffers now
+    makeCurrent();
+    SkyGLPainter::releaseContext( context() );
+}
+
 void SkyMapGLDraw::initializeGL()
 {
 }
@@ -58,6 +66,7 @@ void SkyMapGLDraw::paintEvent( QPaintEvent *event )
     p.begin(this);
     p.beginNativePainting();
     calculateFPS();
+    FrameProfiler::Instance()->beginFrame();
     m_SkyMap->setupProjector();
     makeCurrent();
 
@@ -75,5 +84,6 @@ void SkyMapGLDraw::paintEvent( QPaintEvent *event )
     drawOverlays(p);
     p.end();
 
+    FrameProfiler::Instance()->endFrame();
     setDrawLock( false );
 }
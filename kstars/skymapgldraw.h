@@ -38,6 +38,11 @@ class SkyMapGLDraw : public QGLWidget, public SkyMapDrawAbstract {
      */
     explicit SkyMapGLDraw( SkyMap *parent );
 
+    /**
+     *@short Destructor. Frees the GL objects SkyGLPainter made for our context
+     */
+    virtual ~SkyMapGLDraw();
+
  protected:
 
     virtual void paintEvent( QPaintEvent *e );
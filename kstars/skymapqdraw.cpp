@@ -19,13 +19,96 @@
 #include "skyqpainter.h"
 #include "skymap.h"
 #include "printing/legend.h"
+#include "projections/projector.h"
+#include "kstarsdata.h"
+#include "ksnumbers.h"
+#include "Options.h"
+#include "frameprofiler.h"
+
+#include <QPicture>
+#include <QImage>
+
+SkyMapQDraw::StaticLayerKey::StaticLayerKey() :
+    focusRA(0.0), focusDec(0.0), zoomFactor(0.0), lst(0.0), updateJD(0.0),
+    width(0), height(0), projection(-1),
+    useAltAz(false), useRefraction(false), slewing(false) {
+}
+
+bool SkyMapQDraw::StaticLayerKey::operator==( const StaticLayerKey &other ) const {
+    return focusRA == other.focusRA && focusDec == other.focusDec &&
+        zoomFactor == other.zoomFactor && lst == other.lst &&
+        updateJD == other.updateJD &&
+        width == other.width && height == other.height &&
+        projection == other.projection && useAltAz == other.useAltAz &&
+        useRefraction == other.useRefraction && slewing == other.slewing;
+}
 
 SkyMapQDraw::SkyMapQDraw( SkyMap *sm ) : QWidget( sm ), SkyMapDrawAbstract( sm ) {
     m_SkyPixmap = new QPixmap( width(), height() );
+    m_StaticPixmap = new QPixmap( width(), height() );
 }
 
 SkyMapQDraw::~SkyMapQDraw() {
     delete m_SkyPixmap;
+    delete m_StaticPixmap;
+}
+
+SkyMapQDraw::StaticLayerKey SkyMapQDraw::staticLayerKey() const {
+    StaticLayerKey key;
+    key.focusRA       = m_SkyMap->focus()->ra().Degrees();
+    key.focusDec      = m_SkyMap->focus()->dec().Degrees();
+    key.zoomFactor    = Options::zoomFactor();
+    key.updateJD      = m_KStarsData->updateNum()->julianDay();
+    key.width         = width();
+    key.height        = height();
+    key.projection    = Options::projection();
+    key.useAltAz      = Options::useAltAz();
+    key.useRefraction = Options::useRefraction();
+    key.slewing       = m_SkyMap->isSlewing();
+    // In horizontal coordinates everything turns with the sidereal time.
+    // In equatorial coordinates only the horizontal grid does.
+    if ( Options::useAltAz() || Options::showHorizontalGrid() )
+        key.lst = m_KStarsData->lst()->Degrees();
+    return key;
+}
+
+void SkyMapQDraw::drawStaticLayer() {
+    // In equatorial coordinates the horizon turns with the clock, so the
+    // layer is drawn without hiding what is below it.  The ground drawn by
+    // the dynamic layer covers whatever has set.
+    bool keepBelowHorizon = !Options::useAltAz();
+    if ( keepBelowHorizon ) {
+        ViewParams vp = m_SkyMap->m_proj->viewParams();
+        vp.fillGround = false;
+        m_SkyMap->m_proj->setViewParams( vp );
+    }
+
+    if ( Options::useTiledRendering() ) {
+        // Walk the scene once in this thread, then rasterize it in strips
+        QPicture picture;
+        SkyQPainter psky( &picture, size() );
+        psky.begin();
+        psky.drawSkyBackground();
+        m_KStarsData->skyComposite()->draw( &psky, SkyMapComposite::StaticLayer );
+        psky.end();
+
+        FrameProfiler::Scope scope( "Rasterize" );
+        QImage image( size(), QImage::Format_ARGB32_Premultiplied );
+        rasterizeTiled( picture, &image );
+        *m_StaticPixmap = QPixmap::fromImage( image );
+    } else {
+        SkyQPainter psky( this, m_StaticPixmap );
+        psky.begin();
+        psky.drawSkyBackground();
+        m_KStarsData->skyComposite()->draw( &psky, SkyMapComposite::StaticLayer );
+        psky.end();
+    }
+
+    if ( keepBelowHorizon )
+        m_SkyMap->setupProjector();
+
+    m_StaticKey = staticLayerKey();
+    m_SkyMap->computeStaticLayer = false;
 }
 
 void SkyMapQDraw::paintEvent( QPaintEvent *event ) {
@@ -38,7 +121,8 @@ void SkyMapQDraw::paintEvent( QPaintEvent *event ) {
     setDrawLock( true );
 
     calculateFPS();
-
+    FrameProfiler *profiler = FrameProfiler::Instance();
+    profiler->beginFrame();
 
     //If computeSkymap is false, then we just refresh the window using the stored sky pixmap
     //and draw the "overlays" on top.  This lets us update the overlay information rapidly
@@ -55,6 +139,7 @@ void SkyMapQDraw::paintEvent( QPaintEvent *event ) {
             drawOverlays(p);
             p.end();
 
+            profiler->endFrame();
             setDrawLock( false );
             return ; // exit because the pixmap is repainted and that's all what we want
         }
@@ -63,21 +148,31 @@ void SkyMapQDraw::paintEvent( QPaintEvent *event ) {
     // Not elegant at all. Should find better option
     m_SkyMap->showFocusCoords();
     m_SkyMap->setupProjector();
-    
+
+    //The background, lines, deep-sky objects and stars are only redrawn
+    //when the view moved or something other than the clock changed.
+    if ( m_SkyMap->computeStaticLayer || !( staticLayerKey() == m_StaticKey ) ) {
+        FrameProfiler::Scope scope( "Static layer" );
+        drawStaticLayer();
+    }
+    *m_SkyPixmap = *m_StaticPixmap;
+
     SkyQPainter psky(this, m_SkyPixmap); 
     //FIXME: we may want to move this into the components.
     psky.begin();
     
-    //Draw all sky elements
-    psky.drawSkyBackground();
-    m_KStarsData->skyComposite()->draw( &psky );
+    //Draw the remaining sky elements on top of the static layer
+    m_KStarsData->skyComposite()->draw( &psky, SkyMapComposite::DynamicLayer );
     //Finish up
     psky.end();
     
     QPainter psky2;
     psky2.begin( this );
     psky2.drawLine(0,0,1,1); // Dummy op.
-    psky2.drawPixmap( 0, 0, *m_SkyPixmap );
+    {
+        FrameProfiler::Scope scope( "Blit" );
+        psky2.drawPixmap( 0, 0, *m_SkyPixmap );
+    }
     drawOverlays(psky2);
     psky2.end();
 
@@ -88,6 +183,7 @@ void SkyMapQDraw::paintEvent( QPaintEvent *event ) {
 
     m_SkyMap->computeSkymap = false;	// use forceUpdate() to compute new skymap else old pixmap will be shown
 
+    profiler->endFrame();
     setDrawLock( false );
 
 }
@@ -96,4 +192,6 @@ void SkyMapQDraw::resizeEvent( QResizeEvent *e ) {
     Q_UNUSED(e);
     delete m_SkyPixmap;
     m_SkyPixmap = new QPixmap( width(), height() );
+    delete m_StaticPixmap;
+    m_StaticPixmap = new QPixmap( width(), height() );
 }
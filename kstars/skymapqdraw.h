@@ -51,6 +51,38 @@ class SkyMapQDraw : public QWidget, public SkyMapDrawAbstract {
     virtual void resizeEvent( QResizeEvent *e );
 
     QPixmap *m_SkyPixmap;
+
+ private:
+    /**
+     *@short Everything the static sky layer depends on apart from the
+     * options, which invalidate it through SkyMap::forceUpdate().
+     */
+    struct StaticLayerKey {
+        StaticLayerKey();
+        bool operator==( const StaticLayerKey &other ) const;
+
+        double focusRA, focusDec;
+        double zoomFactor;
+        double lst;        // only set when objects move with the clock
+        double updateJD;   // precession epoch of the star positions
+        int width, height;
+        int projection;
+        bool useAltAz, useRefraction, slewing;
+    };
+
+    /**
+     *@return the key describing the current view
+     */
+    StaticLayerKey staticLayerKey() const;
+
+    /**
+     *@short Draw the background and the static layer of the sky
+     * composite into m_StaticPixmap.
+     */
+    void drawStaticLayer();
+
+    QPixmap *m_StaticPixmap;
+    StaticLayerKey m_StaticKey;
     
 };
 
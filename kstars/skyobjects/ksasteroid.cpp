@@ -19,6 +19,8 @@
 
 #include <kdebug.h>
 
+#include <limits>
+
 #include "dms.h"
 #include "ksnumbers.h"
 #include "kstarsdata.h"
@@ -26,7 +28,9 @@
 KSAsteroid::KSAsteroid( int _catN, const QString &s, const QString &imfile,
                         long double _JD, double _a, double _e, dms _i, dms _w, dms _Node, dms _M, double _H, double _G )
         : KSPlanetBase(s, imfile),
-          catN(_catN), JD(_JD), a(_a), e(_e), i(_i), w(_w), M(_M), N(_Node), H(_H), G(_G)
+          catN(_catN), JD(_JD), SolvedJD(0),
+          MagBound( -std::numeric_limits<double>::infinity() ),
+          a(_a), e(_e), i(_i), w(_w), M(_M), N(_Node), H(_H), G(_G)
 {
     setType( SkyObject::ASTEROID );
     //Compute the orbital Period from Kepler's 3rd law:
@@ -90,6 +94,8 @@ bool KSAsteroid::findGeocentricPosition( const KSNumbers *num, const KSPlanetBas
     helEcPos.longitude.setRadians( ELongRad );
     helEcPos.latitude.setRadians( ELatRad );
     setRsun( r );
+    SolvedJD = num->julianDay();
+    MagBound = -std::numeric_limits<double>::infinity();
 
     if ( Earth ) {
         //xe, ye, ze are the Earth's heliocentric cartesian coords
@@ -133,6 +139,50 @@ void KSAsteroid::findMagnitude(const KSNumbers*)
     setMag( H + param - 2.5 * log( (1 - G) * phi1 + G * phi2 ) );
 }
 
+double KSAsteroid::brightestMagnitude( long double jd ) const
+{
+    const double boundDays = 30.0;
+    const double k = 0.01720209895; //Gauss gravitational constant
+
+    if ( e >= 1.0 )
+        return -std::numeric_limits<double>::infinity();
+
+    double rmin = a * ( 1.0 - e );
+    double rmax = a * ( 1.0 + e );
+    double days = fabs( double( jd - SolvedJD ) );
+    if ( SolvedJD > 0 && days <= boundDays ) {
+        // The distance from the Sun changes by at most k*e/sqrt(p) AU per day
+        double dr = days * k * e / sqrt( a * ( 1.0 - e*e ) );
+        rmin = qMax( rmin, rsun() - dr );
+        rmax = qMin( rmax, rsun() + dr );
+    }
+
+    return brightestMagnitude( H, G, rmin, rmax );
+}
+
+double KSAsteroid::brightestMagnitude( double H, double G, double rmin, double rmax )
+{
+    const double earthPerihelion = 0.9833, earthAphelion = 1.0167; // AU
+
+    // The phase term only makes the asteroid fainter for 0 <= G <= 1
+    if ( G < 0.0 || G > 1.0 )
+        return -std::numeric_limits<double>::infinity();
+
+    // The distance from the Earth is at least the difference of the
+    // distances from the Sun, so r * delta is smallest at an end of [rmin, rmax]
+    double closest;
+    if ( rmin > earthAphelion )
+        closest = rmin * ( rmin - earthAphelion );
+    else if ( rmax < earthPerihelion )
+        closest = qMin( rmin * ( earthPerihelion - rmin ), rmax * ( earthPerihelion - rmax ) );
+    else
+        closest = 0.0;
+
+    if ( closest <= 0.0 )
+        return -std::numeric_limits<double>::infinity();
+    return H + 5 * log10( closest );
+}
+
 void KSAsteroid::setPerihelion( double perihelion )
 {
     q = perihelion;
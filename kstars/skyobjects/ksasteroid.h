@@ -83,6 +83,42 @@ public:
     double inline getAbsoluteMagnitude() const { return H; }
     double inline getSlopeParameter() const { return G; }
 
+    /**
+     *@short A magnitude the asteroid can not be brighter than at the given time.
+     *The bound follows from the perihelion and aphelion distances of the
+     *orbit and of the Earth's orbit. Within a month of the last computed
+     *position the distances the asteroid can have reached since are used
+     *instead, which gives a much tighter bound.
+     *@param jd the Julian Day
+     *@return the bound, or -infinity if the asteroid may get arbitrarily bright
+     */
+    double brightestMagnitude( long double jd ) const;
+
+    /**
+     *@short A magnitude an asteroid can not be brighter than while its
+     *distance from the Sun is between rmin and rmax
+     *@return the bound, or -infinity if the asteroid may get arbitrarily bright
+     */
+    static double brightestMagnitude( double H, double G, double rmin, double rmax );
+
+    /**
+     *@return the Julian Day of the last computed position, 0 if none
+     */
+    inline long double solvedJD() const { return SolvedJD; }
+
+    /**
+     *@short Records that an update left the position alone because the
+     *asteroid could not be brighter than bound. Mag and position keep the
+     *values of the last computation.
+     */
+    inline void setMagnitudeBound( double bound ) { MagBound = bound; }
+
+    /**
+     *@return the bound of the last skipped update, or -infinity if the
+     *position was computed since
+     */
+    inline double magnitudeBound() const { return MagBound; }
+
     /**
      *@short Sets the asteroid's perihelion distance
      */
@@ -206,7 +242,8 @@ private:
     virtual void findMagnitude(const KSNumbers*);
     
     int catN;
-    long double JD;
+    long double JD, SolvedJD;
+    double MagBound;
     double q, a, e, P, EarthMOID;
     float Albedo, Diameter, RotationPeriod, Period;
     dms i, w, M, N;
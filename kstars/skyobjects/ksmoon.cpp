@@ -28,6 +28,7 @@
 
 #include "ksnumbers.h"
 #include "ksutils.h"
+#include "ephemerisfile.h"
 #include "kssun.h"
 #include "kstarsdata.h"
 #include "kspopupmenu.h"
@@ -100,6 +101,35 @@ bool KSMoon::loadData() {
     if (data_loaded)
         return true;
 
+    // Use the compiled ephemeris if it has both tables
+    EphemerisFile *ephemeris = EphemerisFile::Instance();
+    int lrRows, bRows;
+    const double *lr = ephemeris->table( "moonLR.dat", 6, &lrRows );
+    const double *b = ephemeris->table( "moonB.dat", 5, &bRows );
+    if ( lr && b ) {
+        for ( int i = 0; i < lrRows; ++i, lr += 6 ) {
+            MoonLRData d;
+            d.nd  = int( lr[0] );
+            d.nm  = int( lr[1] );
+            d.nm1 = int( lr[2] );
+            d.nf  = int( lr[3] );
+            d.Li  = lr[4];
+            d.Ri  = lr[5];
+            LRData.append( d );
+        }
+        for ( int i = 0; i < bRows; ++i, b += 5 ) {
+            MoonBData d;
+            d.nd  = int( b[0] );
+            d.nm  = int( b[1] );
+            d.nm1 = int( b[2] );
+            d.nf  = int( b[3] );
+            d.Bi  = b[4];
+            BData.append( d );
+        }
+        data_loaded = true;
+        return true;
+    }
+
     QStringList fields;
     QFile f;
 
@@ -28,6 +28,7 @@
 #include "ksnumbers.h"
 #include "ksutils.h"
 #include "ksfilereader.h"
+#include "ephemerisfile.h"
 
 KSPlanet::OrbitDataManager KSPlanet::odm;
 
@@ -41,6 +42,20 @@ KSPlanet::OrbitDataManager::OrbitDataManager() {
 bool KSPlanet::OrbitDataManager::readOrbitData(const QString &fname,
         QVector<OrbitData> *vector)
 {
+    // The compiled ephemeris holds the terms as A, B, C triples
+    int rows;
+    const double *terms = EphemerisFile::Instance()->table( fname, 3, &rows );
+    if ( terms ) {
+        vector->resize( rows );
+        for ( int i = 0; i < rows; ++i, terms += 3 ) {
+            OrbitData &term = (*vector)[i];
+            term.A = terms[0];
+            term.B = terms[1];
+            term.C = terms[2];
+        }
+        return true;
+    }
+
     QFile f;
 
     if ( KSUtils::openDataFile( f, fname ) ) {
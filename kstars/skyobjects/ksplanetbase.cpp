@@ -110,9 +110,6 @@ void KSPlanetBase::updateCoords( KSNumbers *num, bool includePlanets, const dms
 
         if ( lat && LST ) {
             findPosition( num, lat, LST, kd->skyComposite()->earth() );
-            //Don't add to the trail this time
-            if( hasTrail() )
-                Trail.takeLast();
         } else {
             findGeocentricPosition( num, kd->skyComposite()->earth() );
         }
@@ -128,12 +125,6 @@ void KSPlanetBase::findPosition( const KSNumbers *num, const dms *lat, const dms
     if ( lat && LST )
         localizeCoords( num, lat, LST ); //correct for figure-of-the-Earth
 
-    if ( hasTrail() ) {
-        addToTrail();
-        if ( Trail.size() > TrailObject::MaxTrail )
-            clipTrail();
-    }
-
     findMagnitude(num);
 
     if ( type() == SkyObject::COMET ) {
@@ -148,6 +139,108 @@ void KSPlanetBase::findPosition( const KSNumbers *num, const dms *lat, const dms
 
 }
 
+namespace {
+    /// Largest distance (radians) between the trail and the body's path, half an arcminute
+    const double TrailTolerance = 0.5 / 60.0 * dms::DegToRad;
+    /// Intervals the trail window is split into before refining
+    const int TrailIntervals = 32;
+    /// Times an interval may be halved
+    const int TrailMaxDepth = 10;
+    /// Upper bound on the points of one trail
+    const int TrailMaxPoints = 4096;
+
+    struct TrailSample {
+        long double jd;
+        dms ra0, dec0;
+        Vector3d v;
+    };
+
+    /** Computes the J2000 position of a copy of a body at given times */
+    class TrailSampler {
+    public:
+        TrailSampler( KSPlanetBase *body, KSPlanetBase *earth, const GeoLocation *geo ) :
+            m_body( body ), m_earth( earth ), m_geo( geo ), m_count( 0 ) {}
+
+        TrailSample sample( long double jd ) {
+            KSNumbers num( jd );
+            dms lst = m_geo->GSTtoLST( KStarsDateTime( jd ).gst() );
+            m_earth->findPosition( &num );
+            m_body->findPosition( &num, m_geo->lat(), &lst, m_earth );
+
+            TrailSample s;
+            SkyPoint p = m_body->deprecess( &num );
+            s.jd   = jd;
+            s.ra0  = p.ra();
+            s.dec0 = p.dec();
+            s.v    = KSUtils::fromSperical( s.ra0, s.dec0 );
+            m_count++;
+            return s;
+        }
+
+        /** Appends the samples between a and b (not a and b themselves) */
+        void refine( const TrailSample &a, const TrailSample &b, int depth, TrailPolyline *trail ) {
+            TrailSample mid = sample( 0.5 * ( a.jd + b.jd ) );
+            Vector3d chord = a.v + b.v;
+            if ( chord.norm() > 0.0 && ( mid.v - chord.normalized() ).norm() <= TrailTolerance )
+                return;
+            if ( depth >= TrailMaxDepth || m_count >= TrailMaxPoints ) {
+                trail->append( mid.jd, mid.ra0, mid.dec0 );
+                return;
+            }
+            refine( a, mid, depth + 1, trail );
+            trail->append( mid.jd, mid.ra0, mid.dec0 );
+            refine( mid, b, depth + 1, trail );
+        }
+
+    private:
+        KSPlanetBase *m_body;
+        KSPlanetBase *m_earth;
+        const GeoLocation *m_geo;
+        int m_count;
+    };
+}
+
+void KSPlanetBase::addToTrail() {
+    long double jd = KStarsData::Instance()->ut().djd();
+    double halfSpan = 0.5 * Options::planetTrailDays();
+    computeTrail( jd - halfSpan, jd + halfSpan );
+}
+
+void KSPlanetBase::computeTrail( long double jd0, long double jd1 ) {
+    KStarsData *data = KStarsData::Instance();
+
+    // Work on copies, so neither this body nor the Earth of the sky map moves
+    KSPlanetBase *body = static_cast<KSPlanetBase*>( clone() );
+    body->clearTrail();
+    KSPlanetBase *earth = data->skyComposite()->earth()->clone();
+
+    TrailSampler sampler( body, earth, data->geo() );
+    TrailPolyline trail;
+    TrailSample a = sampler.sample( jd0 );
+    trail.append( a.jd, a.ra0, a.dec0 );
+    for ( int i = 1; i <= TrailIntervals; ++i ) {
+        TrailSample b = sampler.sample( jd0 + ( jd1 - jd0 ) * i / TrailIntervals );
+        sampler.refine( a, b, 0, &trail );
+        trail.append( b.jd, b.ra0, b.dec0 );
+        a = b;
+    }
+
+    delete body;
+    delete earth;
+
+    Polyline = trail;
+    trailObjects.insert( this );
+}
+
+void KSPlanetBase::updateTrailWindow( long double jd ) {
+    if ( Polyline.isEmpty() )
+        return;
+    long double quarter = 0.25 * ( Polyline.endJD() - Polyline.startJD() );
+    if ( jd >= Polyline.startJD() + quarter && jd <= Polyline.endJD() - quarter )
+        return;
+    computeTrail( jd - 2 * quarter, jd + 2 * quarter );
+}
+
 bool KSPlanetBase::isMajorPlanet() const {
     if ( name() == i18n( "Mercury" ) || name() == i18n( "Venus" ) || name() == i18n( "Mars" ) ||
          name() == i18n( "Jupiter" ) || name() == i18n( "Saturn" ) || name() == i18n( "Uranus" ) ||
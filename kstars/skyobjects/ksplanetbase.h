@@ -159,6 +159,27 @@ public:
      */
     void findPosition( const KSNumbers *num, const dms *lat=0, const dms *LST=0, const KSPlanetBase *Earth = 0 );
 
+    /**@short Starts a trail computed ahead of time, covering PlanetTrailDays
+     * centered on the current time (reimplemented from TrailObject).
+     * The trail moves along as the time leaves the middle of the window.
+     */
+    virtual void addToTrail();
+
+    /**@short Computes the trail over the time window from jd0 to jd1.
+     *
+     * Positions are sampled more densely where the path bends, so that
+     * the polyline stays within half an arcminute of the body's path.
+     * This body and the Earth are not moved; the positions are computed
+     * on copies.
+     */
+    void computeTrail( long double jd0, long double jd1 );
+
+    /**@short Recomputes the trail around jd when jd is no longer in the
+     * middle half of the trail's time window. Called when the simulation
+     * clock moves the body, not when its position is found for another date.
+     */
+    void updateTrailWindow( long double jd );
+
     /** @return the Planet's position angle. */
     virtual double pa() const { return PositionAngle; }
 
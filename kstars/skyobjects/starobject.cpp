@@ -28,6 +28,7 @@
 #include "kstarsdata.h"
 #include "Options.h"
 #include "skymap.h"
+#include "frameprofiler.h"
 
 // DEBUG EDIT. Uncomment for testing Proper Motion
 //#include "skycomponents/skymesh.h"
@@ -319,6 +320,7 @@ void StarObject::JITupdate()
     static KStarsData *data = KStarsData::Instance();
 
     if ( updateNumID != data->updateNumID() ) {
+        FrameProfiler::count( FrameProfiler::StarJITUpdates );
         // TODO: This can be optimized and reorganized further in a better manner.
         // Maybe we should do this only for stars, since this is really a slow step only for stars
         Q_ASSERT( std::isfinite( lastPrecessJD ) );
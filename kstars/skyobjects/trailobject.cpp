@@ -65,6 +65,7 @@ void TrailObject::clipTrail() {
 
 void TrailObject::clearTrail() {
     Trail.clear();
+    Polyline.clear();
     trailObjects.remove( this );
 }
 
@@ -83,12 +84,18 @@ void TrailObject::clearTrailsExcept(SkyObject* o) {
 }
 
 void TrailObject::drawTrail(SkyPainter* skyp) const {
-    if( !Trail.size() )
+    if( !hasTrail() )
         return;
 
     KStarsData *data = KStarsData::Instance();
 
     QColor tcolor = QColor( data->colorScheme()->colorNamed( "PlanetTrailColor" ) );
+    if( !Polyline.isEmpty() ) {
+        Polyline.draw( skyp, data->updateNum(), data->lst(), data->geo()->lat(),
+                       Options::zoomFactor(), tcolor, Options::fadePlanetTrails() );
+        return;
+    }
+
     skyp->setPen( QPen(tcolor, 1) );
     int n = Trail.size();
     for(int i = 1; i < n; ++i) {
@@ -21,6 +21,7 @@
 #include <QSet>
 
 #include "skyobject.h"
+#include "trailpolyline.h"
 
 class SkyPainter;
 
@@ -43,13 +44,19 @@ public:
     virtual TrailObject* clone() const;
     
     /** @return whether the planet has a trail */
-    inline bool hasTrail() const { return ( Trail.count() > 0 ); }
+    inline bool hasTrail() const { return ( Trail.count() > 0 || ! Polyline.isEmpty() ); }
 
     /** @return a reference to the planet's trail */
     inline const QList<SkyPoint>& trail() const { return Trail; }
 
-    /** @short adds a point to the planet's trail */
-    void addToTrail();
+    /** @return the precomputed trail, if the object has one */
+    inline const TrailPolyline& trailPolyline() const { return Polyline; }
+
+    /** @short adds a point to the planet's trail.
+     * Objects that can compute their trail ahead of time reimplement this
+     * to start a precomputed trail instead.
+     */
+    virtual void addToTrail();
 
     /** @short removes the oldest point from the trail */
     void clipTrail();
@@ -70,6 +77,7 @@ public:
     static const int MaxTrail = 400;
 protected:
     QList<SkyPoint> Trail;
+    TrailPolyline Polyline;
     /// Store list of objects with trails.
     static QSet<TrailObject*> trailObjects;
 private:
@@ -0,0 +1,158 @@
+/***************************************************************************
+                   trailpolyline.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2014-06-17
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "trailpolyline.h"
+
+#include <QColor>
+#include <QPen>
+#include <QPair>
+
+#include <Eigen/Geometry>
+
+#include <cmath>
+
+#include "dms.h"
+#include "ksnumbers.h"
+#include "skypainter.h"
+#include "skyobjects/skypoint.h"
+
+namespace {
+    /// Pixels a simplified trail may be off the computed one
+    const double PixelTolerance = 0.5;
+
+    /** @return the angular distance (radians, for small angles) of p from the arc a-b */
+    double distanceToArc( const Eigen::Vector3f &p, const Eigen::Vector3f &a, const Eigen::Vector3f &b ) {
+        Eigen::Vector3f n = a.cross( b );
+        float norm = n.norm();
+        // Beyond the ends of the arc (or a degenerate arc) the nearest end counts
+        if ( norm < 1e-9 || a.cross( p ).dot( n ) < 0 || p.cross( b ).dot( n ) < 0 )
+            return qMin( ( p - a ).norm(), ( p - b ).norm() );
+        return fabs( p.dot( n ) ) / norm;
+    }
+}
+
+TrailPolyline::TrailPolyline() : m_startJD( 0 )
+{
+}
+
+void TrailPolyline::clear()
+{
+    m_points.clear();
+    m_times.clear();
+    m_simplified.clear();
+    m_startJD = 0;
+}
+
+void TrailPolyline::append( long double jd, const dms &ra0, const dms &dec0 )
+{
+    if ( m_points.isEmpty() )
+        m_startJD = jd;
+
+    double sinRA, cosRA, sinDec, cosDec;
+    ra0.SinCos( sinRA, cosRA );
+    dec0.SinCos( sinDec, cosDec );
+    m_points.append( Eigen::Vector3f( cosDec * cosRA, cosDec * sinRA, sinDec ) );
+    m_times.append( jd - m_startJD );
+    m_simplified.clear();
+}
+
+QVector<int> TrailPolyline::simplify( double tolerance ) const
+{
+    QVector<int> result;
+    int n = m_points.size();
+    if ( n < 3 ) {
+        for ( int i = 0; i < n; ++i )
+            result.append( i );
+        return result;
+    }
+
+    // Douglas-Peucker, with a stack instead of recursion
+    QVector<bool> keep( n, false );
+    keep[0] = keep[n-1] = true;
+    QVector< QPair<int, int> > stack;
+    stack.append( qMakePair( 0, n - 1 ) );
+    while ( ! stack.isEmpty() ) {
+        QPair<int, int> range = stack.last();
+        stack.pop_back();
+
+        double maxDistance = 0.0;
+        int farthest = -1;
+        for ( int i = range.first + 1; i < range.second; ++i ) {
+            double d = distanceToArc( m_points[i], m_points[range.first], m_points[range.second] );
+            if ( d > maxDistance ) {
+                maxDistance = d;
+                farthest = i;
+            }
+        }
+        if ( farthest >= 0 && maxDistance > tolerance ) {
+            keep[farthest] = true;
+            stack.append( qMakePair( range.first, farthest ) );
+            stack.append( qMakePair( farthest, range.second ) );
+        }
+    }
+
+    for ( int i = 0; i < n; ++i ) {
+        if ( keep[i] )
+            result.append( i );
+    }
+    return result;
+}
+
+const QVector<int>& TrailPolyline::simplified( double zoom ) const
+{
+    int level = qRound( log( zoom ) / log( 2.0 ) );
+    QHash<int, QVector<int> >::const_iterator it = m_simplified.constFind( level );
+    if ( it != m_simplified.constEnd() )
+        return it.value();
+    return m_simplified[level] = simplify( PixelTolerance / pow( 2.0, level ) );
+}
+
+void TrailPolyline::draw( SkyPainter *skyp, KSNumbers *num, const dms *lst, const dms *lat,
+                          double zoom, const QColor &color, bool fade ) const
+{
+    if ( m_points.size() < 2 )
+        return;
+
+    const QVector<int> &kept = simplified( zoom );
+
+    QVector<SkyPoint> points;
+    points.reserve( kept.size() );
+    foreach ( int i, kept ) {
+        const Eigen::Vector3f &v = m_points[i];
+        dms ra, dec;
+        ra.setRadians( atan2( v.y(), v.x() ) );
+        dec.setRadians( asin( qBound( -1.0f, v.z(), 1.0f ) ) );
+        SkyPoint p( ra.reduce(), dec );
+        p.updateCoords( num );
+        p.EquatorialToHorizontal( lst, lat );
+        points.append( p );
+    }
+
+    // Fade out towards the ends of the window
+    double now = num->julianDay() - m_startJD;
+    double span = qMax( now, m_times.last() - now );
+    QColor tcolor = color;
+    skyp->setPen( QPen( tcolor, 1 ) );
+    for ( int i = 1; i < points.size(); ++i ) {
+        if ( fade && span > 0.0 ) {
+            double t = 0.5 * ( m_times[ kept[i-1] ] + m_times[ kept[i] ] );
+            tcolor.setAlphaF( qBound( 0.0, 1.0 - fabs( t - now ) / span, 1.0 ) );
+            skyp->setPen( QPen( tcolor, 1 ) );
+        }
+        skyp->drawSkyLine( &points[i-1], &points[i] );
+    }
+}
@@ -0,0 +1,91 @@
+/***************************************************************************
+                    trailpolyline.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : 2014-06-17
+    copyright            : (C) 2014 by the KStars team
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef TRAILPOLYLINE_H
+#define TRAILPOLYLINE_H
+
+#include <QHash>
+#include <QVector>
+
+#include <Eigen/Core>
+
+class QColor;
+class dms;
+class KSNumbers;
+class SkyPainter;
+
+/**@class TrailPolyline
+ * The path of a moving body over a time window, as a polyline of J2000
+ * unit vectors with the time of each point. A point takes 16 bytes, so a
+ * trail of a few thousand points is cheap to keep.
+ *
+ * The points are filled in ahead of time (see KSPlanetBase::computeTrail()),
+ * with more points where the path bends. Before drawing, the polyline is
+ * simplified (Douglas-Peucker) to the pixel size of the current zoom level,
+ * and only the remaining points are precessed and projected. The simplified
+ * polylines are cached per zoom level.
+ *
+ * The data is implicitly shared, so copies are cheap.
+ */
+class TrailPolyline
+{
+public:
+    TrailPolyline();
+
+    /**@short Removes all points */
+    void clear();
+
+    inline bool isEmpty() const { return m_points.isEmpty(); }
+    inline int size() const { return m_points.size(); }
+
+    /**@short Appends a point at time jd, which must be later than the last point
+     * @p ra0 @p dec0 J2000 coordinates of the body at jd
+     */
+    void append( long double jd, const dms &ra0, const dms &dec0 );
+
+    /**@return the time of the first point */
+    inline long double startJD() const { return m_startJD; }
+
+    /**@return the time of the last point */
+    inline long double endJD() const { return m_points.isEmpty() ? m_startJD : m_startJD + m_times.last(); }
+
+    /**@return the indices of the points left after dropping all points
+     * that are closer than tolerance (radians) to the simplified path
+     */
+    QVector<int> simplify( double tolerance ) const;
+
+    /**@short Draws the trail
+     * @p num the current time, to which the points are precessed
+     * @p zoom the zoom factor, in pixels per radian
+     * @p fade if true the trail fades out away from the current time
+     */
+    void draw( SkyPainter *skyp, KSNumbers *num, const dms *lst, const dms *lat,
+               double zoom, const QColor &color, bool fade ) const;
+
+private:
+    /**@return the simplified indices for zoom, from the cache if possible */
+    const QVector<int>& simplified( double zoom ) const;
+
+    long double m_startJD;
+    QVector<Eigen::Vector3f> m_points;   ///< J2000 unit vectors
+    QVector<float> m_times;              ///< days since m_startJD
+
+    /// Simplified indices by rounded log2 of the zoom factor
+    mutable QHash<int, QVector<int> > m_simplified;
+};
+
+#endif
@@ -64,6 +64,7 @@ public:
 
     //FIXME: find a better way to do this.
     void setSizeMagLimit(float sizeMagLim);
+    float sizeMagLimit() const { return m_sizeMagLim; }
 
     /** Begin painting.
         @note this function <b>must</b> be called before painting anything.
@@ -118,6 +119,30 @@ public:
         */
     virtual bool drawPointSource(SkyPoint *loc, float mag, char sp = 'A') =0;
 
+    /** @short Draw all stars of a trixel down to a magnitude limit in one go.
+        Painters which can keep the stars of a trixel resident (e.g. in a
+        vertex buffer) override this; the default does nothing.
+        @param trixel the trixel the stars are indexed in
+        @param stars the stars of the trixel, sorted by magnitude
+        @param maglim the faintest magnitude to draw
+        @param version changes whenever stars move between trixels
+        @return true if the stars were drawn, false if the caller should
+        draw them one by one with drawPointSource()
+        */
+    virtual bool drawStarTrixel(Trixel trixel, const StarList* stars, float maglim, int version)
+    { Q_UNUSED(trixel); Q_UNUSED(stars); Q_UNUSED(maglim); Q_UNUSED(version); return false; }
+
+    /** @short Start collecting point sources instead of drawing them one at a time.
+        Painters that can draw many stars in one call override this and
+        flushPointSources(); the default draws every star right away.
+        @note nothing but point sources may be drawn until flushPointSources()
+        is called.
+        */
+    virtual void beginPointSources() {}
+
+    /** @short Draw the point sources collected since beginPointSources(). */
+    virtual void flushPointSources() {}
+
     /** @short Draw a deep sky object
         @param obj the object to draw
         @param drawImage if true, try to draw the image of the object
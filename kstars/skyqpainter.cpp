@@ -19,12 +19,12 @@
 
 #include "skyqpainter.h"
 
-#include <QMap>
 #include <QWidget>
 
 #include "kstarsdata.h"
 #include "Options.h"
 #include "skymap.h"
+#include "frameprofiler.h"
 
 #include "skycomponents/linelist.h"
 #include "skycomponents/skiplist.h"
@@ -66,11 +66,59 @@ namespace {
     // Total number of specatral classes
     // N.B. Must be in sync with harvardToIndex
     const int nSPclasses = 7;
+    // Total number of star color modes
+    const int nColorModes = 4;
 
-    // Cache for star images.
+    // All star images live in one atlas, one row per color mode and
+    // spectral class, one column per size:
     //
-    // These pixmaps are never deallocated. Not really good...
-    QPixmap* imageCache[nSPclasses][nStarSizes] = {{0}};
+    //   x = 1 + 2 + ... + (size - 1),  y = (mode * nSPclasses + class) * rowHeight
+    //
+    // so a whole trixel of stars can be blitted from it in one call.
+    //
+    // The atlas is never deallocated. Not really good...
+    const int atlasRowHeight = nStarSizes - 1;
+    const int atlasWidth = nStarSizes * ( nStarSizes - 1 ) / 2;
+    QPixmap* starAtlas = 0;
+
+    // The same atlas as a QImage.  Pixmaps may only be used in the GUI
+    // thread, so this is recorded instead when painting into a QPicture.
+    QImage* starAtlasImage = 0;
+
+    QRect atlasRect( int mode, int spIndex, int size ) {
+        return QRect( size * ( size - 1 ) / 2,
+                      ( mode * nSPclasses + spIndex ) * atlasRowHeight,
+                      size, size );
+    }
+
+    // Star sizes by magnitude for the current zoom level and size
+    // magnitude limit.  Rebuilt only when one of them changes.
+    const int lutMinMag = -5;
+    const int lutMaxMag = 25;
+    const int lutStepsPerMag = 20;
+    const int lutSize = ( lutMaxMag - lutMinMag ) * lutStepsPerMag + 1;
+    float sizeLUT[lutSize];
+    double lutZoom = -1.0;
+    float lutSizeMagLim = -1.0;
+
+    // Star colors by spectral class for the given color mode
+    QColor starColor( int mode, int spIndex ) {
+        static const QRgb realColors[nSPclasses] = {
+            qRgb(   0,   0, 255 ), // O
+            qRgb(   0, 200, 255 ), // B
+            qRgb(   0, 255, 255 ), // A
+            qRgb( 200, 255, 100 ), // F
+            qRgb( 255, 255,   0 ), // G
+            qRgb( 255, 100,   0 ), // K
+            qRgb( 255,   0,   0 )  // M
+        };
+        switch( mode ) {
+        case 1:  return QColor::fromRgb( 255,   0,   0 ); // Red stars
+        case 2:  return QColor::fromRgb(   0,   0,   0 ); // Black stars
+        case 3:  return QColor::fromRgb( 255, 255, 255 ); // White stars
+        default: return QColor( realColors[spIndex] );    // Real color
+        }
+    }
 }
 
 int SkyQPainter::starColorMode = 0;
@@ -82,6 +130,8 @@ SkyQPainter::SkyQPainter( QPaintDevice *pd )
     m_pd = pd;
     m_size = QSize( pd->width(), pd->height() );
     m_vectorStars = false;
+    m_recording = ( m_pd->devType() == QInternal::Picture );
+    m_batchStars = false;
 }
 
 SkyQPainter::SkyQPainter( QPaintDevice *pd, const QSize &size )
@@ -91,6 +141,8 @@ SkyQPainter::SkyQPainter( QPaintDevice *pd, const QSize &size )
     m_pd = pd;
     m_size = size;
     m_vectorStars = false;
+    m_recording = ( m_pd->devType() == QInternal::Picture );
+    m_batchStars = false;
 }
 
 SkyQPainter::SkyQPainter( QWidget *widget, QPaintDevice *pd )
@@ -101,6 +153,8 @@ SkyQPainter::SkyQPainter( QWidget *widget, QPaintDevice *pd )
     m_pd = ( pd ? pd : widget );
     m_size = widget->size();
     m_vectorStars = false;
+    m_recording = ( m_pd->devType() == QInternal::Picture );
+    m_batchStars = false;
 }
 
 SkyQPainter::~SkyQPainter()
@@ -118,6 +172,8 @@ void SkyQPainter::begin()
 
 void SkyQPainter::end()
 {
+    flushPointSources();
+    FrameProfiler::Scope scope( "Painter end" );
     QPainter::end();
 }
 
@@ -139,92 +195,68 @@ void SkyQPainter::setBrush(const QBrush& brush)
 
 void SkyQPainter::initStarImages()
 {
-
-    QMap<char, QColor> ColorMap;
     const int starColorIntensity = Options::starColorIntensity();
 
-    switch( Options::starColorMode() ) {
-    case 1: // Red stars.
-        ColorMap.insert( 'O', QColor::fromRgb( 255,   0,   0 ) );
-        ColorMap.insert( 'B', QColor::fromRgb( 255,   0,   0 ) );
-        ColorMap.insert( 'A', QColor::fromRgb( 255,   0,   0 ) );
-        ColorMap.insert( 'F', QColor::fromRgb( 255,   0,   0 ) );
-        ColorMap.insert( 'G', QColor::fromRgb( 255,   0,   0 ) );
-        ColorMap.insert( 'K', QColor::fromRgb( 255,   0,   0 ) );
-        ColorMap.insert( 'M', QColor::fromRgb( 255,   0,   0 ) );
-        break;
-    case 2: // Black stars.
-        ColorMap.insert( 'O', QColor::fromRgb(   0,   0,   0 ) );
-        ColorMap.insert( 'B', QColor::fromRgb(   0,   0,   0 ) );
-        ColorMap.insert( 'A', QColor::fromRgb(   0,   0,   0 ) );
-        ColorMap.insert( 'F', QColor::fromRgb(   0,   0,   0 ) );
-        ColorMap.insert( 'G', QColor::fromRgb(   0,   0,   0 ) );
-        ColorMap.insert( 'K', QColor::fromRgb(   0,   0,   0 ) );
-        ColorMap.insert( 'M', QColor::fromRgb(   0,   0,   0 ) );
-        break;
-    case 3: // White stars
-        ColorMap.insert( 'O', QColor::fromRgb( 255, 255, 255 ) );
-        ColorMap.insert( 'B', QColor::fromRgb( 255, 255, 255 ) );
-        ColorMap.insert( 'A', QColor::fromRgb( 255, 255, 255 ) );
-        ColorMap.insert( 'F', QColor::fromRgb( 255, 255, 255 ) );
-        ColorMap.insert( 'G', QColor::fromRgb( 255, 255, 255 ) );
-        ColorMap.insert( 'K', QColor::fromRgb( 255, 255, 255 ) );
-        ColorMap.insert( 'M', QColor::fromRgb( 255, 255, 255 ) );
-    case 0:  // Real color
-    default: // And use real color for everything else
-        ColorMap.insert( 'O', QColor::fromRgb(   0,   0, 255 ) );
-        ColorMap.insert( 'B', QColor::fromRgb(   0, 200, 255 ) );
-        ColorMap.insert( 'A', QColor::fromRgb(   0, 255, 255 ) );
-        ColorMap.insert( 'F', QColor::fromRgb( 200, 255, 100 ) );
-        ColorMap.insert( 'G', QColor::fromRgb( 255, 255,   0 ) );
-        ColorMap.insert( 'K', QColor::fromRgb( 255, 100,   0 ) );
-        ColorMap.insert( 'M', QColor::fromRgb( 255,   0,   0 ) );
-    }
-
-    foreach( char color, ColorMap.keys() ) {
-        QPixmap BigImage( 15, 15 );
-        BigImage.fill( Qt::transparent );
-
-        QPainter p;
-        p.begin( &BigImage );
-
-        if ( Options::starColorMode() == 0 ) {
-            qreal h, s, v, a;
-            p.setRenderHint( QPainter::Antialiasing, false );
-            QColor starColor = ColorMap[color];
-            starColor.getHsvF(&h, &s, &v, &a);
-            for (int i = 0; i < 8; i++ ) {
-                for (int j = 0; j < 8; j++ ) {
-                    qreal x = i - 7;
-                    qreal y = j - 7;
-                    qreal dist = sqrt( x*x + y*y ) / 7.0;
-                    starColor.setHsvF(h,
+    QImage atlas( atlasWidth, nColorModes * nSPclasses * atlasRowHeight,
+                  QImage::Format_ARGB32_Premultiplied );
+    atlas.fill( Qt::transparent );
+
+    QPainter ap;
+    ap.begin( &atlas );
+    ap.setCompositionMode( QPainter::CompositionMode_Source );
+
+    for( int mode = 0; mode < nColorModes; mode++ ) {
+        for( int sp = 0; sp < nSPclasses; sp++ ) {
+            QPixmap BigImage( 15, 15 );
+            BigImage.fill( Qt::transparent );
+
+            QPainter p;
+            p.begin( &BigImage );
+
+            if ( mode == 0 ) {
+                qreal h, s, v, a;
+                p.setRenderHint( QPainter::Antialiasing, false );
+                QColor color = starColor( mode, sp );
+                color.getHsvF(&h, &s, &v, &a);
+                for (int i = 0; i < 8; i++ ) {
+                    for (int j = 0; j < 8; j++ ) {
+                        qreal x = i - 7;
+                        qreal y = j - 7;
+                        qreal dist = sqrt( x*x + y*y ) / 7.0;
+                        color.setHsvF(h,
                                       qMin( qreal(1), dist < (10-starColorIntensity)/10.0 ? 0 : dist ),
                                       v,
                                       qMax( qreal(0), dist < (10-starColorIntensity)/20.0 ? 1 : 1-dist ) );
-                    p.setPen( starColor );
-                    p.drawPoint( i, j );
-                    p.drawPoint( 14-i, j );
-                    p.drawPoint( i, 14-j );
-                    p.drawPoint (14-i, 14-j);
+                        p.setPen( color );
+                        p.drawPoint( i, j );
+                        p.drawPoint( 14-i, j );
+                        p.drawPoint( i, 14-j );
+                        p.drawPoint (14-i, 14-j);
+                    }
                 }
+            } else {
+                p.setRenderHint(QPainter::Antialiasing, true );
+                p.setPen( QPen( starColor( mode, sp ), 2.0 ) );
+                p.setBrush( p.pen().color() );
+                p.drawEllipse( QRectF( 2, 2, 10, 10 ) );
+            }
+            p.end();
+
+            for( int size = 1; size < nStarSizes; size++ ) {
+                ap.drawPixmap( atlasRect( mode, sp, size ).topLeft(),
+                               BigImage.scaled( size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation ) );
             }
-        } else {
-            p.setRenderHint(QPainter::Antialiasing, true );
-            p.setPen( QPen(ColorMap[color], 2.0 ) );
-            p.setBrush( p.pen().color() );
-            p.drawEllipse( QRectF( 2, 2, 10, 10 ) );
-        }
-        p.end();
-
-        // Cache array slice
-        QPixmap** pmap = imageCache[ harvardToIndex(color) ];
-        for( int size = 1; size < nStarSizes; size++ ) {
-            if( !pmap[size] )
-                pmap[size] = new QPixmap();
-            *pmap[size] = BigImage.scaled( size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation );
         }
     }
+    ap.end();
+
+    if( !starAtlasImage )
+        starAtlasImage = new QImage();
+    *starAtlasImage = atlas;
+    if( !starAtlas )
+        starAtlas = new QPixmap();
+    *starAtlas = QPixmap::fromImage( atlas );
+
     starColorMode = Options::starColorMode();
 }
 
@@ -376,21 +408,61 @@ bool SkyQPainter::drawPointSource(SkyPoint* loc, float mag, char sp)
     bool visible = false;
     QPointF pos = m_proj->toScreen(loc,true,&visible);
     if( visible && m_proj->onScreen(pos) ) { // FIXME: onScreen here should use canvas size rather than SkyMap size, especially while printing in portrait mode!
-        drawPointSource(pos, starWidth(mag), sp);
+        drawPointSource(pos, lookupStarWidth(mag), sp);
         return true;
     } else {
         return false;
     }
 }
 
+float SkyQPainter::lookupStarWidth(float mag)
+{
+    double zoom = Options::zoomFactor();
+    if( zoom != lutZoom || sizeMagLimit() != lutSizeMagLim ) {
+        for( int i = 0; i < lutSize; i++ )
+            sizeLUT[i] = starWidth( lutMinMag + float( i ) / lutStepsPerMag );
+        lutZoom = zoom;
+        lutSizeMagLim = sizeMagLimit();
+    }
+
+    int i = int( ( mag - lutMinMag ) * lutStepsPerMag + 0.5 );
+    return sizeLUT[ qBound( 0, i, lutSize - 1 ) ];
+}
+
+void SkyQPainter::beginPointSources()
+{
+    m_batchStars = !m_recording;
+    m_starFragments.resize( 0 );
+}
+
+void SkyQPainter::flushPointSources()
+{
+    FrameProfiler::Scope scope( "Star flush" );
+    if( !m_starFragments.isEmpty() )
+        drawPixmapFragments( m_starFragments.constData(), m_starFragments.size(), *starAtlas );
+    m_starFragments.resize( 0 );
+    m_batchStars = false;
+}
+
 void SkyQPainter::drawPointSource(const QPointF& pos, float size, char sp)
 {
     int isize = qMin(static_cast<int>(size), 14);
     if( !m_vectorStars || ( starColorMode <=0 || starColorMode > 3 )  ) {
         // Draw stars as bitmaps, either because we were asked to, or because we're painting real colors
-        QPixmap* im = imageCache[ harvardToIndex(sp) ][isize];
-        float offset = 0.5 * im->width();
-        drawPixmap( QPointF(pos.x()-offset, pos.y()-offset), *im );
+        if( isize < 1 )
+            return;
+        int mode = ( starColorMode > 0 && starColorMode < nColorModes ) ? starColorMode : 0;
+        QRect source = atlasRect( mode, harvardToIndex(sp), isize );
+        if( m_batchStars ) {
+            m_starFragments.append( QPainter::PixmapFragment::create( pos, source ) );
+            return;
+        }
+        float offset = 0.5 * isize;
+        QPointF target( pos.x()-offset, pos.y()-offset );
+        if( m_recording )
+            drawImage( target, *starAtlasImage, source );
+        else
+            drawPixmap( target, *starAtlas, source );
     }
     else {
         // Draw stars as vectors, for better printing / SVG export etc.
@@ -20,6 +20,8 @@
 #ifndef SKYQPAINTER_H
 #define SKYQPAINTER_H
 
+#include <QVector>
+
 #include "skypainter.h"
 
 class Projector;
@@ -77,6 +79,8 @@ public:
                                  LineListLabel *label = 0);
     virtual void drawSkyPolygon(LineList* list);
     virtual bool drawPointSource(SkyPoint *loc, float mag, char sp = 'A');
+    virtual void beginPointSources();
+    virtual void flushPointSources();
     virtual bool drawDeepSkyObject(DeepSkyObject *obj, bool drawImage = false);
     virtual bool drawPlanet(KSPlanetBase *planet);
     virtual void drawObservingList(const QList<SkyObject*>& obs);
@@ -92,9 +96,16 @@ public:
 private:
     virtual bool drawDeepSkyImage (const QPointF& pos, DeepSkyObject* obj,
                                          float positionAngle);
+    /** @short starWidth() through a table that is rebuilt when the zoom changes */
+    float lookupStarWidth(float mag);
     QPaintDevice *m_pd;
     const Projector* m_proj;
     bool m_vectorStars;
+    // true when painting into a QPicture that may be played in other threads
+    bool m_recording;
+    // stars collected between beginPointSources() and flushPointSources()
+    bool m_batchStars;
+    QVector<QPainter::PixmapFragment> m_starFragments;
     QSize m_size;
     static int starColorMode;
 };
@@ -89,6 +89,9 @@ AltVsTime::AltVsTime( QWidget* parent)  :
     geo = KStarsData::Instance()->geo();
 
     DayOffset = 0;
+    m_GridJD = 0;
+    m_GridDayOffset = 0;
+    m_GridGeo = 0;
     showCurrentDate();
     if ( getDate().time().hour() > 12 )
         DayOffset = 1;
@@ -218,69 +221,136 @@ void AltVsTime::processObject( SkyObject *o, bool forceAdd ) {
     if( !o )
         return;
 
-    KSNumbers *num = new KSNumbers( getDate().djd() );
-    KSNumbers *oldNum = 0;
+    processObjects( QList<SkyObject*>() << o, forceAdd );
+}
+
+void AltVsTime::processObjects( const QList<SkyObject*> &objects, bool forceAdd ) {
+    if ( objects.isEmpty() )
+        return;
 
-    //If the object is in the solar system, recompute its position for the given epochLabel
     KStarsData* data = KStarsData::Instance();
-    if ( o->isSolarSystem() ) {
-        oldNum = new KSNumbers( data->ut().djd() );
-        o->updateCoords( num, true, geo->lat(), data->lst() );
-    }
+    KSNumbers num( getDate().djd() );
+    KSNumbers oldNum( data->ut().djd() );
+    updateTimeGrid();
 
-    //precess coords to target epoch
-    o->updateCoords( num );
+    QList<KPlotObject*> curves;
+    int plotCount = avtUI->View->plotObjects().count();
+    SkyObject *last = 0;
 
-    //If this point is not in list already, add it to list
-    bool found(false);
-    foreach ( SkyObject *p, pList ) {
-        if ( o->ra().Degrees() == p->ra().Degrees() && o->dec().Degrees() == p->dec().Degrees() ) {
-            found = true;
-            break;
-        }
-    }
-    if ( found && !forceAdd ) {
-        kDebug() << "This point is already displayed; I will not duplicate it.";
-    } else {
-        pList.append( o );
+    foreach ( SkyObject *o, objects ) {
+        if ( !o )
+            continue;
 
-        //make sure existing curves are thin and red
-        foreach(KPlotObject* obj, avtUI->View->plotObjects()) {
-            if ( obj->size() == 2 ) 
-                obj->setLinePen( QPen( Qt::red, 1 ) );
+        //If the object is in the solar system, recompute its position for the given epochLabel
+        if ( o->isSolarSystem() )
+            o->updateCoords( &num, true, geo->lat(), data->lst() );
+
+        //precess coords to target epoch
+        o->updateCoords( &num );
+
+        //If this point is not in list already, add it to list
+        bool found(false);
+        foreach ( SkyObject *p, pList ) {
+            if ( o->ra().Degrees() == p->ra().Degrees() && o->dec().Degrees() == p->dec().Degrees() ) {
+                found = true;
+                break;
+            }
+        }
+        if ( found && !forceAdd ) {
+            kDebug() << "This point is already displayed; I will not duplicate it.";
+            continue;
         }
+        pList.append( o );
 
-        //add new curve with width=2, and color=white
+        //new curves have width=2, and color=white
+        QVector<double> alt = altitudeCurve( o );
         KPlotObject *po = new KPlotObject( Qt::white, KPlotObject::Lines, 2.0 );
-        for ( double h=-12.0; h<=12.0; h+=0.5 ) {
-            int label_pos = -11.0 + avtUI->View->plotObjects().count();
-            while ( label_pos > 11.0 )
-                label_pos -= 23.0;
+        int label_pos = -11.0 + plotCount + curves.count();
+        while ( label_pos > 11.0 )
+            label_pos -= 23.0;
+        for ( int i = 0; i < m_GridHours.size(); ++i ) {
+            double h = m_GridHours[i];
             if( h == label_pos )
-                po->addPoint( h, findAltitude( o, h ), o->translatedName() );
+                po->addPoint( h, alt[i], o->translatedName() );
             else
-                po->addPoint( h, findAltitude( o, h ) );
+                po->addPoint( h, alt[i] );
         }
-        avtUI->View->addPlotObject( po );
-
+        curves.append( po );
         avtUI->PlotList->addItem( o->translatedName() );
+        last = o;
+    }
+
+    if ( last ) {
+        //make sure existing curves are thin and red; only the last new one stays white
+        foreach(KPlotObject* obj, avtUI->View->plotObjects()) {
+            if ( obj->size() == 2 )
+                obj->setLinePen( QPen( Qt::red, 1 ) );
+        }
+        for ( int i = 0; i < curves.count() - 1; ++i )
+            curves[i]->setLinePen( QPen( Qt::red, 1 ) );
+        avtUI->View->addPlotObjects( curves );
+
         avtUI->PlotList->setCurrentRow( avtUI->PlotList->count() - 1 );
-        avtUI->raBox->showInHours(o->ra() );
-        avtUI->decBox->showInDegrees(o->dec() );
-        avtUI->nameBox->setText(o->translatedName() );
+        avtUI->raBox->showInHours( last->ra() );
+        avtUI->decBox->showInDegrees( last->dec() );
+        avtUI->nameBox->setText( last->translatedName() );
 
         //Set epochName to epoch shown in date tab
         avtUI->epochName->setText( QString().setNum( getDate().epoch() ) );
     }
     kDebug() << "Currently, there are " << avtUI->View->plotObjects().count() << " objects displayed.";
 
-    //restore original position
-    if ( o->isSolarSystem() ) {
-        o->updateCoords( oldNum, true, data->geo()->lat(), data->lst() );
-        delete oldNum;
+    //restore original positions
+    foreach ( SkyObject *o, objects ) {
+        if ( !o )
+            continue;
+        if ( o->isSolarSystem() )
+            o->updateCoords( &oldNum, true, data->geo()->lat(), data->lst() );
+        o->EquatorialToHorizontal( data->lst(), data->geo()->lat() );
     }
-    o->EquatorialToHorizontal( data->lst(), data->geo()->lat() );
-    delete num;
+}
+
+void AltVsTime::updateTimeGrid() {
+    //getDate converts the user-entered local time to UT
+    KStarsDateTime today = getDate();
+    if ( !m_GridHours.isEmpty() && m_GridJD == today.djd() && m_GridDayOffset == DayOffset && m_GridGeo == geo )
+        return;
+
+    m_GridJD = today.djd();
+    m_GridDayOffset = DayOffset;
+    m_GridGeo = geo;
+    m_GridHours.clear();
+    m_GridSinLST.clear();
+    m_GridCosLST.clear();
+
+    for ( double h=-12.0; h<=12.0; h+=0.5 ) {
+        KStarsDateTime ut = today.addSecs( ( h + 24.0*DayOffset )*3600.0 );
+        dms LST = geo->GSTtoLST( ut.gst() );
+        double sinLST, cosLST;
+        LST.SinCos( sinLST, cosLST );
+        m_GridHours.append( h );
+        m_GridSinLST.append( sinLST );
+        m_GridCosLST.append( cosLST );
+    }
+}
+
+QVector<double> AltVsTime::altitudeCurve( const SkyPoint *p ) {
+    double sinRA, cosRA, sinDec, cosDec, sinLat, cosLat;
+    p->ra().SinCos( sinRA, cosRA );
+    p->dec().SinCos( sinDec, cosDec );
+    geo->lat()->SinCos( sinLat, cosLat );
+
+    //Same as EquatorialToHorizontal(), with cos(LST - RA) expanded so
+    //that only the grid depends on the time
+    double a = sinDec*sinLat;
+    double b = cosDec*cosLat;
+    QVector<double> alt( m_GridHours.size() );
+    for ( int i = 0; i < alt.size(); ++i ) {
+        double cosHA = m_GridCosLST[i]*cosRA + m_GridSinLST[i]*sinRA;
+        double sinAlt = qBound( -1.0, a + b*cosHA, 1.0 );
+        alt[i] = asin( sinAlt ) / dms::DegToRad;
+    }
+    return alt;
 }
 
 double AltVsTime::findAltitude( SkyPoint *p, double hour ) {
@@ -372,6 +442,12 @@ void AltVsTime::slotUpdateDateLoc() {
     // Determine dawn/dusk time and min/max sun elevation
     setDawnDusk();
 
+    if ( getDate().time().hour() > 12 )
+        DayOffset = 1;
+    else
+        DayOffset = 0;
+    updateTimeGrid();
+
     for ( int i = 0; i < avtUI->PlotList->count(); ++i ) {
         QString oName = avtUI->PlotList->item( i )->text().toLower();
 
@@ -390,9 +466,9 @@ void AltVsTime::slotUpdateDateLoc() {
             pList.replace( i, o );
 
             KPlotObject *po = new KPlotObject( Qt::white, KPlotObject::Lines, 1 );
-            for ( double h=-12.0; h<=12.0; h+=0.5 ) {
-                po->addPoint( h, findAltitude( o, h ) );
-            }
+            QVector<double> alt = altitudeCurve( o );
+            for ( int j = 0; j < m_GridHours.size(); ++j )
+                po->addPoint( m_GridHours[j], alt[j] );
             avtUI->View->replacePlotObject( i, po );
 
             //restore original position
@@ -406,18 +482,13 @@ void AltVsTime::slotUpdateDateLoc() {
             pList.at(i)->updateCoords( num ); //precess to desired epoch
 
             KPlotObject *po = new KPlotObject( Qt::white, KPlotObject::Lines, 1 );
-            for ( double h=-12.0; h<=12.0; h+=0.5 ) {
-                po->addPoint( h, findAltitude( pList.at(i), h ) );
-            }
+            QVector<double> alt = altitudeCurve( pList.at(i) );
+            for ( int j = 0; j < m_GridHours.size(); ++j )
+                po->addPoint( m_GridHours[j], alt[j] );
             avtUI->View->replacePlotObject( i, po );
         }
     }
 
-    if ( getDate().time().hour() > 12 )
-        DayOffset = 1;
-    else
-        DayOffset = 0;
-
     setLSTLimits();
     slotHighlight( avtUI->PlotList->currentRow() );
     avtUI->View->update();
@@ -19,6 +19,7 @@
 #define ALTVSTIME_H_
 
 #include <QList>
+#include <QVector>
 
 #include "ui_altvstime.h"
 
@@ -91,6 +92,15 @@ public:
      */
     void processObject( SkyObject *o, bool forceAdd=false );
 
+    /**@short Add many SkyObjects to the display at once.
+     * The curves are computed over one shared time grid and added to the
+     * plot together; the last one is highlighted.
+     * @param objects the SkyObjects to be added
+     * @param forceAdd if true, then each object will be added, even if there
+     * is already a curve for the same coordinates.
+     */
+    void processObjects( const QList<SkyObject*> &objects, bool forceAdd=false );
+
     /**@short Determine the altitude coordinate of a SkyPoint,
      * given an hour of the day.
      *
@@ -145,6 +155,16 @@ public slots:
 private:
     /**@short find start of dawn, end of dusk, maximum and minimum elevation of the sun */
     void setDawnDusk();
+
+    /**@short Compute the sidereal time of every point of the plotted day,
+     * unless the date, day offset and location are the same as last time.
+     */
+    void updateTimeGrid();
+
+    /**@return the altitudes of p (in degrees) at the points of the time
+     * grid, for its current RA and Dec
+     */
+    QVector<double> altitudeCurve( const SkyPoint *p );
     
     AltVsTimeUI *avtUI;
 
@@ -152,6 +172,13 @@ private:
     QList<SkyObject*> pList;
     QList<SkyObject*> deleteList;
     int DayOffset;
+
+    // The time grid: hours of the plotted day and the sine and cosine of
+    // the sidereal time at each, for the date, offset and location below
+    QVector<double> m_GridHours, m_GridSinLST, m_GridCosLST;
+    long double m_GridJD;
+    int m_GridDayOffset;
+    GeoLocation *m_GridGeo;
 };
 
 #endif // ALTVSTIME_H_
@@ -683,6 +683,7 @@ void ObservingList::slotAVT() {
     // TODO: Think and see if there's a more effecient way to do this. I can't seem to think of any, but this code looks like it could be improved. - Akarsh
     if( sessionView ) {
         QPointer<AltVsTime> avt = new AltVsTime( ks );//FIXME KStars class is singleton, so why pass it?
+        QList<SkyObject*> objects;
         for ( int irow = m_Session->rowCount()-1; irow >= 0; --irow ) {
             if ( ui->SessionView->selectionModel()->isRowSelected( irow, QModelIndex() ) ) {
                 QModelIndex mSortIndex = m_SortModelSession->index( irow, 0 );
@@ -694,28 +695,31 @@ void ObservingList::slotAVT() {
                     //Stars named "star" must be matched by coordinates
                     if ( o->name() == "star" ) {
                         if ( o->ra0().toHMSString() == ra && o->dec0().toDMSString() == dc ) {
-                            avt->processObject( o );
+                            objects.append( o );
                             break;
                         }
 
                     } else if ( o->translatedName() == mIndex.data().toString() ) {
-                        avt->processObject( o );
+                        objects.append( o );
                         break;
                     }
                 }
             }
         }
+        avt->processObjects( objects );
         avt->exec();
         delete avt;
     } else {
         selectedItems = m_SortModel->mapSelectionToSource( ui->TableView->selectionModel()->selection() ).indexes();
         if ( selectedItems.size() ) {
             QPointer<AltVsTime> avt = new AltVsTime( ks );//FIXME KStars class is singleton, so why pass it?
+            QList<SkyObject*> objects;
             foreach ( const QModelIndex &i, selectedItems ) {
                 foreach ( SkyObject *o, obsList() )
                     if ( o->translatedName() == i.data().toString() )
-                        avt->processObject( o );
+                        objects.append( o );
             }
+            avt->processObjects( objects );
             avt->exec();
             delete avt;
         }
@@ -773,13 +777,9 @@ void ObservingList::slotOpenList() {
         TimeHash.clear();
         m_CurrentObject = 0;
         m_Session->removeRows( 0, m_Session->rowCount() );
-        //First line is the name of the list. The rest of the file is
-        //object names, one per line. With the TimeHash value if present
-        QTextStream istream( &f );
-        QString input;
-        input = istream.readAll();
+        //The list is an OAL log, read straight from the file
         OAL::Log logObject;
-        logObject.readBegin( input );
+        logObject.readBegin( &f );
         //Set the New TimeHash
         TimeHash = logObject.timeHash();
         geo = logObject.geoLocation();
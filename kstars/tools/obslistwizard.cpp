@@ -18,11 +18,13 @@
 
 #include <QVBoxLayout>
 #include <QFrame>
+#include <QTimer>
 
 #include <knuminput.h>
 #include <kpushbutton.h>
 
 #include "kstarsdata.h"
+#include "Options.h"
 #include "geolocation.h"
 #include "dialogs/locationdialog.h"
 #include "skyobjects/skyobject.h"
@@ -32,6 +34,26 @@
 #include "widgets/magnitudespinbox.h"
 #include "skycomponents/constellationboundarylines.h"
 #include "skycomponents/skymapcomposite.h"
+#include "skycomponents/skymesh.h"
+
+namespace {
+    bool brighterThan( SkyObject *a, SkyObject *b ) {
+        return a->mag() < b->mag();
+    }
+
+    //@return the number of objects at the start of sorted that are not fainter than mag
+    int countBrighter( const QVector<SkyObject*> &sorted, double mag ) {
+        int low = 0, high = sorted.size();
+        while ( low < high ) {
+            int middle = ( low + high )/2;
+            if ( sorted[middle]->mag() <= mag )
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        return low;
+    }
+}
 
 ObsListWizardUI::ObsListWizardUI( QWidget *p ) : QFrame ( p ) {
     setupUi( this );
@@ -83,6 +105,16 @@ ObsListWizard::ObsListWizard( QWidget *ksparent ) :
 
     connect( this, SIGNAL( okClicked() ), this, SLOT( slotApplyFilters() ) );
 
+    //Recount shortly after the last change, so the count follows the controls
+    m_CountTimer = new QTimer( this );
+    m_CountTimer->setSingleShot( true );
+    m_CountTimer->setInterval( 200 );
+    connect( m_CountTimer, SIGNAL( timeout() ), this, SLOT( slotUpdateObjectCount() ) );
+
+    xRect1 = xRect2 = yRect1 = yRect2 = rCirc = 0.0;
+    m_GridMinAlt = m_GridMaxAlt = 0.0;
+    m_GridGeo = 0;
+
     geo = KStarsData::Instance()->geo();
     olw->LocationButton->setText( geo->fullName() );
     olw->Date->setDate(KStarsDateTime::currentLocalDate());
@@ -116,27 +148,33 @@ void ObsListWizard::initialize()
     olw->RAMin->setDegType( false );
     olw->RAMax->setDegType( false );
 
-    //Initialize object counts
     ObjectCount = 0; //number of objects in observing list
-    StarCount = data->skyComposite()->stars().size(); //total number of stars
-    PlanetCount = 10; //Sun, Moon, 8 planets
-    AsteroidCount = data->skyComposite()->asteroids().size(); //total number of asteroids
-    CometCount = data->skyComposite()->comets().size(); //total number of comets
-    //DeepSkyObjects
-    OpenClusterCount = 0;
-    GlobClusterCount = 0;
-    GasNebCount = 0;
-    PlanNebCount = 0;
-    GalaxyCount = 0;
 
+    //Named stars and the deep-sky objects the wizard offers, ordered by
+    //magnitude for the magnitude filter
+    m_ObjectsByMag.clear();
+    m_ObjectsByTrixel.clear();
+    m_ConstellationCache.clear();
+    foreach ( SkyObject *o, data->skyComposite()->stars() ) {
+        // JM 2012-10-22: Skip unnamed stars
+        if ( o->name() != "star" )
+            m_ObjectsByMag.append( o );
+    }
     foreach ( DeepSkyObject *o, data->skyComposite()->deepSkyObjects() ) {
-        if ( o->type() == SkyObject::GALAXY ) ++GalaxyCount; //most deepsky obj are galaxies, so check them first
-        else if ( o->type() == SkyObject::STAR || o->type() == SkyObject::CATALOG_STAR ) ++StarCount;
-        else if ( o->type() == SkyObject::OPEN_CLUSTER ) ++OpenClusterCount;
-        else if ( o->type() == SkyObject::GLOBULAR_CLUSTER ) ++GlobClusterCount;
-        else if ( o->type() == SkyObject::GASEOUS_NEBULA || o->type() == SkyObject::SUPERNOVA_REMNANT ) ++GasNebCount;
-        else if ( o->type() == SkyObject::PLANETARY_NEBULA ) ++PlanNebCount;
+        switch ( o->type() ) {
+        case SkyObject::OPEN_CLUSTER:
+        case SkyObject::GLOBULAR_CLUSTER:
+        case SkyObject::GASEOUS_NEBULA:
+        case SkyObject::SUPERNOVA_REMNANT:
+        case SkyObject::PLANETARY_NEBULA:
+        case SkyObject::GALAXY:
+            m_ObjectsByMag.append( o );
+            break;
+        default:
+            break;
+        }
     }
+    qStableSort( m_ObjectsByMag.begin(), m_ObjectsByMag.end(), brighterThan );
 }
 
 bool ObsListWizard::isItemSelected( const QString &name, QListWidget *listWidget, bool *ok ) {
@@ -337,482 +375,257 @@ void ObsListWizard::slotParseRegion()
 
 void ObsListWizard::slotObjectCountDirty() {
     olw->updateButton->setDisabled( false );
+    m_CountTimer->start();
 }
 
 void ObsListWizard::slotUpdateObjectCount()
 {
+    m_CountTimer->stop();
     QApplication::setOverrideCursor( Qt::WaitCursor );
-    ObjectCount = 0;
-    if ( isItemSelected( i18n( "Stars" ), olw->TypeList ) )
-        ObjectCount += StarCount;
-    if ( isItemSelected( i18n( "Sun, moon, planets" ), olw->TypeList ) )
-        ObjectCount += PlanetCount;
-    if ( isItemSelected( i18n( "Comets" ), olw->TypeList ) )
-        ObjectCount += CometCount;
-    if ( isItemSelected( i18n( "Asteroids" ), olw->TypeList ) )
-        ObjectCount += AsteroidCount;
-    if ( isItemSelected( i18n( "Galaxies" ), olw->TypeList ) )
-        ObjectCount += GalaxyCount;
-    if ( isItemSelected( i18n( "Open clusters" ), olw->TypeList ) )
-        ObjectCount += OpenClusterCount;
-    if ( isItemSelected( i18n( "Globular clusters" ), olw->TypeList ) )
-        ObjectCount += GlobClusterCount;
-    if ( isItemSelected( i18n( "Gaseous nebulae" ), olw->TypeList ) )
-        ObjectCount += GasNebCount;
-    if ( isItemSelected( i18n( "Planetary nebulae" ), olw->TypeList ) )
-        ObjectCount += PlanNebCount;
-
-    applyFilters( false ); //false = only adjust counts, do not build list
+    applyFilters( false ); //false = only count objects, do not build list
     QApplication::restoreOverrideCursor();
     olw->updateButton->setDisabled( true );
 }
 
-void ObsListWizard::applyFilters( bool doBuildList )
+void ObsListWizard::readFilters()
 {
-    bool filterPass = true;
-    KStarsData* data = KStarsData::Instance();
-    if ( doBuildList )
-        obsList().clear();
+    if ( isItemSelected( i18n("by constellation"), olw->RegionList ) )
+        m_Region = Constellations;
+    else if ( isItemSelected( i18n("in a rectangular region"), olw->RegionList ) )
+        m_Region = Rectangle;
+    else if ( isItemSelected( i18n("in a circular region"), olw->RegionList ) )
+        m_Region = Circle;
+    else
+        m_Region = AllSky;
+    m_ConstellationSelected.clear();
+
+    m_ByMag = olw->SelectByMagnitude->isChecked();
+    m_MagLimit = m_ByMag ? olw->Mag->value() : 100.;
+    m_IncludeNoMag = olw->IncludeNoMag->isChecked();
+    m_ByDate = olw->SelectByDate->isChecked();
+
+    m_Stars        = isItemSelected( i18n( "Stars" ), olw->TypeList );
+    m_OpenClusters = isItemSelected( i18n( "Open clusters" ), olw->TypeList );
+    m_GlobClusters = isItemSelected( i18n( "Globular clusters" ), olw->TypeList );
+    m_GasNebulae   = isItemSelected( i18n( "Gaseous nebulae" ), olw->TypeList );
+    m_PlanNebulae  = isItemSelected( i18n( "Planetary nebulae" ), olw->TypeList );
+    m_Galaxies     = isItemSelected( i18n( "Galaxies" ), olw->TypeList );
+}
 
-    //We don't need to call applyRegionFilter() if no region filter is selected, *and*
-    //we are just counting items (i.e., doBuildList is false)
-    bool needRegion = true;
-    if ( !doBuildList && isItemSelected( i18n( "all over the sky" ), olw->RegionList ) )
-        needRegion = false;
+bool ObsListWizard::isTypeSelected( SkyObject *o ) const
+{
+    switch ( o->type() ) {
+    case SkyObject::STAR:
+    case SkyObject::CATALOG_STAR:
+        return m_Stars;
+    case SkyObject::OPEN_CLUSTER:
+        return m_OpenClusters;
+    case SkyObject::GLOBULAR_CLUSTER:
+        return m_GlobClusters;
+    case SkyObject::GASEOUS_NEBULA:
+    case SkyObject::SUPERNOVA_REMNANT:
+        return m_GasNebulae;
+    case SkyObject::PLANETARY_NEBULA:
+        return m_PlanNebulae;
+    case SkyObject::GALAXY:
+        return m_Galaxies;
+    default:
+        return false;
+    }
+}
 
-    double maglimit = 100.;
-    if ( olw->SelectByMagnitude->isChecked() )
-        maglimit = olw->Mag->value();
+bool ObsListWizard::passesMagFilter( SkyObject *o ) const
+{
+    if ( ! m_ByMag )
+        return true;
+    if ( o->mag() > 90. )
+        return m_IncludeNoMag;
+    return o->mag() <= m_MagLimit;
+}
 
-    //Stars
-    if ( isItemSelected( i18n( "Stars" ), olw->TypeList ) )
-    {
-        const QList<SkyObject*>& starList = data->skyComposite()->stars();
-        int starIndex( starList.size() );
-        if ( maglimit < 100. )
-        {
-            //Stars are sorted by mag, so use binary search algo to find index of faintest mag
-            int low(0), high(starList.size()-1), middle(high);
-            while ( low < high )
-            {
-                middle = (low + high)/2;
-                if ( maglimit == starList.at(middle)->mag() )
-                    break;
-                if ( maglimit <  starList.at(middle)->mag() )
-                    high = middle - 1;
-                if ( maglimit >  starList.at(middle)->mag() )
-                    low = middle + 1;
-            }
-            //now, the star at "middle" has the right mag, but we want the *last* star that has this mag.
-            for ( starIndex=middle+1; starIndex < starList.size(); ++starIndex )
-            {
-                if ( starList.at(starIndex)->mag() > maglimit )
-                    break;
-            }
+void ObsListWizard::appendByMag( const QVector<SkyObject*> &sorted, QList<SkyObject*> &list ) const
+{
+    int bright = m_ByMag ? countBrighter( sorted, m_MagLimit ) : sorted.size();
+    for ( int i = 0; i < bright; ++i ) {
+        if ( isTypeSelected( sorted[i] ) )
+            list.append( sorted[i] );
+    }
+
+    //Objects without a magnitude are at the end
+    if ( m_ByMag && m_IncludeNoMag ) {
+        for ( int i = qMax( bright, countBrighter( sorted, 90. ) ); i < sorted.size(); ++i ) {
+            if ( isTypeSelected( sorted[i] ) )
+                list.append( sorted[i] );
         }
+    }
+}
 
-        //DEBUG
-        kDebug() << QString("starIndex for mag %1: %2").arg(maglimit).arg(starIndex) << endl;
+double ObsListWizard::regionBoundingCircle( SkyPoint *center ) const
+{
+    if ( m_Region == Circle ) {
+        *center = pCirc;
+        return rCirc;
+    }
 
-        if( !doBuildList )
-        {
-            //reduce StarCount by appropriate amount
-            ObjectCount -= StarCount;
-            ObjectCount += starIndex;
+    if ( m_Region == Rectangle ) {
+        center->set( dms( 7.5*( xRect1 + xRect2 ) ), dms( 0.5*( yRect1 + yRect2 ) ) );
+
+        //The edges of constant Dec are not great circles, so walk along the
+        //border; the extra degree covers the parts between the samples
+        double radius = 0.0;
+        for ( int i = 0; i <= 8; ++i ) {
+            double ra  = 15.0*( xRect1 + ( xRect2 - xRect1 )*i/8.0 );
+            double dec = yRect1 + ( yRect2 - yRect1 )*i/8.0;
+            SkyPoint border[4] = { SkyPoint( dms( ra ), dms( yRect1 ) ), SkyPoint( dms( ra ), dms( yRect2 ) ),
+                                   SkyPoint( dms( 15.0*xRect1 ), dms( dec ) ), SkyPoint( dms( 15.0*xRect2 ), dms( dec ) ) };
+            for ( int j = 0; j < 4; ++j )
+                radius = qMax( radius, center->angularDistanceTo( &border[j] ).Degrees() );
         }
-        for ( int i=0; i < starIndex; ++i )
-        {
-            SkyObject *o = (SkyObject*)(starList[i]);
-
-            // JM 2012-10-22: Skip unnamed stars
-            if (o->name() == "star")
-            {
-                if ( ! doBuildList )
-                       --ObjectCount;
-                continue;
-            }
+        return radius + 1.0;
+    }
 
-            if ( needRegion )
-                filterPass = applyRegionFilter( o, doBuildList, !doBuildList);
-            //Filter objects visible from geo at Date if region filter passes
-            if ( olw->SelectByDate->isChecked() && filterPass)
-                applyObservableFilter( o, doBuildList, !doBuildList);
-        }
+    return 180.0;
+}
+
+void ObsListWizard::fixedObjectCandidates( QList<SkyObject*> &list )
+{
+    SkyPoint center;
+    double radius = regionBoundingCircle( &center );
+    if ( radius >= 90.0 ) {
+        appendByMag( m_ObjectsByMag, list );
+        return;
     }
 
-    //Sun, Moon, Planets
-    if ( isItemSelected( i18n( "Sun, moon, planets" ), olw->TypeList ) )
-    {
-            if (maglimit < data->skyComposite()->findByName("Sun")->mag())
-            {
-                if ( ! doBuildList )
-                       --ObjectCount;
-                filterPass = false;
-            }
-            else
-                filterPass = true;
-
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName("Sun"), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName("Sun"), doBuildList );
-
-            if (maglimit < data->skyComposite()->findByName("Moon")->mag())
-            {
-                if ( ! doBuildList )
-                       --ObjectCount;
-                filterPass = false;
-            }
-            else filterPass = true;
-
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName("Moon"), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName("Moon"), doBuildList );
-
-            if (maglimit < data->skyComposite()->findByName("Mercury")->mag())
-            {
-                if ( ! doBuildList )
-                       --ObjectCount;
-                filterPass = false;
-            }
-            else
-                filterPass = true;
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Mercury" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                 applyObservableFilter( data->skyComposite()->findByName(i18n( "Mercury" )), doBuildList );
-
-            if (maglimit < data->skyComposite()->findByName("Venus")->mag())
-            {
-                if ( ! doBuildList )
-                       --ObjectCount;
-                filterPass = false;
-            }
-            else
-                filterPass = true;
-
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Venus" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Venus" )), doBuildList );
-
-            if (maglimit < data->skyComposite()->findByName("Mars")->mag())
-            {
-                if ( ! doBuildList )
-                       --ObjectCount;
-                filterPass = false;
-            }
-            else
-                filterPass = true;
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Mars" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Mars" )), doBuildList );
-
-            if (maglimit < data->skyComposite()->findByName("Jupiter")->mag())
-            {
-                if ( ! doBuildList )
-                       --ObjectCount;
-                filterPass = false;
-            }
-            else
-                filterPass = true;
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Jupiter" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Jupiter" )), doBuildList );
-
-            if (maglimit < data->skyComposite()->findByName("Saturn")->mag())
-            {
-                if ( ! doBuildList )
-                       --ObjectCount;
-                filterPass = false;
-            }
-            else
-                filterPass = true;
-
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Saturn" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Saturn" )), doBuildList );
-
-            if (maglimit < data->skyComposite()->findByName("Uranus")->mag())
-            {
-                if ( ! doBuildList )
-                       --ObjectCount;
-                filterPass = false;
-            }
-            else
-                filterPass = true;
-
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Uranus" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Uranus" )), doBuildList );
-
-            if (maglimit < data->skyComposite()->findByName("Neptune")->mag())
-            {
-                if ( ! doBuildList )
-                       --ObjectCount;
-                filterPass = false;
-            }
-            else
-                filterPass = true;
+    SkyMesh *mesh = SkyMesh::Instance();
+    if ( m_ObjectsByTrixel.isEmpty() ) {
+        //m_ObjectsByMag is sorted, so each trixel's list is too
+        foreach ( SkyObject *o, m_ObjectsByMag )
+            m_ObjectsByTrixel[ mesh->index( o ) ].append( o );
+    }
 
+    //The objects are indexed by their catalog coordinates, the region is in
+    //current ones, so allow a degree for precession
+    MeshBuffer buffer( mesh );
+    mesh->index( &buffer, &center, radius + 1.0 );
+    MeshIterator region( &buffer );
+    while ( region.hasNext() ) {
+        QHash<Trixel, QVector<SkyObject*> >::const_iterator it = m_ObjectsByTrixel.constFind( region.next() );
+        if ( it != m_ObjectsByTrixel.constEnd() )
+            appendByMag( it.value(), list );
+    }
 
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Neptune" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Neptune" )), doBuildList );
+    //Brightest first, as without a region
+    qStableSort( list.begin(), list.end(), brighterThan );
+}
 
-            if (maglimit < data->skyComposite()->findByName("Pluto")->mag())
-            {
-                if ( ! doBuildList )
-                       --ObjectCount;
-                filterPass = false;
-            }
-            else
-                filterPass = true;
+void ObsListWizard::applyFilters( bool doBuildList )
+{
+    KStarsData* data = KStarsData::Instance();
+    if ( doBuildList )
+        obsList().clear();
 
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Pluto" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Pluto" )), doBuildList );
-        }
+    readFilters();
+    if ( m_ByDate )
+        updateVisibilityGrid();
 
-    //Deep sky objects
-    bool dso = ( isItemSelected( i18n( "Open clusters" ), olw->TypeList )
-                 || isItemSelected( i18n( "Globular clusters" ), olw->TypeList )
-                 || isItemSelected( i18n( "Gaseous nebulae" ), olw->TypeList )
-                 || isItemSelected( i18n( "Planetary nebulae" ), olw->TypeList )
-                 || isItemSelected( i18n( "Galaxies" ), olw->TypeList ) );
+    //Collect the objects of the selected types that pass the magnitude
+    //filter, then check region and observability
+    QList<SkyObject*> candidates;
 
-    if ( dso )
+    //Stars and deep sky objects
+    fixedObjectCandidates( candidates );
+
+    //Sun, Moon, Planets
+    if ( isItemSelected( i18n( "Sun, moon, planets" ), olw->TypeList ) )
     {
-        //Don't need to do anything if we are just counting objects and not
-        //filtering by region or magnitude
-        if ( needRegion || olw->SelectByMagnitude->isChecked() || olw->SelectByDate->isChecked())
-        {
-            foreach ( DeepSkyObject *o, data->skyComposite()->deepSkyObjects() )
-            {
-                //Skip unselected object types
-                bool typeSelected = false;
-               // if ( (o->type() == SkyObject::STAR || o->type() == SkyObject::CATALOG_STAR) &&
-                 //       isItemSelected( i18n( "Stars" ), olw->TypeList ) )
-                   // typeSelected = true;
-                 switch (o->type())
-                 {
-                 case SkyObject::OPEN_CLUSTER:
-                    if (isItemSelected( i18n( "Open clusters" ), olw->TypeList ))
-                        typeSelected = true;
-                    break;
-
-                 case SkyObject::GLOBULAR_CLUSTER:
-                    if (isItemSelected( i18n( "Globular clusters" ), olw->TypeList ) )
-                        typeSelected = true;
-                    break;
-
-                 case SkyObject::GASEOUS_NEBULA:
-                 case SkyObject::SUPERNOVA_REMNANT:
-                        if (isItemSelected( i18n( "Gaseous nebulae" ), olw->TypeList ) )
-                            typeSelected = true;
-                        break;
-
-                 case SkyObject::PLANETARY_NEBULA:
-                        if (isItemSelected( i18n( "Planetary nebulae" ), olw->TypeList ) )
-                            typeSelected = true;
-                            break;
-                 case SkyObject::GALAXY:
-                        if (isItemSelected( i18n( "Galaxies" ), olw->TypeList ) )
-                            typeSelected = true;
-                        break;
-
-                    }
-
-                if ( ! typeSelected ) continue;
-
-                if ( olw->SelectByMagnitude->isChecked() )
-                {
-                    if ( o->mag() > 90. )
-                    {
-                        if ( olw->IncludeNoMag->isChecked() )
-                        {
-                            if ( needRegion )
-                                filterPass = applyRegionFilter( o, doBuildList );
-                            if ( olw->SelectByDate->isChecked() && filterPass)
-                                applyObservableFilter( o, doBuildList );
-                        }
-                        else if ( ! doBuildList )
-                            --ObjectCount;
-                     }
-                    else
-                    {
-                        if ( o->mag() <= maglimit )
-                        {
-                            if ( needRegion )
-                                filterPass = applyRegionFilter( o, doBuildList );
-                            if ( olw->SelectByDate->isChecked() && filterPass)
-                                applyObservableFilter( o, doBuildList );
-                        } else if ( ! doBuildList )
-                            --ObjectCount;
-                    }
-                }
-                else
-                {
-                    if ( needRegion )
-                        filterPass = applyRegionFilter( o, doBuildList );
-                    if ( olw->SelectByDate->isChecked() && filterPass)
-                        applyObservableFilter( o, doBuildList );
-                }
-            }
+        //Sun and Moon are looked up by their untranslated names, the planets
+        //by their translated ones
+        QStringList names;
+        names << "Sun" << "Moon" << i18n( "Mercury" ) << i18n( "Venus" ) << i18n( "Mars" )
+              << i18n( "Jupiter" ) << i18n( "Saturn" ) << i18n( "Uranus" ) << i18n( "Neptune" )
+              << i18n( "Pluto" );
+        foreach ( const QString &name, names ) {
+            SkyObject *o = data->skyComposite()->findByName( name );
+            if ( o && o->mag() <= m_MagLimit )
+                candidates.append( o );
         }
     }
 
     //Comets
     if ( isItemSelected( i18n( "Comets" ), olw->TypeList ) )
-    {
-        foreach ( SkyObject *o, data->skyComposite()->comets() )
-        {
-            if ( needRegion )
-                filterPass = applyRegionFilter( o, doBuildList );
-            if ( olw->SelectByDate->isChecked() && filterPass)
-                applyObservableFilter( o, doBuildList );
-        }
-    }
+        candidates += data->skyComposite()->comets();
 
     //Asteroids
     if ( isItemSelected( i18n( "Asteroids" ), olw->TypeList ) )
     {
-        foreach ( SkyObject *o, data->skyComposite()->asteroids() )
-        {
-            if ( olw->SelectByMagnitude->isChecked() )
-            {
-                if ( o->mag() > 90. )
-                {
-                    if ( olw->IncludeNoMag->isChecked() )
-                        if ( needRegion )
-                            filterPass = applyRegionFilter( o, doBuildList );
-                        if ( olw->SelectByDate->isChecked() && filterPass)
-                            applyObservableFilter( o, doBuildList );
-                    else if ( ! doBuildList )
-                        --ObjectCount;
-                }
-                else
-                {
-                    if ( o->mag() <= maglimit )
-                        if ( needRegion )
-                            filterPass = applyRegionFilter( o, doBuildList );
-                        if ( olw->SelectByDate->isChecked() && filterPass)
-                            applyObservableFilter( o, doBuildList );
-                    else if ( ! doBuildList )
-                        --ObjectCount;
-                }
-            }
-            else
-            {
-                if ( needRegion )
-                    filterPass = applyRegionFilter( o, doBuildList );
-                if ( olw->SelectByDate->isChecked() && filterPass)
-                    applyObservableFilter( o, doBuildList );
-            }
+        //Without a magnitude filter, take the asteroids the sky map shows
+        double magLimit = m_ByMag ? m_MagLimit : Options::magLimitAsteroid();
+        foreach ( SkyObject *o, data->skyComposite()->asteroids( magLimit ) ) {
+            if ( passesMagFilter( o ) )
+                candidates.append( o );
         }
     }
 
-    //Update the object count label
-    if ( doBuildList )
-        ObjectCount = obsList().size();
+    ObjectCount = 0;
+    foreach ( SkyObject *o, candidates ) {
+        if ( ! applyRegionFilter( o ) )
+            continue;
+        //Filter objects visible from geo at Date if region filter passes
+        if ( m_ByDate && ! applyObservableFilter( o ) )
+            continue;
+
+        ++ObjectCount;
+        if ( doBuildList )
+            obsList().append( o );
+    }
 
     olw->CountLabel->setText( i18np("Your observing list currently has 1 object", "Your observing list currently has %1 objects", ObjectCount ) );
 }
 
-bool ObsListWizard::applyRegionFilter( SkyObject *o, bool doBuildList,
-                                       bool doAdjustCount )
+bool ObsListWizard::applyRegionFilter( SkyObject *o )
 {
+    switch ( m_Region ) {
     //select by constellation
-    if ( isItemSelected( i18n("by constellation"), olw->RegionList ) )
-    {
-        QString c = KStarsData::Instance()->skyComposite()->getConstellationBoundary()->constellationName( o );
-        if ( isItemSelected( c, olw->ConstellationList ) )
-        {
-            if ( doBuildList )
-                obsList().append ( o );
-
-            return true;
-        }
-        else if ( doAdjustCount )
-        {
-            --ObjectCount;
-            return false;
+    case Constellations: {
+        QString c;
+        if ( o->isSolarSystem() ) {
+            c = KStarsData::Instance()->skyComposite()->getConstellationBoundary()->constellationName( o );
+        } else {
+            QHash<const SkyObject*, QString>::const_iterator it = m_ConstellationCache.constFind( o );
+            if ( it == m_ConstellationCache.constEnd() )
+                it = m_ConstellationCache.insert( o, KStarsData::Instance()->skyComposite()->getConstellationBoundary()->constellationName( o ) );
+            c = it.value();
         }
-        else
-            return false;
+
+        QHash<QString, bool>::const_iterator selected = m_ConstellationSelected.constFind( c );
+        if ( selected == m_ConstellationSelected.constEnd() )
+            selected = m_ConstellationSelected.insert( c, isItemSelected( c, olw->ConstellationList ) );
+        return selected.value();
     }
 
     //select by rectangular region
-    else if ( isItemSelected( i18n("in a rectangular region"), olw->RegionList ) )
-    {
+    case Rectangle: {
         double ra = o->ra().Hours();
         double dec = o->dec().Degrees();
-        bool addObject = false;
-        if ( dec >= yRect1 && dec <= yRect2 ) {
-            if ( xRect1 < 0.0 ) {
-                addObject = ra >= xRect1 + 24.0 || ra <= xRect2;
-            } else {
-                addObject = ra >= xRect1 && ra <= xRect2;
-            }
-        }
-
-        if ( addObject)
-        {
-            if (doBuildList )
-                obsList().append( o );
-
-            return true;
-        }
-
-        else
-        {
-             if (doAdjustCount )
-            --ObjectCount;
-
-             return false;
-        }
+        if ( dec < yRect1 || dec > yRect2 )
+            return false;
+        if ( xRect1 < 0.0 )
+            return ra >= xRect1 + 24.0 || ra <= xRect2;
+        return ra >= xRect1 && ra <= xRect2;
     }
 
     //select by circular region
-    //make sure circ region data are valid
-    else if ( isItemSelected( i18n("in a circular region"), olw->RegionList ) )
-        {
-        if ( o->angularDistanceTo( &pCirc ).Degrees() < rCirc )
-        {
-            if ( doBuildList )
-                obsList().append( o );
+    case Circle:
+        return o->angularDistanceTo( &pCirc ).Degrees() < rCirc;
 
-            return true;
-        }
-        else if ( doAdjustCount )
-        {
-            --ObjectCount;
-            return false;
-        }
-        else
-            return false;
-    }
-
-    //No region filter, just add the object
-    else if ( doBuildList )
-    {
-        obsList().append( o );
+    //No region filter
+    default:
+        return true;
     }
-
-    return true;
 }
 
-bool ObsListWizard::applyObservableFilter( SkyObject *o, bool doBuildList, bool doAdjustCount)
+void ObsListWizard::updateVisibilityGrid()
 {
-    SkyPoint p = *o;
-
     //Check altitude of object every hour from 18:00 to midnight
     //If it's ever above 15 degrees, flag it as visible
     KStarsDateTime Evening( olw->Date->date(), QTime( 18, 0, 0 ) );
@@ -833,30 +646,60 @@ bool ObsListWizard::applyObservableFilter( SkyObject *o, bool doBuildList, bool
         maxAlt = olw->maxAlt->value();
     }
 
-    bool visible = false;
+    if ( m_GridGeo == geo && m_GridFrom == Evening && m_GridTo == Midnight
+         && m_GridMinAlt == minAlt && m_GridMaxAlt == maxAlt )
+        return;
+
+    m_GridGeo = geo;
+    m_GridFrom = Evening;
+    m_GridTo = Midnight;
+    m_GridMinAlt = minAlt;
+    m_GridMaxAlt = maxAlt;
+    m_GridSinLST.clear();
+    m_GridCosLST.clear();
+    m_VisibleCache.clear();
+
     for ( KStarsDateTime t = Evening; t < Midnight; t = t.addSecs( 3600.0 ) )
     {
         dms LST = geo->GSTtoLST( t.gst() );
-        p.EquatorialToHorizontal( &LST, geo->lat() );
+        double sinLST, cosLST;
+        LST.SinCos( sinLST, cosLST );
+        m_GridSinLST.append( sinLST );
+        m_GridCosLST.append( cosLST );
+    }
+}
+
+bool ObsListWizard::applyObservableFilter( SkyObject *o )
+{
+    //Solar system bodies move, everything else is checked once per grid
+    bool cache = ! o->isSolarSystem();
+    if ( cache ) {
+        QHash<const SkyObject*, bool>::const_iterator it = m_VisibleCache.constFind( o );
+        if ( it != m_VisibleCache.constEnd() )
+            return it.value();
+    }
 
-        if ( p.alt().Degrees() >= minAlt && p.alt().Degrees() <= maxAlt )
+    double sinRA, cosRA, sinDec, cosDec, sinLat, cosLat;
+    o->ra().SinCos( sinRA, cosRA );
+    o->dec().SinCos( sinDec, cosDec );
+    geo->lat()->SinCos( sinLat, cosLat );
+
+    //Same as EquatorialToHorizontal() at every point of the grid
+    bool visible = false;
+    for ( int i = 0; i < m_GridSinLST.size(); ++i )
+    {
+        double cosHA = m_GridCosLST[i]*cosRA + m_GridSinLST[i]*sinRA;
+        double alt = asin( qBound( -1.0, sinDec*sinLat + cosDec*cosLat*cosHA, 1.0 ) ) / dms::DegToRad;
+        if ( alt >= m_GridMinAlt && alt <= m_GridMaxAlt )
         {
             visible = true;
             break;
         }
     }
 
-
-    if (visible )
-        return true;
-
-    if ( doAdjustCount )
-            --ObjectCount;
-    if ( doBuildList )
-            obsList().takeAt( obsList().indexOf(o) );
-
-    return false;
-
+    if ( cache )
+        m_VisibleCache.insert( o, visible );
+    return visible;
 }
 
 #include "obslistwizard.moc"
@@ -17,11 +17,17 @@
 #ifndef OBSLISTWIZARD_H_
 #define OBSLISTWIZARD_H_
 
+#include <QHash>
+#include <QVector>
+
 #include <kdialog.h>
 
 #include "ui_obslistwizard.h"
+#include "kstarsdatetime.h"
 #include "skyobjects/skypoint.h"
+#include "skycomponents/typedef.h"
 
+class QTimer;
 class SkyObject;
 class GeoLocation;
 
@@ -69,9 +75,39 @@ private slots:
 private:
     void initialize();
     void applyFilters( bool doBuildList );
+
+    /**@short The region filter chosen on the region page */
+    enum Region { AllSky, Constellations, Rectangle, Circle };
+
+    /**@short Reads the filter settings from the widgets before filtering */
+    void readFilters();
+    /**@return true if the object's type is one of the selected types */
+    bool isTypeSelected( SkyObject *o ) const;
+    /**@return true if the object is bright enough for the magnitude filter */
+    bool passesMagFilter( SkyObject *o ) const;
     /**@return true if the object passes the filter region constraints, false otherwise.*/
-    bool applyRegionFilter( SkyObject *o, bool doBuildList, bool doAdjustCount=true );
-    bool applyObservableFilter( SkyObject *o, bool doBuildList, bool doAdjustCount=true);
+    bool applyRegionFilter( SkyObject *o );
+    /**@return true if the object reaches the selected altitude range in the selected time span */
+    bool applyObservableFilter( SkyObject *o );
+
+    /**@short Fills list with the stars and deep-sky objects of the selected
+     * types that pass the magnitude filter, using the trixel index when the
+     * region is small enough to be worth it.
+     */
+    void fixedObjectCandidates( QList<SkyObject*> &list );
+    /**@short Appends the objects of sorted (ordered by magnitude) that pass
+     * the magnitude and type filters to list
+     */
+    void appendByMag( const QVector<SkyObject*> &sorted, QList<SkyObject*> &list ) const;
+    /**@return the radius (degrees) of a circle around center that contains
+     * the selected region, or 180 if there is none
+     */
+    double regionBoundingCircle( SkyPoint *center ) const;
+    /**@short Computes the sidereal times of the observable filter for the
+     * selected date, time span and location, and forgets cached results if
+     * they changed
+     */
+    void updateVisibilityGrid();
 
     /**
     	*Convenience function for safely getting the selected state of a QListWidget item by name.
@@ -94,11 +130,32 @@ private:
 
     QList<SkyObject*> ObsList;
     ObsListWizardUI *olw;
-    uint ObjectCount, StarCount, PlanetCount, CometCount, AsteroidCount;
-    uint GalaxyCount, OpenClusterCount, GlobClusterCount, GasNebCount, PlanNebCount;
+    uint ObjectCount;
     double xRect1, xRect2, yRect1, yRect2, rCirc;
     SkyPoint pCirc;
     GeoLocation *geo;
+    QTimer *m_CountTimer;
+
+    // Filter settings, read once per pass by readFilters()
+    Region m_Region;
+    QHash<QString, bool> m_ConstellationSelected; // filled as constellations are met
+    bool m_ByMag, m_IncludeNoMag, m_ByDate;
+    double m_MagLimit;
+    bool m_Stars, m_OpenClusters, m_GlobClusters, m_GasNebulae, m_PlanNebulae, m_Galaxies;
+
+    // Named stars and deep-sky objects ordered by magnitude, and the same
+    // objects by trixel (built on first use), each list ordered by magnitude
+    QVector<SkyObject*> m_ObjectsByMag;
+    QHash<Trixel, QVector<SkyObject*> > m_ObjectsByTrixel;
+    QHash<const SkyObject*, QString> m_ConstellationCache;
+
+    // Sidereal times of the observable filter and the results for the
+    // objects checked so far
+    QVector<double> m_GridSinLST, m_GridCosLST;
+    KStarsDateTime m_GridFrom, m_GridTo;
+    double m_GridMinAlt, m_GridMaxAlt;
+    GeoLocation *m_GridGeo;
+    QHash<const SkyObject*, bool> m_VisibleCache;
 };
 
 #endif
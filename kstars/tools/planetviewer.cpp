@@ -38,6 +38,7 @@
 #include "ksutils.h"
 #include "ksnumbers.h"
 #include "ksfilereader.h"
+#include "ephemerisfile.h"
 #include "skyobjects/ksplanetbase.h"
 #include "skyobjects/ksplanet.h"
 #include "skyobjects/kspluto.h"
@@ -220,7 +221,12 @@ void PlanetViewer::initPlotObjects() {
 
         QFile orbitFile;
         QString orbitFileName = ( p->isMajorPlanet() ? ((KSPlanet *)p)->untranslatedName().toLower() : p->name().toLower() ) + ".orbit";
-        if ( KSUtils::openDataFile( orbitFile, orbitFileName ) ) {
+        int rows;
+        const double *points = EphemerisFile::Instance()->table( orbitFileName, 3, &rows );
+        if ( points ) {
+            for ( int j = 0; j < rows; ++j, points += 3 )
+                orbit[i]->addPoint( points[0], points[1] );
+        } else if ( KSUtils::openDataFile( orbitFile, orbitFileName ) ) {
             KSFileReader fileReader( orbitFile ); // close file is included
             double x,y;
             while ( fileReader.hasMoreLines() ) {
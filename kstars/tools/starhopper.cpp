@@ -25,7 +25,26 @@
 #include "ksutils.h"
 
 #include <QList>
+#include <QSet>
+#include <QVector>
 
+#include <algorithm>
+
+
+namespace {
+    // An entry of the open set of the A* search. A node may be in the
+    // heap several times when its score improves; the stale entries are
+    // skipped when they come up.
+    struct OpenNode {
+        double f_score;
+        SkyPoint const *node;
+    };
+
+    // Orders the heap so that the lowest f_score is on top
+    bool laterThan( const OpenNode &a, const OpenNode &b ) {
+        return a.f_score > b.f_score;
+    }
+}
 
 QList<const StarObject *> StarHopper::computePath( const SkyPoint &src, const SkyPoint &dest, float fov_, float maglim_ ) {
 
@@ -36,35 +55,34 @@ QList<const StarObject *> StarHopper::computePath( const SkyPoint &src, const Sk
 
     came_from.clear();
     result_path.clear();
+    // Star blocks may be reused between searches, so nothing is kept
+    star_info.clear();
     
 
-    // Implements the A* search algorithm
+    // Implements the A* search algorithm, with the open set in a binary heap
     
-    QList<SkyPoint const *> cSet;
-    QList<SkyPoint const *> oSet;
+    QSet<SkyPoint const *> cSet;
+    QVector<OpenNode> oHeap;
     QHash<SkyPoint const *, double> g_score;
-    QHash<SkyPoint const *, double> f_score;
     QHash<SkyPoint const *, double> h_score;
 
     kDebug() << "StarHopper is trying to compute a path from source: " << src.ra().toHMSString() << src.dec().toDMSString() << " to destination: " << dest.ra().toHMSString() << dest.dec().toDMSString() << "; a starhop of " << src.angularDistanceTo( &dest ).Degrees() << " degrees!";
 
-    oSet.append( &src );
     g_score[ &src ] = 0;
     h_score[ &src ] = src.angularDistanceTo( &dest ).Degrees()/fov;
-    f_score[ &src ] = h_score[ &src ];
+    OpenNode first = { h_score[ &src ], &src };
+    oHeap.append( first );
     
-    while( !oSet.isEmpty() ) {
-        kDebug() << "Next step";
-        // Find the node with the lowest f_score value
-        SkyPoint const *curr_node = NULL;
-        double lowfscore = 1.0e8;
-        foreach( const SkyPoint *sp, oSet ) {
-            if( f_score[ sp ] < lowfscore ) {
-                lowfscore = f_score[ sp ];
-                curr_node = sp;
-            }
-        }
-        kDebug() << "Lowest fscore (vertex distance-plus-cost score) is " << lowfscore << " with coords: " << curr_node->ra().toHMSString() << curr_node->dec().toDMSString() << ". Considering this node now.";
+    while( !oHeap.isEmpty() ) {
+        // Take the node with the lowest f_score value
+        std::pop_heap( oHeap.begin(), oHeap.end(), laterThan );
+        OpenNode top = oHeap.last();
+        oHeap.remove( oHeap.size() - 1 );
+        SkyPoint const *curr_node = top.node;
+        if( cSet.contains( curr_node ) || top.f_score > g_score[ curr_node ] + h_score[ curr_node ] )
+            continue; // stale entry
+
+        kDebug() << "Lowest fscore (vertex distance-plus-cost score) is " << top.f_score << " with coords: " << curr_node->ra().toHMSString() << curr_node->dec().toDMSString() << ". Considering this node now.";
         if( curr_node == &dest || (curr_node != &src && h_score[ curr_node ] < 0.5) ) {
             // We are at destination
             reconstructPath( came_from[ curr_node ] );
@@ -92,11 +110,11 @@ QList<const StarObject *> StarHopper::computePath( const SkyPoint &src, const Sk
             }
             kDebug() << "  The destination is within a field-of-view";
 
+            star_info.clear();
             return result_path;
         }
         
-        oSet.removeOne( curr_node );
-        cSet.append( curr_node );
+        cSet.insert( curr_node );
 
         // FIXME: Make sense. If current node ---> dest distance is
         // larger than src --> dest distance by more than 20%, don't
@@ -118,8 +136,7 @@ QList<const StarObject *> StarHopper::computePath( const SkyPoint &src, const Sk
         // equatorial and horizontal coordinates nicely
         SkyPoint *CurrentNode = const_cast<SkyPoint *>(curr_node);
         CurrentNode->deprecess( KStarsData::Instance()->updateNum() );
-        kDebug() << "Calling starsInAperture";
-        StarComponent::Instance()->starsInAperture( neighbors, *curr_node, fov, maglim );
+        findNeighbors( curr_node, neighbors );
         kDebug() << "Choosing next node from a set of " << neighbors.count();
         // Look for the potential next node
         double curr_g_score = g_score[ curr_node ];
@@ -129,25 +146,20 @@ QList<const StarObject *> StarHopper::computePath( const SkyPoint &src, const Sk
             
             // Compute the tentative g_score
             double tentative_g_score = curr_g_score + cost( curr_node, nhd_node );
-            bool tentative_better;
-            if( !oSet.contains( nhd_node ) ) {
-                oSet.append( nhd_node );
-                tentative_better = true;
-            }
-            else if( tentative_g_score < g_score[ nhd_node ] )
-                tentative_better = true;
-            else
-                tentative_better = false;
-            
-            if( tentative_better ) {
+            QHash<SkyPoint const *, double>::const_iterator it = g_score.constFind( nhd_node );
+            if( it == g_score.constEnd() || tentative_g_score < it.value() ) {
                 came_from[ nhd_node ] = curr_node;
                 g_score[ nhd_node ] = tentative_g_score;
-                h_score[ nhd_node ] = nhd_node->angularDistanceTo( &dest ).Degrees() / fov;
-                f_score[ nhd_node ] = g_score[ nhd_node ] + h_score[ nhd_node ];
+                if( !h_score.contains( nhd_node ) )
+                    h_score[ nhd_node ] = nhd_node->angularDistanceTo( &dest ).Degrees() / fov;
+                OpenNode open = { tentative_g_score + h_score[ nhd_node ], nhd_node };
+                oHeap.append( open );
+                std::push_heap( oHeap.begin(), oHeap.end(), laterThan );
             }
         }
     }
     kDebug() << "REGRET! Returning empty list!";
+    star_info.clear();
     return QList<StarObject const *>(); // Return an empty QList
 }
 
@@ -160,6 +172,34 @@ void StarHopper::reconstructPath( SkyPoint const *curr_node ) {
     }
 }
 
+StarHopper::StarInfo StarHopper::starInfo( const StarObject *star ) {
+    QHash<const SkyPoint *, StarInfo>::const_iterator it = star_info.constFind( star );
+    if( it != star_info.constEnd() )
+        return it.value();
+
+    // One query serves the neighbours of the star (down to maglim),
+    // the star density (down to maglim + 1) and the patterns (within
+    // 1 magnitude of the star, so never fainter than maglim + 1)
+    StarInfo info;
+    StarComponent::Instance()->starsInAperture( info.aperture, *star, fov, maglim + 1.0 );
+    info.cost = starCost( star, info.aperture );
+    star_info.insert( star, info );
+    return info;
+}
+
+void StarHopper::findNeighbors( const SkyPoint *node, QList<StarObject *> &neighbors ) {
+    StarObject const *star = dynamic_cast<StarObject const *>(node);
+    if( !star ) {
+        StarComponent::Instance()->starsInAperture( neighbors, *node, fov, maglim );
+        return;
+    }
+
+    foreach( StarObject *s, starInfo( star ).aperture ) {
+        if( s->mag() <= maglim )
+            neighbors.append( s );
+    }
+}
+
 float StarHopper::cost( const SkyPoint *curr, const SkyPoint *next ) {
 
     // This is a very heuristic method, that tries to produce a cost
@@ -174,39 +214,18 @@ float StarHopper::cost( const SkyPoint *curr, const SkyPoint *next ) {
     }
     bool isThisTheEnd = (next == end);
 
-    float magcost, speccost;
-    magcost = speccost = 0;
-
+    float starcost;
     if( !isThisTheEnd ) {
         // We ought to be dealing with a star
         StarObject const *nextstar = dynamic_cast<StarObject const *>(next);
         Q_ASSERT( nextstar );
-
-        // Test 1: How bright is the star?
-        magcost = nextstar->mag() - 7.0 + 5 * log10( fov ); // The brighter, the better. FIXME: 8.0 is now an arbitrary reference to the average faint star. Should actually depend on FOV, something like log( FOV ).
-    
-        // Test 2: Is the star strikingly red / yellow coloured?
-        QString SpType = nextstar->sptype();
-        char spclass = SpType.at( 0 ).toAscii();
-        speccost = ( spclass == 'G' || spclass == 'K' || spclass == 'M' ) ? -0.3 : 0;
-        /*
-        // Test 3: Is the star in the general direction of the object?
-        // We use the cosine rule to find the angle between the hop direction, and the direction to destination
-        // a = side joining curr to end
-        // b = side joining curr to next
-        // c = side joining next to end
-        // C = angle between curr-next and curr-end
-        double sina, sinb, cosa, cosb;
-        curr->angularDistanceTo(dest).SinCos( &sina, &cosa );
-        curr->angularDistanceTo(next).SinCos( &sinb, &cosb );
-        double cosc = cos(next->angularDistanceTo(end).radians());
-        double cosC = ( cosc - cosa * cosb ) / (sina * sinb);
-        float dircost;
-        if( cosC < 0 ) // Wrong direction!
-        dircost = 1e8; // Some humongous number;
-        else
-        dircost = sqrt( 1 - cosC * cosC ) / cosC; // tan( C )
-        */
+        starcost = starInfo( nextstar ).cost;
+    }
+    else {
+        // Only the star density counts for the destination
+        QList<StarObject *> localNeighbors;
+        StarComponent::Instance()->starsInAperture( localNeighbors, *next, fov/10, maglim + 1.0 );
+        starcost = 1 - localNeighbors.count();
     }
         
     // Test 4: How far is the hop?
@@ -215,10 +234,58 @@ float StarHopper::cost( const SkyPoint *curr, const SkyPoint *next ) {
     // Test 5: How effective is the hop? [Might not be required with A*]
     //    double distredcost = -((src->angularDistanceTo( dest ).Degrees() - next->angularDistanceTo( dest ).Degrees()) * 60 / fov)*3; // 3 "magnitudes" for 1 FOV closer
 
+    netcost = starcost + distcost;
+    if( netcost < 0 )
+        netcost = 0.1; // FIXME: Heuristics aren't supposed to be entirely random. This one is.
+    kDebug() << "Star cost: " << starcost << "; Dist Cost: " << distcost << "; Net cost: " << netcost;
+    return netcost;
+}
+
+float StarHopper::starCost( const StarObject *nextstar, const QList<StarObject *> &aperture ) {
+
+    float magcost, speccost;
+
+    // Test 1: How bright is the star?
+    magcost = nextstar->mag() - 7.0 + 5 * log10( fov ); // The brighter, the better. FIXME: 8.0 is now an arbitrary reference to the average faint star. Should actually depend on FOV, something like log( FOV ).
+    
+    // Test 2: Is the star strikingly red / yellow coloured?
+    QString SpType = nextstar->sptype();
+    char spclass = SpType.at( 0 ).toAscii();
+    speccost = ( spclass == 'G' || spclass == 'K' || spclass == 'M' ) ? -0.3 : 0;
+    /*
+    // Test 3: Is the star in the general direction of the object?
+    // We use the cosine rule to find the angle between the hop direction, and the direction to destination
+    // a = side joining curr to end
+    // b = side joining curr to next
+    // c = side joining next to end
+    // C = angle between curr-next and curr-end
+    double sina, sinb, cosa, cosb;
+    curr->angularDistanceTo(dest).SinCos( &sina, &cosa );
+    curr->angularDistanceTo(next).SinCos( &sinb, &cosb );
+    double cosc = cos(next->angularDistanceTo(end).radians());
+    double cosC = ( cosc - cosa * cosb ) / (sina * sinb);
+    float dircost;
+    if( cosC < 0 ) // Wrong direction!
+    dircost = 1e8; // Some humongous number;
+    else
+    dircost = sqrt( 1 - cosC * cosC ) / cosC; // tan( C )
+    */
+
     // Test 6: Is the destination an asterism? Are there bright stars clustered nearby?
-    QList<StarObject *> localNeighbors;
-    StarComponent::Instance()->starsInAperture( localNeighbors, *next, fov/10, maglim + 1.0 );
-    double stardensitycost = 1 - localNeighbors.count(); // -1 "magnitude" for every neighbouring star
+    // Also collect the stars of similar magnitude for the pattern test
+    int density = 0;
+    QList<StarObject *> similar;
+    QList<double> similarDist;
+    foreach( StarObject *star, aperture ) {
+        double dist = star->angularDistanceTo( nextstar ).Degrees();
+        if( dist <= fov/10 )
+            density++;
+        if( star != nextstar && fabs( star->mag() - nextstar->mag() ) <= 1.0 ) {
+            similar.append( star );
+            similarDist.append( dist );
+        }
+    }
+    double stardensitycost = 1 - density; // -1 "magnitude" for every neighbouring star
 
     // Test 7: Identify star patterns
 
@@ -227,73 +294,65 @@ float StarHopper::cost( const SkyPoint *curr, const SkyPoint *next ) {
 
     double patterncost = 0;
     QString patternName;
-    if( !isThisTheEnd ) {
-        // We ought to be dealing with a star
-        StarObject const *nextstar = dynamic_cast<StarObject const *>(next);
-        Q_ASSERT( nextstar );
 
-        float factor = 1.0;
-        while( factor <= 10.0 ) {
-            localNeighbors.clear();
-            StarComponent::Instance()->starsInAperture( localNeighbors, *next, fov/factor, nextstar->mag() + 1.0 ); // Use a larger aperture for pattern identification; max 1.0 mag difference
-            foreach( StarObject *star, localNeighbors ) {
-                if( star == nextstar )
-                    localNeighbors.removeOne( star );
-                else if( fabs( star->mag() - nextstar->mag() ) > 1.0 )
-                    localNeighbors.removeOne( star );
-            } // Now, we should have a pruned list
-            factor += 1.0;
-            if( localNeighbors.size() == 2 )
-                break;
+    QList<StarObject *> localNeighbors;
+    float factor = 1.0;
+    while( factor <= 10.0 ) {
+        // Use a larger aperture for pattern identification; max 1.0 mag difference
+        localNeighbors.clear();
+        for( int i = 0; i < similar.size(); ++i ) {
+            if( similarDist[ i ] <= fov/factor )
+                localNeighbors.append( similar[ i ] );
+        }
+        factor += 1.0;
+        if( localNeighbors.size() == 2 )
+            break;
+    }
+    factor -= 1.0;
+    if( localNeighbors.size() == 2 ) {
+        patternName = "triangle (of similar magnitudes)"; // any three stars form a triangle!
+        // Try to find triangles. Note that we assume that the standard Euclidian metric works on a sphere for small angles, i.e. the celestial sphere is nearly flat over our FOV.
+        StarObject *star1 = localNeighbors[0];
+        double dRA1 = nextstar->ra().radians() - star1->ra().radians();
+        double dDec1 = nextstar->dec().radians() - star1->dec().radians();
+        double dist1sqr = dRA1 * dRA1 + dDec1 * dDec1;
+
+        StarObject *star2 = localNeighbors[1];
+        double dRA2 = nextstar->ra().radians() - star2->ra().radians();
+        double dDec2 = nextstar->dec().radians() - star2->dec().radians();
+        double dist2sqr = dRA2 * dRA2 + dDec2 * dDec2;
+
+        // Check for right-angled triangles (without loss of generality, right angle is at this vertex)
+        if( fabs( (dRA1 * dRA2 - dDec1 * dDec2)/sqrt( dist1sqr * dist2sqr ) ) < RIGHT_ANGLE_THRESHOLD ) {
+            // We have a right angled triangle! Give -3 magnitudes!
+            patterncost += -3;
+            patternName = "right-angled triangle";
         }
-        factor -= 1.0;
-        if( localNeighbors.size() == 2 ) {
-            patternName = "triangle (of similar magnitudes)"; // any three stars form a triangle!
-            // Try to find triangles. Note that we assume that the standard Euclidian metric works on a sphere for small angles, i.e. the celestial sphere is nearly flat over our FOV.
-            StarObject *star1 = localNeighbors[0];
-            double dRA1 = nextstar->ra().radians() - star1->ra().radians();
-            double dDec1 = nextstar->dec().radians() - star1->dec().radians();
-            double dist1sqr = dRA1 * dRA1 + dDec1 * dDec1;
-
-            StarObject *star2 = localNeighbors[1];
-            double dRA2 = nextstar->ra().radians() - star2->ra().radians();
-            double dDec2 = nextstar->dec().radians() - star2->dec().radians();
-            double dist2sqr = dRA2 * dRA2 + dDec2 * dDec2;
-
-            // Check for right-angled triangles (without loss of generality, right angle is at this vertex)
-            if( fabs( (dRA1 * dRA2 - dDec1 * dDec2)/sqrt( dist1sqr * dist2sqr ) ) < RIGHT_ANGLE_THRESHOLD ) {
-                // We have a right angled triangle! Give -3 magnitudes!
-                patterncost += -3;
-                patternName = "right-angled triangle";
-            }
 
-            // Check for isosceles triangles (without loss of generality, this is the vertex)
-            if( fabs( (dist1sqr - dist2sqr) / (dist1sqr) ) < EQUAL_EDGE_THRESHOLD ) {
+        // Check for isosceles triangles (without loss of generality, this is the vertex)
+        if( fabs( (dist1sqr - dist2sqr) / (dist1sqr) ) < EQUAL_EDGE_THRESHOLD ) {
+            patterncost += -1;
+            patternName = "isosceles triangle";
+            if( fabs( (dRA2 * dDec1 - dRA1 * dDec2) / sqrt( dist1sqr * dist2sqr ) ) < RIGHT_ANGLE_THRESHOLD ) {
                 patterncost += -1;
-                patternName = "isosceles triangle";
-                if( fabs( (dRA2 * dDec1 - dRA1 * dDec2) / sqrt( dist1sqr * dist2sqr ) ) < RIGHT_ANGLE_THRESHOLD ) {
-                    patterncost += -1;
-                    patternName = "straight line of 3 stars";
-                }
-                // Check for equilateral triangles
-                double dist3 = star1->angularDistanceTo( star2 ).radians();
-                double dist3sqr = dist3 * dist3;
-                if( fabs( (dist3sqr - dist1sqr) / dist1sqr ) < EQUAL_EDGE_THRESHOLD ) {
-                    patterncost += -1;
-                    patternName = "equilateral triangle";
-                }
+                patternName = "straight line of 3 stars";
+            }
+            // Check for equilateral triangles
+            double dist3 = star1->angularDistanceTo( star2 ).radians();
+            double dist3sqr = dist3 * dist3;
+            if( fabs( (dist3sqr - dist1sqr) / dist1sqr ) < EQUAL_EDGE_THRESHOLD ) {
+                patterncost += -1;
+                patternName = "equilateral triangle";
             }
         }
-        // TODO: Identify squares.
-        if( ! patternName.isEmpty() ) {
-            patternName += QString(" within %1% of FOV of the marked star").arg( (int)( 100.0/factor ) );
-            patternNames.insert( nextstar, patternName );
-        }
+    }
+    // TODO: Identify squares.
+    if( ! patternName.isEmpty() ) {
+        patternName += QString(" within %1% of FOV of the marked star").arg( (int)( 100.0/factor ) );
+        patternNames.insert( nextstar, patternName );
     }
 
-    netcost = magcost + speccost + distcost + stardensitycost + patterncost;
-    if( netcost < 0 )
-        netcost = 0.1; // FIXME: Heuristics aren't supposed to be entirely random. This one is.
-    kDebug() << "Mag cost: " << magcost << "; Spec Cost: " << speccost << "; Dist Cost: " << distcost << "; Density cost: " << stardensitycost << "; Pattern cost: " << patterncost << "; Net cost: " << netcost << "; Pattern: " << patternName;
-    return netcost;
+    float starcost = magcost + speccost + stardensitycost + patterncost;
+    kDebug() << "Mag cost: " << magcost << "; Spec Cost: " << speccost << "; Density cost: " << stardensitycost << "; Pattern cost: " << patterncost << "; Pattern: " << patternName;
+    return starcost;
 }
@@ -45,6 +45,28 @@ class StarHopper {
     QHash<const SkyPoint *, const SkyPoint *> came_from; // Used by the A* search algorithm
     QList<StarObject const *> result_path;
 
+    /**
+     *@short Stars around a star of the search, from one aperture query
+     * of radius fov down to maglim + 1, and the part of the hop cost
+     * that depends only on that star.
+     */
+    struct StarInfo {
+        QList<StarObject *> aperture;
+        float cost;
+    };
+    QHash<const SkyPoint *, StarInfo> star_info; // Filled as the search reaches stars
+
+    /**
+     *@return the aperture and star cost of star, querying the star
+     * catalog the first time star is seen in a search
+     */
+    StarInfo starInfo( const StarObject *star );
+
+    /**
+     *@short Fills neighbors with the stars within fov of node down to maglim
+     */
+    void findNeighbors( const SkyPoint *node, QList<StarObject *> &neighbors );
+
     /**
      *@short The cost function for hopping from current position to the a given star, in view of the final destination
      *@param curr Source SkyPoint
@@ -55,6 +77,13 @@ class StarHopper {
      */
     float cost( const SkyPoint *curr, const SkyPoint *next );
 
+    /**
+     *@short The part of cost() that does not depend on where the hop
+     * starts: brightness, colour, star density and star patterns
+     * around star, using the stars in aperture
+     */
+    float starCost( const StarObject *star, const QList<StarObject *> &aperture );
+
     /**
      *@short For internal use by the A* Search Algorithm. Completes
      * the star-hop path. See
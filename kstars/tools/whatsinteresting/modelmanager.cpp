@@ -15,13 +15,27 @@
  *                                                                         *
  ***************************************************************************/
 
+#include <QtConcurrentRun>
+
 #include "ksfilereader.h"
 #include "modelmanager.h"
 #include "kstarsdatetime.h"
 #include "skymapcomposite.h"
 #include "skyobject.h"
 
-ModelManager::ModelManager(ObsConditions *obs)
+namespace
+{
+    /**
+     * Checks the visibility of sky-objects in a background thread. Everything
+     * but the objects is a copy, so the user may change the conditions meanwhile.
+     */
+    QVector<bool> checkVisibility(ObsConditions obs, GeoLocation geo, dms lst, KStarsDateTime ut, QList<SkyObject *> objects)
+    {
+        return obs.isVisible(&geo, &lst, ut, objects);
+    }
+}
+
+ModelManager::ModelManager(ObsConditions *obs) : m_CheckPending(false)
 {
     m_ObsConditions = obs;
     m_PlanetsModel = new SkyObjListModel();
@@ -31,16 +45,16 @@ ModelManager::ModelManager(ObsConditions *obs)
     m_ClustModel = new SkyObjListModel();
     m_NebModel = new SkyObjListModel();
 
-    m_InitObjects[Star_Model] = QList<SkyObject *>();
-    m_InitObjects[Galaxy_Model] = QList<SkyObject *>();
-    m_InitObjects[Constellation_Model] = QList<SkyObject *>();
-    m_InitObjects[Cluster_Model] = QList<SkyObject *>();
-    m_InitObjects[Nebula_Model] = QList<SkyObject *>();
+    connect(&m_VisibilityWatcher, SIGNAL(finished()), this, SLOT(slotVisibilityChecked()));
+
+    loadObjects();
     updateModels(obs);
 }
 
 ModelManager::~ModelManager()
 {
+    m_VisibilityWatcher.waitForFinished();
+
     delete m_PlanetsModel;
     delete m_StarsModel;
     delete m_GalModel;
@@ -49,104 +63,101 @@ ModelManager::~ModelManager()
     delete m_NebModel;
 }
 
-void ModelManager::updateModels(ObsConditions *obs)
+void ModelManager::loadObjects()
 {
-    m_ObsConditions = obs;
-    m_InitObjects.clear();
-    resetModels();
-
     KStarsData *data = KStarsData::Instance();
 
     KSFileReader fileReader;
-    if (!fileReader.open("Interesting.dat")) return;
-
-    while (fileReader.hasMoreLines())
+    if (fileReader.open("Interesting.dat"))
     {
-        QString line = fileReader.readLine();
+        while (fileReader.hasMoreLines())
+        {
+            QString line = fileReader.readLine();
 
-        if (line.length() == 0 || line[0] == '#')
-            continue;
+            if (line.length() == 0 || line[0] == '#')
+                continue;
 
-        SkyObject *o;
-        if ((o = data->skyComposite()->findByName(line)))
-        {
-            //kDebug()<<o->longname()<<o->typeName();
-            switch(o->type())
+            SkyObject *o;
+            if ((o = data->skyComposite()->findByName(line)))
             {
-                case SkyObject::OPEN_CLUSTER:
-                case SkyObject::GLOBULAR_CLUSTER:
-                case SkyObject::GALAXY_CLUSTER:
-                    m_InitObjects[Cluster_Model].append(o);
-                    break;
-                case SkyObject::PLANETARY_NEBULA:
-                case SkyObject::DARK_NEBULA:
-                case SkyObject::GASEOUS_NEBULA:
-                    m_InitObjects[Nebula_Model].append(o);
-                    break;
-                case SkyObject::STAR:
-                    m_InitObjects[Star_Model].append(o);
-                    break;
-                case SkyObject::CONSTELLATION:
-                    m_InitObjects[Constellation_Model].append(o);
-                    break;
-                case SkyObject::GALAXY:
-                    m_InitObjects[Galaxy_Model].append(o);
-                    break;
+                //kDebug()<<o->longname()<<o->typeName();
+                SkyObjListModel *model = 0;
+                switch(o->type())
+                {
+                    case SkyObject::OPEN_CLUSTER:
+                    case SkyObject::GLOBULAR_CLUSTER:
+                    case SkyObject::GALAXY_CLUSTER:
+                        model = m_ClustModel;
+                        break;
+                    case SkyObject::PLANETARY_NEBULA:
+                    case SkyObject::DARK_NEBULA:
+                    case SkyObject::GASEOUS_NEBULA:
+                        model = m_NebModel;
+                        break;
+                    case SkyObject::STAR:
+                        model = m_StarsModel;
+                        break;
+                    case SkyObject::CONSTELLATION:
+                        model = m_ConModel;
+                        break;
+                    case SkyObject::GALAXY:
+                        model = m_GalModel;
+                        break;
+                }
+
+                if (model)
+                {
+                    m_Objects.append(o);
+                    m_ObjectModels.append(model);
+                }
             }
         }
     }
 
-    foreach (SkyObject *so, m_InitObjects.value(Star_Model))
+    foreach (const QString &name, data->skyComposite()->objectNames(SkyObject::PLANET))
     {
-        //kDebug()<<so->longname()<<so->typeName();
-        if (m_ObsConditions->isVisible(data->geo(), data->lst(), so))
-        {
-            m_StarsModel->addSkyObject(new SkyObjItem(so));
-        }
+        SkyObject *so = data->skyComposite()->findByName(name);
+        if (so && so->name() != "Sun")
+            m_Planets.append(so);
     }
+}
 
-    foreach (SkyObject *so, m_InitObjects.value(Galaxy_Model))
-    {
-        //kDebug()<<so->longname()<<so->typeName();
-        if (m_ObsConditions->isVisible(data->geo(), data->lst(), so))
-        {
-            m_GalModel->addSkyObject(new SkyObjItem(so));
-        }
-    }
+void ModelManager::updateModels(ObsConditions *obs)
+{
+    m_ObsConditions = obs;
 
-    foreach (SkyObject *so, m_InitObjects.value(Constellation_Model))
-    {
-        if (m_ObsConditions->isVisible(data->geo(), data->lst(), so))
-        {
-            m_ConModel->addSkyObject(new SkyObjItem(so));
-        }
-    }
+    ///Results of a check still running are for the old conditions
+    m_VisibilityWatcher.waitForFinished();
+    m_CheckPending = false;
+    resetModels();
 
-    foreach (SkyObject *so, m_InitObjects.value(Cluster_Model))
-    {
-        if (m_ObsConditions->isVisible(data->geo(), data->lst(), so))
-        {
-            m_ClustModel->addSkyObject(new SkyObjItem(so));
-        }
-    }
+    KStarsData *data = KStarsData::Instance();
+    KStarsDateTime ut = data->geo()->LTtoUT(KStarsDateTime(KDateTime::currentLocalDateTime()));
 
-    foreach (SkyObject *so, m_InitObjects.value(Nebula_Model))
+    ///Solar system bodies are moved while they are checked, so they are done here
+    QVector<bool> visible = m_ObsConditions->isVisible(data->geo(), data->lst(), ut, m_Planets);
+    for (int i = 0; i < m_Planets.size(); ++i)
     {
-        if (m_ObsConditions->isVisible(data->geo(), data->lst(), so))
-        {
-            m_NebModel->addSkyObject(new SkyObjItem(so));
-        }
+        if (visible[i])
+            m_PlanetsModel->addSkyObject(new SkyObjItem(m_Planets[i]));
     }
 
-    foreach (const QString &name, data->skyComposite()->objectNames(SkyObject::PLANET))
+    m_CheckPending = true;
+    m_VisibilityWatcher.setFuture(QtConcurrent::run(checkVisibility, *m_ObsConditions, *data->geo(), *data->lst(), ut, m_Objects));
+}
+
+void ModelManager::slotVisibilityChecked()
+{
+    ///A finished() of an earlier check may still arrive
+    if (!m_CheckPending || !m_VisibilityWatcher.isFinished())
+        return;
+    m_CheckPending = false;
+
+    QVector<bool> visible = m_VisibilityWatcher.result();
+    for (int i = 0; i < m_Objects.size(); ++i)
     {
-        SkyObject *so = data->skyComposite()->findByName(name);
-        //kDebug()<<so->name()<<so->mag();
-        if (m_ObsConditions->isVisible(data->geo(), data->lst(), so))
-        {
-            if (so->name() == "Sun") continue;
-            m_PlanetsModel->addSkyObject(new SkyObjItem(so));
-        }
+        if (visible[i])
+            m_ObjectModels[i]->addSkyObject(new SkyObjItem(m_Objects[i]));
     }
 }
 
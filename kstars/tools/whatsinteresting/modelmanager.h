@@ -18,6 +18,10 @@
 #ifndef MODEL_MANAGER_H
 #define MODEL_MANAGER_H
 
+#include <QFutureWatcher>
+#include <QObject>
+#include <QVector>
+
 #include "skyobjlistmodel.h"
 #include "kstarsdata.h"
 #include "obsconditions.h"
@@ -25,10 +29,14 @@
 /**
  * \class ModelManager
  * \brief Manages models for QML listviews of different types of sky-objects.
+ * The objects listed in Interesting.dat are looked up once. Their visibility
+ * is checked in one pass in a background thread, and the models are filled
+ * when that pass is done.
  * \author Samikshan Bairagya
  */
-class ModelManager
+class ModelManager : public QObject
 {
+    Q_OBJECT
 public:
     /**
      * \enum ModelType
@@ -49,6 +57,8 @@ public:
 
     /**
      * \brief Updates sky-object list models.
+     * The planets are added right away, the other sky-objects when the
+     * background visibility check is done.
      */
     void updateModels(ObsConditions *obs);
 
@@ -64,10 +74,27 @@ public:
      */
     SkyObjListModel *returnModel(int type);
 
+private slots:
+    /**
+     * \brief Adds the sky-objects found visible by the background check to their models.
+     */
+    void slotVisibilityChecked();
+
 private:
+    /**
+     * \brief Reads Interesting.dat and looks up its sky-objects and the planets.
+     */
+    void loadObjects();
+
     ObsConditions *m_ObsConditions;
     SkyObjListModel *m_PlanetsModel, *m_StarsModel, *m_GalModel, *m_ConModel, *m_ClustModel, *m_NebModel;
-    QHash< ModelType, QList <SkyObject *> > m_InitObjects;
+
+    QList<SkyObject *> m_Objects;               ///Sky-objects from Interesting.dat
+    QVector<SkyObjListModel *> m_ObjectModels;  ///Model of each of m_Objects
+    QList<SkyObject *> m_Planets;
+
+    QFutureWatcher< QVector<bool> > m_VisibilityWatcher;
+    bool m_CheckPending;                        ///True until the results of the last check are added
 };
 
 #endif
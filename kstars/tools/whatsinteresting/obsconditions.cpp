@@ -104,6 +104,38 @@ bool ObsConditions::isVisible(GeoLocation *geo, dms *lst, SkyObject *so)
     return (sp.alt().Degrees() > 6.0 && so->mag() < getTrueMagLim());
 }
 
+QVector<bool> ObsConditions::isVisible(const GeoLocation *geo, const dms *lst, const KStarsDateTime &ut, const QList<SkyObject *> &objects)
+{
+    QVector<bool> visible(objects.size(), false);
+    double magLim = getTrueMagLim();
+    KSNumbers num(ut.djd());
+
+    for (int i = 0; i < objects.size(); ++i)
+    {
+        SkyObject *so = objects[i];
+        if (so->mag() >= magLim)
+            continue;
+
+        SkyPoint sp;
+        if (so->isSolarSystem())
+        {
+            sp = so->recomputeCoords(ut, geo);
+        }
+        else
+        {
+            ///Work on a copy so the object itself is not touched
+            sp = *so;
+            sp.updateCoords(&num, false, 0, 0, true);
+        }
+
+        //check altitude of object at this time.
+        sp.EquatorialToHorizontal(lst, geo->lat());
+        visible[i] = sp.alt().Degrees() > 6.0;
+    }
+
+    return visible;
+}
+
 void ObsConditions::setObsConditions(int bortle, double aperture, ObsConditions::Equipment equip, ObsConditions::TelescopeType telType)
 {
     m_BortleClass = bortle;
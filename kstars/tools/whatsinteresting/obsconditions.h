@@ -18,6 +18,8 @@
 #ifndef OBS_CONDITIONS_H
 #define OBS_CONDITIONS_H
 
+#include <QVector>
+
 #include "kstarsdata.h"
 
 /**
@@ -98,6 +100,19 @@ public:
      */
     bool isVisible(GeoLocation *geo, dms *lst, SkyObject *so);
 
+    /**
+     * \brief Evaluate visibility of many sky-objects at once, for the same time.
+     * Precession and nutation for that time are computed once for all objects.
+     * \return Visibility of each sky-object, in the order of objects.
+     * \param geo       Geographic location of user.
+     * \param lst       Local sidereal time expressed as a dms object.
+     * \param ut        Universal time for which the coordinates are computed.
+     * \param objects   Sky-objects for which visibility is to be evaluated.
+     * \note Solar system bodies are moved to ut and back while they are
+     * checked, so they may only be passed from the main thread.
+     */
+    QVector<bool> isVisible(const GeoLocation *geo, const dms *lst, const KStarsDateTime &ut, const QList<SkyObject *> &objects);
+
     /**
      * \brief Create QMap<int, double> to be initialised to static member variable m_LMMap
      * \return QMap<int, double> to be initialised to static member variable m_LMMap
@@ -280,7 +280,7 @@ void WUTDialog::slotLoadList( const QString &c ) {
         }
 
         else if ( c == m_Categories[6] ) { //Asteroids
-            foreach ( SkyObject *o, data->skyComposite()->asteroids() )
+            foreach ( SkyObject *o, data->skyComposite()->asteroids( m_Mag ) )
             if ( checkVisibility(o) && o->name() != i18n("Pluto") && o->mag() <= m_Mag )
                 visibleObjects(c).append(o);
 